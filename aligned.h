@@ -0,0 +1,200 @@
+//
+// Copyright (c) 2013 Linaro Limited
+//
+// All rights reserved. This program and the accompanying materials
+// are made available under the terms of the MIT License which accompanies
+// this distribution, and is available at
+// http://www.opensource.org/licenses/mit-license.php
+//
+// Contributors:
+//     Jesse Barker - original implementation.
+//
+#ifndef ALIGNED_H_
+#define ALIGNED_H_
+
+#include <new>
+#include <stddef.h>
+#include <stdlib.h>
+#include "vec.h"
+#include "mat.h"
+#include "batch.h"
+
+#if __cplusplus >= 201103L
+#define LIBMATRIX_ALIGNAS(n) alignas(n)
+#elif defined(__GNUC__)
+#define LIBMATRIX_ALIGNAS(n) __attribute__((aligned(n)))
+#else
+#error "aligned.h needs C++11 alignas() or the GCC aligned attribute"
+#endif
+
+namespace LibMatrix
+{
+
+//
+// Opt-in over-aligned versions of tmat4 and tvec4.  They add nothing but
+// the alignment, so the elements are laid out exactly as in the base class
+// and operator const T*() can still be handed straight to GL.  Arithmetic
+// works through the base class (and so yields plain tmat4/tvec4 results),
+// which converts back on assignment.
+//
+// Alignment has to be 16, 32 or 64 bytes.  Dynamically allocated arrays of
+// these types only get the alignment with aligned_allocator (below), or
+// with C++17 aligned new.
+//
+template<typename T, unsigned int Align = 64>
+class LIBMATRIX_ALIGNAS(Align) tmat4_aligned : public tmat4<T>
+{
+    typedef char ValidAlignment[Align == 16 || Align == 32 || Align == 64 ? 1 : -1];
+    // Arrays of these are passed to the Batch functions as tmat4 arrays,
+    // so the alignment must not add padding.
+    typedef char NoPadding[sizeof(tmat4<T>) % Align == 0 ? 1 : -1];
+public:
+    tmat4_aligned() {}
+    tmat4_aligned(const tmat4<T>& m) : tmat4<T>(m) {}
+    tmat4_aligned& operator=(const tmat4<T>& rhs)
+    {
+        tmat4<T>::operator=(rhs);
+        return *this;
+    }
+};
+
+// Unlike the matrices, vectors smaller than the alignment are padded out to
+// it, so arrays of these have their own overloads of the Batch functions.
+template<typename T, unsigned int Align = sizeof(tvec4<T>)>
+class LIBMATRIX_ALIGNAS(Align) tvec4_aligned : public tvec4<T>
+{
+    typedef char ValidAlignment[Align == 16 || Align == 32 || Align == 64 ? 1 : -1];
+public:
+    tvec4_aligned() {}
+    tvec4_aligned(const T x, const T y, const T z, const T w) : tvec4<T>(x, y, z, w) {}
+    tvec4_aligned(const tvec4<T>& v) : tvec4<T>(v) {}
+    tvec4_aligned& operator=(const tvec4<T>& rhs)
+    {
+        tvec4<T>::operator=(rhs);
+        return *this;
+    }
+};
+
+typedef tmat4_aligned<float> mat4_aligned;
+typedef tmat4_aligned<double> dmat4_aligned;
+typedef tvec4_aligned<float> vec4_aligned;
+typedef tvec4_aligned<double> dvec4_aligned;
+
+//
+// An STL allocator that hands out storage aligned to 'Align' bytes, e.g.
+// std::vector<mat4, aligned_allocator<mat4> > keeps every matrix within one
+// cache line.  'Align' must be a power of two, a multiple of sizeof(void*)
+// and no less than the alignment of T.
+//
+template<typename T, unsigned int Align = 64>
+class aligned_allocator
+{
+public:
+    typedef T value_type;
+    typedef T* pointer;
+    typedef const T* const_pointer;
+    typedef T& reference;
+    typedef const T& const_reference;
+    typedef size_t size_type;
+    typedef ptrdiff_t difference_type;
+
+    template<typename U>
+    struct rebind
+    {
+        typedef aligned_allocator<U, Align> other;
+    };
+
+    aligned_allocator() {}
+    aligned_allocator(const aligned_allocator&) {}
+    template<typename U>
+    aligned_allocator(const aligned_allocator<U, Align>&) {}
+    ~aligned_allocator() {}
+
+    pointer address(reference r) const { return &r; }
+    const_pointer address(const_reference r) const { return &r; }
+    size_type max_size() const { return static_cast<size_type>(-1) / sizeof(T); }
+
+    pointer allocate(size_type n, const void* = 0)
+    {
+        void* p(0);
+        if (n > max_size() ||
+            (n && posix_memalign(&p, Align, n * sizeof(T)) != 0))
+        {
+            throw std::bad_alloc();
+        }
+        return static_cast<pointer>(p);
+    }
+    void deallocate(pointer p, size_type) { free(p); }
+
+    void construct(pointer p, const T& val) { new (static_cast<void*>(p)) T(val); }
+    void destroy(pointer p) { p->~T(); }
+};
+
+template<typename T, typename U, unsigned int Align>
+bool
+operator==(const aligned_allocator<T, Align>&, const aligned_allocator<U, Align>&)
+{
+    return true;
+}
+
+template<typename T, typename U, unsigned int Align>
+bool
+operator!=(const aligned_allocator<T, Align>&, const aligned_allocator<U, Align>&)
+{
+    return false;
+}
+
+namespace Batch
+{
+
+// Compute m * in[i] into out[i] for 'count' aligned vectors (see the tvec4
+// version).  Without padding this is the same as the tvec4 version;
+// otherwise the vectors are transformed one at a time.
+template<typename T, unsigned int Align>
+void
+transform(tvec4_aligned<T, Align>* out, const tmat4<T>& m, const tvec4_aligned<T, Align>* in,
+          unsigned int count, DivideMode mode = DivideNone)
+{
+    if (sizeof(tvec4_aligned<T, Align>) == sizeof(tvec4<T>))
+    {
+        transform(static_cast<tvec4<T>*>(out), m, static_cast<const tvec4<T>*>(in), count, mode);
+        return;
+    }
+    for (unsigned int i = 0; i < count; i++)
+    {
+        Mat4Kernel<T>::transformArray4(out[i].data(), m, in[i], 1, mode == DivideByW);
+    }
+}
+
+template<typename T, unsigned int Align>
+class AlignedTransformTask : public RangeTask
+{
+public:
+    AlignedTransformTask(tvec4_aligned<T, Align>* out, const tmat4<T>& m,
+                         const tvec4_aligned<T, Align>* in, DivideMode mode) :
+        out_(out), m_(m), in_(in), mode_(mode) {}
+    void run(unsigned int begin, unsigned int end)
+    {
+        transform(out_ + begin, m_, in_ + begin, end - begin, mode_);
+    }
+private:
+    tvec4_aligned<T, Align>* out_;
+    const tmat4<T>& m_;
+    const tvec4_aligned<T, Align>* in_;
+    DivideMode mode_;
+};
+
+template<typename T, unsigned int Align>
+void
+transform(ThreadPool& pool, tvec4_aligned<T, Align>* out, const tmat4<T>& m,
+          const tvec4_aligned<T, Align>* in, unsigned int count,
+          DivideMode mode = DivideNone, unsigned int grain = defaultGrain)
+{
+    AlignedTransformTask<T, Align> task(out, m, in, mode);
+    pool.parallelFor(count, grain, task);
+}
+
+} // namespace Batch
+} // namespace LibMatrix
+
+#endif // ALIGNED_H_
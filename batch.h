@@ -0,0 +1,406 @@
+//
+// Copyright (c) 2013 Linaro Limited
+//
+// All rights reserved. This program and the accompanying materials
+// are made available under the terms of the MIT License which accompanies
+// this distribution, and is available at
+// http://www.opensource.org/licenses/mit-license.php
+//
+// Contributors:
+//     Jesse Barker - original implementation.
+//
+#ifndef BATCH_H_
+#define BATCH_H_
+
+#include "mat.h"
+#include "thread-pool.h"
+
+namespace LibMatrix
+{
+//
+// Operations on whole arrays of matrices and vectors (e.g. the contents of
+// a std::vector<mat4>), written straight into a caller-provided output array.
+// Nothing is allocated and no temporaries are returned; matrix inputs are
+// prefetched ahead of use and each product goes through the vectorized
+// kernels in simd.h.
+//
+namespace Batch
+{
+
+// Compute lhs[i] * rhs[i] into out[i] for 'count' pairs of matrices.
+// 'out' may be the same array as either input.
+template<typename T>
+void
+multiply(tmat4<T>* out, const tmat4<T>* lhs, const tmat4<T>* rhs, unsigned int count)
+{
+    if (count == 0)
+    {
+        return;
+    }
+    Mat4Kernel<T>::multiplyArray(out[0].data(), lhs[0], rhs[0], count);
+}
+
+// Compute lhs * rhs[i] into out[i] for 'count' matrices (e.g. a parent
+// transform applied to an array of local transforms).  'out' may be the
+// same array as 'rhs', but must not contain 'lhs'.
+template<typename T>
+void
+multiply(tmat4<T>* out, const tmat4<T>& lhs, const tmat4<T>* rhs, unsigned int count)
+{
+    if (count == 0)
+    {
+        return;
+    }
+    Mat4Kernel<T>::multiplyArrayLeft(out[0].data(), lhs, rhs[0], count);
+}
+
+// Compute lhs[i] * rhs into out[i] for 'count' matrices.  'out' may be the
+// same array as 'lhs', but must not contain 'rhs'.
+template<typename T>
+void
+multiply(tmat4<T>* out, const tmat4<T>* lhs, const tmat4<T>& rhs, unsigned int count)
+{
+    if (count == 0)
+    {
+        return;
+    }
+    Mat4Kernel<T>::multiplyArrayRight(out[0].data(), lhs[0], rhs, count);
+}
+
+// Whether the batch transforms divide each result through by its w.
+enum DivideMode
+{
+    DivideNone,
+    DivideByW
+};
+
+// Compute m * in[i] into out[i] for 'count' vectors.  With DivideByW, each
+// result is divided by its own w (which leaves w at 1), as for clip space
+// to normalized device coordinates.  'out' may be the same array as 'in'.
+template<typename T>
+void
+transform(tvec4<T>* out, const tmat4<T>& m, const tvec4<T>* in, unsigned int count,
+          DivideMode mode = DivideNone)
+{
+    if (count == 0)
+    {
+        return;
+    }
+    Mat4Kernel<T>::transformArray4(out[0].data(), m, in[0], count, mode == DivideByW);
+}
+
+// Transform 'count' positions by m (i.e. with an implied w of 1) into
+// out[i].  With DivideByW, the x, y and z of each result are divided by
+// the w it would have had, so a projection matrix can be applied directly.
+// 'out' may be the same array as 'in'.
+template<typename T>
+void
+transformPoints(tvec3<T>* out, const tmat4<T>& m, const tvec3<T>* in, unsigned int count,
+                DivideMode mode = DivideNone)
+{
+    if (count == 0)
+    {
+        return;
+    }
+    Mat4Kernel<T>::transformArray3(out[0].data(), m, in[0], count, static_cast<T>(1), mode == DivideByW);
+}
+
+// Transform 'count' directions by m (i.e. with an implied w of 0, so the
+// translation does not apply) into out[i].  'out' may be the same array as
+// 'in'.  Note that normals need the inverse transpose of m instead.
+template<typename T>
+void
+transformVectors(tvec3<T>* out, const tmat4<T>& m, const tvec3<T>* in, unsigned int count)
+{
+    if (count == 0)
+    {
+        return;
+    }
+    Mat4Kernel<T>::transformArray3(out[0].data(), m, in[0], count, static_cast<T>(0), false);
+}
+
+// Compute dot(a[i], b[i]) into out[i] for 'count' pairs of vectors.
+template<typename T>
+void
+dot(T* out, const tvec3<T>* a, const tvec3<T>* b, unsigned int count)
+{
+    if (count == 0)
+    {
+        return;
+    }
+    VecKernel<T, 3>::dotArray(out, a[0], b[0], count);
+}
+
+template<typename T>
+void
+dot(T* out, const tvec4<T>* a, const tvec4<T>* b, unsigned int count)
+{
+    if (count == 0)
+    {
+        return;
+    }
+    VecKernel<T, 4>::dotArray(out, a[0], b[0], count);
+}
+
+// Compute in[i].length() into out[i] for 'count' vectors.  As for
+// length(), the results are double for double vectors and float otherwise.
+template<typename T>
+void
+length(typename LengthType<T>::Type* out, const tvec3<T>* in, unsigned int count)
+{
+    if (count == 0)
+    {
+        return;
+    }
+    VecKernel<T, 3>::lengthArray(out, in[0], count);
+}
+
+template<typename T>
+void
+length(typename LengthType<T>::Type* out, const tvec4<T>* in, unsigned int count)
+{
+    if (count == 0)
+    {
+        return;
+    }
+    VecKernel<T, 4>::lengthArray(out, in[0], count);
+}
+
+// Normalize 'count' vectors into out[i], as normalize() does (including
+// its use of the fast version when built with LIBMATRIX_FAST_MATH).  'out'
+// may be the same array as 'in'.
+template<typename T>
+void
+normalize(tvec3<T>* out, const tvec3<T>* in, unsigned int count)
+{
+    if (count == 0)
+    {
+        return;
+    }
+#if defined(LIBMATRIX_FAST_MATH)
+    VecKernel<T, 3>::normalizeArrayFast(out[0].data(), in[0], count);
+#else
+    VecKernel<T, 3>::normalizeArray(out[0].data(), in[0], count);
+#endif
+}
+
+template<typename T>
+void
+normalize(tvec4<T>* out, const tvec4<T>* in, unsigned int count)
+{
+    if (count == 0)
+    {
+        return;
+    }
+#if defined(LIBMATRIX_FAST_MATH)
+    VecKernel<T, 4>::normalizeArrayFast(out[0].data(), in[0], count);
+#else
+    VecKernel<T, 4>::normalizeArray(out[0].data(), in[0], count);
+#endif
+}
+
+// Normalize 'count' vectors into out[i], as normalize(fast) does: each is
+// scaled by an approximate reciprocal square root of its squared length
+// (see FastMath::rsqrt()), four at a time where SIMD is available.  'out'
+// may be the same array as 'in'.
+template<typename T>
+void
+normalize(tvec3<T>* out, const tvec3<T>* in, unsigned int count, Fast)
+{
+    if (count == 0)
+    {
+        return;
+    }
+    VecKernel<T, 3>::normalizeArrayFast(out[0].data(), in[0], count);
+}
+
+template<typename T>
+void
+normalize(tvec4<T>* out, const tvec4<T>* in, unsigned int count, Fast)
+{
+    if (count == 0)
+    {
+        return;
+    }
+    VecKernel<T, 4>::normalizeArrayFast(out[0].data(), in[0], count);
+}
+
+// Compute cross(a[i], b[i]) into out[i] for 'count' pairs of vectors.
+// 'out' may be the same array as either input.
+template<typename T>
+void
+cross(tvec3<T>* out, const tvec3<T>* a, const tvec3<T>* b, unsigned int count)
+{
+    if (count == 0)
+    {
+        return;
+    }
+    VecKernel<T, 3>::crossArray(out[0].data(), a[0], b[0], count);
+}
+
+//
+// Parallel versions of the above, splitting the arrays across the threads
+// of 'pool' in chunks of 'grain' elements.  Each chunk writes only its own
+// slice of 'out', so the results are identical to the serial versions.
+// Arrays of no more than 'grain' elements are handled on the calling thread.
+//
+static const unsigned int defaultGrain = 2048;
+
+template<typename T>
+class MultiplyTask : public RangeTask
+{
+public:
+    MultiplyTask(tmat4<T>* out, const tmat4<T>* lhs, const tmat4<T>* rhs) :
+        out_(out), lhs_(lhs), rhs_(rhs) {}
+    void run(unsigned int begin, unsigned int end)
+    {
+        multiply(out_ + begin, lhs_ + begin, rhs_ + begin, end - begin);
+    }
+private:
+    tmat4<T>* out_;
+    const tmat4<T>* lhs_;
+    const tmat4<T>* rhs_;
+};
+
+template<typename T>
+class MultiplyLeftTask : public RangeTask
+{
+public:
+    MultiplyLeftTask(tmat4<T>* out, const tmat4<T>& lhs, const tmat4<T>* rhs) :
+        out_(out), lhs_(lhs), rhs_(rhs) {}
+    void run(unsigned int begin, unsigned int end)
+    {
+        multiply(out_ + begin, lhs_, rhs_ + begin, end - begin);
+    }
+private:
+    tmat4<T>* out_;
+    const tmat4<T>& lhs_;
+    const tmat4<T>* rhs_;
+};
+
+template<typename T>
+class MultiplyRightTask : public RangeTask
+{
+public:
+    MultiplyRightTask(tmat4<T>* out, const tmat4<T>* lhs, const tmat4<T>& rhs) :
+        out_(out), lhs_(lhs), rhs_(rhs) {}
+    void run(unsigned int begin, unsigned int end)
+    {
+        multiply(out_ + begin, lhs_ + begin, rhs_, end - begin);
+    }
+private:
+    tmat4<T>* out_;
+    const tmat4<T>* lhs_;
+    const tmat4<T>& rhs_;
+};
+
+template<typename T>
+class TransformTask : public RangeTask
+{
+public:
+    TransformTask(tvec4<T>* out, const tmat4<T>& m, const tvec4<T>* in, DivideMode mode) :
+        out_(out), m_(m), in_(in), mode_(mode) {}
+    void run(unsigned int begin, unsigned int end)
+    {
+        transform(out_ + begin, m_, in_ + begin, end - begin, mode_);
+    }
+private:
+    tvec4<T>* out_;
+    const tmat4<T>& m_;
+    const tvec4<T>* in_;
+    DivideMode mode_;
+};
+
+template<typename T>
+class TransformPointsTask : public RangeTask
+{
+public:
+    TransformPointsTask(tvec3<T>* out, const tmat4<T>& m, const tvec3<T>* in, DivideMode mode) :
+        out_(out), m_(m), in_(in), mode_(mode) {}
+    void run(unsigned int begin, unsigned int end)
+    {
+        transformPoints(out_ + begin, m_, in_ + begin, end - begin, mode_);
+    }
+private:
+    tvec3<T>* out_;
+    const tmat4<T>& m_;
+    const tvec3<T>* in_;
+    DivideMode mode_;
+};
+
+template<typename T>
+class TransformVectorsTask : public RangeTask
+{
+public:
+    TransformVectorsTask(tvec3<T>* out, const tmat4<T>& m, const tvec3<T>* in) :
+        out_(out), m_(m), in_(in) {}
+    void run(unsigned int begin, unsigned int end)
+    {
+        transformVectors(out_ + begin, m_, in_ + begin, end - begin);
+    }
+private:
+    tvec3<T>* out_;
+    const tmat4<T>& m_;
+    const tvec3<T>* in_;
+};
+
+template<typename T>
+void
+multiply(ThreadPool& pool, tmat4<T>* out, const tmat4<T>* lhs, const tmat4<T>* rhs,
+         unsigned int count, unsigned int grain = defaultGrain)
+{
+    MultiplyTask<T> task(out, lhs, rhs);
+    pool.parallelFor(count, grain, task);
+}
+
+template<typename T>
+void
+multiply(ThreadPool& pool, tmat4<T>* out, const tmat4<T>& lhs, const tmat4<T>* rhs,
+         unsigned int count, unsigned int grain = defaultGrain)
+{
+    MultiplyLeftTask<T> task(out, lhs, rhs);
+    pool.parallelFor(count, grain, task);
+}
+
+template<typename T>
+void
+multiply(ThreadPool& pool, tmat4<T>* out, const tmat4<T>* lhs, const tmat4<T>& rhs,
+         unsigned int count, unsigned int grain = defaultGrain)
+{
+    MultiplyRightTask<T> task(out, lhs, rhs);
+    pool.parallelFor(count, grain, task);
+}
+
+template<typename T>
+void
+transform(ThreadPool& pool, tvec4<T>* out, const tmat4<T>& m, const tvec4<T>* in,
+          unsigned int count, DivideMode mode = DivideNone,
+          unsigned int grain = defaultGrain)
+{
+    TransformTask<T> task(out, m, in, mode);
+    pool.parallelFor(count, grain, task);
+}
+
+template<typename T>
+void
+transformPoints(ThreadPool& pool, tvec3<T>* out, const tmat4<T>& m, const tvec3<T>* in,
+                unsigned int count, DivideMode mode = DivideNone,
+                unsigned int grain = defaultGrain)
+{
+    TransformPointsTask<T> task(out, m, in, mode);
+    pool.parallelFor(count, grain, task);
+}
+
+template<typename T>
+void
+transformVectors(ThreadPool& pool, tvec3<T>* out, const tmat4<T>& m, const tvec3<T>* in,
+                 unsigned int count, unsigned int grain = defaultGrain)
+{
+    TransformVectorsTask<T> task(out, m, in);
+    pool.parallelFor(count, grain, task);
+}
+
+} // namespace Batch
+} // namespace LibMatrix
+
+#endif // BATCH_H_
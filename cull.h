@@ -0,0 +1,384 @@
+//
+// Copyright (c) 2013 Linaro Limited
+//
+// All rights reserved. This program and the accompanying materials
+// are made available under the terms of the MIT License which accompanies
+// this distribution, and is available at
+// http://www.opensource.org/licenses/mit-license.php
+//
+// Contributors:
+//     Jesse Barker - original implementation.
+//
+#ifndef CULL_H_
+#define CULL_H_
+
+#include <stdint.h>
+#include <math.h>
+#include "vec.h"
+#include "mat.h"
+#include "simd.h"
+#include "soa.h"
+#include "thread-pool.h"
+
+namespace LibMatrix
+{
+
+//
+// The six clipping planes of a view volume, extracted from the matrix that
+// takes points into GL clip space (-w <= x, y, z <= w), e.g. the product of
+// Mat4::perspective() and a view matrix from Stack4.  The planes are in the
+// space the matrix takes points from: given projection * view they are in
+// world space, and given projection * view * model in that model's space.
+//
+// Each plane is stored as (a, b, c, d) with (a, b, c) its unit normal
+// pointing into the volume, so a*x + b*y + c*z + d is the signed distance
+// of (x, y, z) from it, positive on the inside.
+//
+template<typename T>
+class tfrustum
+{
+public:
+    enum Plane
+    {
+        Left,
+        Right,
+        Bottom,
+        Top,
+        Near,
+        Far,
+        NumPlanes
+    };
+
+    // Extract the planes from the rows of 'm' (after Gribb and Hartmann).
+    explicit tfrustum(const tmat4<T>& m)
+    {
+        const tvec4<T> w(m.row(3));
+        for (unsigned int r = 0; r < 3; r++)
+        {
+            const tvec4<T> v(m.row(r));
+            planes_[2 * r] = normalizePlane(w + v);
+            planes_[2 * r + 1] = normalizePlane(w - v);
+        }
+    }
+
+    const tvec4<T>& plane(unsigned int index) const { return planes_[index]; }
+
+    // Whether the sphere at 'center' with 'radius' is at least partly
+    // inside the volume.  The test is conservative: a sphere outside the
+    // volume but close to one of its edges may still pass.
+    bool intersects(const tvec3<T>& center, T radius) const
+    {
+        for (unsigned int p = 0; p < NumPlanes; p++)
+        {
+            if (distance(planes_[p], center) + radius < 0)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Whether the axis-aligned box from 'min' to 'max' is at least partly
+    // inside the volume, as conservatively as the sphere test.
+    bool intersects(const tvec3<T>& min, const tvec3<T>& max) const
+    {
+        const T half(static_cast<T>(0.5));
+        tvec3<T> center((min.x() + max.x()) * half, (min.y() + max.y()) * half,
+                        (min.z() + max.z()) * half);
+        tvec3<T> extent((max.x() - min.x()) * half, (max.y() - min.y()) * half,
+                        (max.z() - min.z()) * half);
+        for (unsigned int p = 0; p < NumPlanes; p++)
+        {
+            const tvec4<T>& n(planes_[p]);
+            T radius(((magnitude(n.x()) * extent.x()) + (magnitude(n.y()) * extent.y())) +
+                     (magnitude(n.z()) * extent.z()));
+            if (distance(n, center) + radius < 0)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // The signed distance of 'v' from 'plane'.
+    static T distance(const tvec4<T>& plane, const tvec3<T>& v)
+    {
+        return (((plane.x() * v.x()) + (plane.y() * v.y())) + (plane.z() * v.z())) + plane.w();
+    }
+
+private:
+    static tvec4<T> normalizePlane(const tvec4<T>& p)
+    {
+        T l(static_cast<T>(sqrt(static_cast<typename LengthType<T>::Type>(
+            (p.x() * p.x()) + (p.y() * p.y()) + (p.z() * p.z())))));
+        return tvec4<T>(p.x() / l, p.y() / l, p.z() / l, p.w() / l);
+    }
+
+    tvec4<T> planes_[NumPlanes];
+};
+
+typedef tfrustum<float> frustum;
+typedef tfrustum<double> dfrustum;
+
+namespace Batch
+{
+
+//
+// Visibility tests of whole arrays of bounding volumes against a frustum.
+// The volumes are held in the structure-of-arrays containers from soa.h,
+// and tested a full vector register (see Lanes in simd.h) at a time, with
+// exactly the same arithmetic as tfrustum::intersects().
+//
+// The results are a bit mask: object i is visible if bit i % 32 of
+// visible[i / 32] is set.  'visible' must have room for (count + 31) / 32
+// words; the bits past the last object are cleared.  compact() turns a
+// mask into a list of indices.
+//
+// The parallel versions split the objects across the threads of 'pool' in
+// chunks of 'grain' objects (made a non-zero multiple of 32 by cullGrain(),
+// so that every chunk starts on a word of the mask, and on an aligned
+// register of the arrays).  The results are identical to those of
+// the serial versions.
+//
+
+// Bounding spheres, held as the centers (x, y, z) and radii (w) of a
+// tvec4_soa.
+template<typename T>
+class CullSpheresTask : public RangeTask
+{
+public:
+    CullSpheresTask(uint32_t* visible, const tfrustum<T>& f, const tvec4_soa<T>& spheres) :
+        visible_(visible), frustum_(f), spheres_(spheres) {}
+    void run(unsigned int begin, unsigned int end)
+    {
+        typedef Lanes<T> L;
+        typedef typename L::Type V;
+        V planes[tfrustum<T>::NumPlanes][4];
+        splatPlanes(planes, frustum_);
+        clearMask(visible_, begin, end);
+        for (unsigned int i = begin; i < end; i += L::width)
+        {
+            V x(L::load(spheres_.x() + i));
+            V y(L::load(spheres_.y() + i));
+            V z(L::load(spheres_.z() + i));
+            V r(L::load(spheres_.w() + i));
+            V margin(L::add(distance(planes[0], x, y, z), r));
+            for (unsigned int p = 1; p < tfrustum<T>::NumPlanes; p++)
+            {
+                margin = L::min(margin, L::add(distance(planes[p], x, y, z), r));
+            }
+            setMask(visible_, i, end, ~L::negativeMask(margin));
+        }
+    }
+
+    // Set 'planes' to the elements of the planes of 'f', one per register.
+    static void splatPlanes(typename Lanes<T>::Type planes[][4], const tfrustum<T>& f)
+    {
+        for (unsigned int p = 0; p < tfrustum<T>::NumPlanes; p++)
+        {
+            const T* e(f.plane(p));
+            for (unsigned int j = 0; j < 4; j++)
+            {
+                planes[p][j] = Lanes<T>::splat(e[j]);
+            }
+        }
+    }
+
+    // Return the signed distances of (x, y, z) from 'plane'.
+    static typename Lanes<T>::Type distance(const typename Lanes<T>::Type plane[4],
+                                            typename Lanes<T>::Type x,
+                                            typename Lanes<T>::Type y,
+                                            typename Lanes<T>::Type z)
+    {
+        typedef Lanes<T> L;
+        return L::add(L::add(L::add(L::mul(plane[0], x), L::mul(plane[1], y)),
+                             L::mul(plane[2], z)), plane[3]);
+    }
+
+    // Clear the words of 'visible' for [begin, end).  'begin' is a multiple
+    // of 32.
+    static void clearMask(uint32_t* visible, unsigned int begin, unsigned int end)
+    {
+        for (unsigned int w = begin / 32; w < (end + 31) / 32; w++)
+        {
+            visible[w] = 0;
+        }
+    }
+
+    // Set the bits of 'visible' for the objects from 'i' (a multiple of the
+    // register width) that are set in 'bits', up to but not including 'end'.
+    static void setMask(uint32_t* visible, unsigned int i, unsigned int end, unsigned int bits)
+    {
+        const unsigned int width(Lanes<T>::width);
+        bits &= (1u << width) - 1;
+        if (end - i < width)
+        {
+            bits &= (1u << (end - i)) - 1;
+        }
+        visible[i / 32] |= static_cast<uint32_t>(bits) << (i % 32);
+    }
+
+private:
+    uint32_t* visible_;
+    const tfrustum<T>& frustum_;
+    const tvec4_soa<T>& spheres_;
+};
+
+// Axis-aligned bounding boxes, held as their minimum and maximum corners.
+template<typename T>
+class CullBoxesTask : public RangeTask
+{
+public:
+    CullBoxesTask(uint32_t* visible, const tfrustum<T>& f, const tvec3_soa<T>& min,
+                  const tvec3_soa<T>& max) :
+        visible_(visible), frustum_(f), min_(min), max_(max) {}
+    void run(unsigned int begin, unsigned int end)
+    {
+        typedef Lanes<T> L;
+        typedef typename L::Type V;
+        typedef CullSpheresTask<T> Spheres;
+        V planes[tfrustum<T>::NumPlanes][4];
+        V magnitudes[tfrustum<T>::NumPlanes][3];
+        Spheres::splatPlanes(planes, frustum_);
+        for (unsigned int p = 0; p < tfrustum<T>::NumPlanes; p++)
+        {
+            const T* e(frustum_.plane(p));
+            for (unsigned int j = 0; j < 3; j++)
+            {
+                magnitudes[p][j] = L::splat(magnitude(e[j]));
+            }
+        }
+        const V half(L::splat(static_cast<T>(0.5)));
+        Spheres::clearMask(visible_, begin, end);
+        for (unsigned int i = begin; i < end; i += L::width)
+        {
+            V minX(L::load(min_.x() + i));
+            V minY(L::load(min_.y() + i));
+            V minZ(L::load(min_.z() + i));
+            V maxX(L::load(max_.x() + i));
+            V maxY(L::load(max_.y() + i));
+            V maxZ(L::load(max_.z() + i));
+            V x(L::mul(L::add(minX, maxX), half));
+            V y(L::mul(L::add(minY, maxY), half));
+            V z(L::mul(L::add(minZ, maxZ), half));
+            V ex(L::mul(L::sub(maxX, minX), half));
+            V ey(L::mul(L::sub(maxY, minY), half));
+            V ez(L::mul(L::sub(maxZ, minZ), half));
+            V margin(L::add(Spheres::distance(planes[0], x, y, z),
+                            radius(magnitudes[0], ex, ey, ez)));
+            for (unsigned int p = 1; p < tfrustum<T>::NumPlanes; p++)
+            {
+                margin = L::min(margin, L::add(Spheres::distance(planes[p], x, y, z),
+                                               radius(magnitudes[p], ex, ey, ez)));
+            }
+            Spheres::setMask(visible_, i, end, ~L::negativeMask(margin));
+        }
+    }
+
+private:
+    // Return the extent of boxes with half-sizes (ex, ey, ez) along the
+    // normal of a plane, given the magnitudes of its elements.
+    static typename Lanes<T>::Type radius(const typename Lanes<T>::Type magnitudes[3],
+                                          typename Lanes<T>::Type ex,
+                                          typename Lanes<T>::Type ey,
+                                          typename Lanes<T>::Type ez)
+    {
+        typedef Lanes<T> L;
+        return L::add(L::add(L::mul(magnitudes[0], ex), L::mul(magnitudes[1], ey)),
+                      L::mul(magnitudes[2], ez));
+    }
+
+    uint32_t* visible_;
+    const tfrustum<T>& frustum_;
+    const tvec3_soa<T>& min_;
+    const tvec3_soa<T>& max_;
+};
+
+// Test each of the spheres against 'f'.
+template<typename T>
+void
+cullSpheres(uint32_t* visible, const tfrustum<T>& f, const tvec4_soa<T>& spheres)
+{
+    CullSpheresTask<T> task(visible, f, spheres);
+    task.run(0, spheres.size());
+}
+
+// Test each of the boxes against 'f'.  'min' and 'max' must be the same
+// size.
+template<typename T>
+void
+cullBoxes(uint32_t* visible, const tfrustum<T>& f, const tvec3_soa<T>& min,
+          const tvec3_soa<T>& max)
+{
+    CullBoxesTask<T> task(visible, f, min, max);
+    task.run(0, min.size());
+}
+
+static const unsigned int defaultCullGrain = 4096;
+
+// The grain actually used by the parallel versions: 'grain' rounded up to a
+// multiple of 32, and at least 32.  The largest grains are rounded down
+// instead, rather than wrapping around to 0.
+inline unsigned int
+cullGrain(unsigned int grain)
+{
+    if (grain <= 32)
+    {
+        return 32;
+    }
+    return grain > 0xffffffe0u ? 0xffffffe0u : (grain + 31) & ~31u;
+}
+
+template<typename T>
+void
+cullSpheres(ThreadPool& pool, uint32_t* visible, const tfrustum<T>& f,
+            const tvec4_soa<T>& spheres, unsigned int grain = defaultCullGrain)
+{
+    CullSpheresTask<T> task(visible, f, spheres);
+    pool.parallelFor(spheres.size(), cullGrain(grain), task);
+}
+
+template<typename T>
+void
+cullBoxes(ThreadPool& pool, uint32_t* visible, const tfrustum<T>& f, const tvec3_soa<T>& min,
+          const tvec3_soa<T>& max, unsigned int grain = defaultCullGrain)
+{
+    CullBoxesTask<T> task(visible, f, min, max);
+    pool.parallelFor(min.size(), cullGrain(grain), task);
+}
+
+// Write the indices of the bits set in the first 'count' bits of 'mask'
+// to 'indices', in increasing order, and return how many there are.
+inline unsigned int
+compact(unsigned int* indices, const uint32_t* mask, unsigned int count)
+{
+    unsigned int n(0);
+    for (unsigned int w = 0; w < (count + 31) / 32; w++)
+    {
+        uint32_t bits(mask[w]);
+        if (count - w * 32 < 32)
+        {
+            bits &= (1u << (count - w * 32)) - 1;
+        }
+        while (bits)
+        {
+#if defined(__GNUC__)
+            unsigned int b(__builtin_ctz(bits));
+#else
+            unsigned int b(0);
+            while (!(bits & (1u << b)))
+            {
+                b++;
+            }
+#endif
+            indices[n++] = w * 32 + b;
+            bits &= bits - 1;
+        }
+    }
+    return n;
+}
+
+} // namespace Batch
+} // namespace LibMatrix
+
+#endif // CULL_H_
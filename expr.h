@@ -0,0 +1,552 @@
+//
+// Copyright (c) 2013 Linaro Limited
+//
+// All rights reserved. This program and the accompanying materials
+// are made available under the terms of the MIT License which accompanies
+// this distribution, and is available at
+// http://www.opensource.org/licenses/mit-license.php
+//
+// Contributors:
+//     Jesse Barker - original implementation.
+//
+#ifndef EXPR_H_
+#define EXPR_H_
+
+#include "vec.h"
+#include "mat.h"
+
+//
+// Opt-in lazy arithmetic for the vector and matrix types.
+//
+// The ordinary operators copy their left-hand operand and apply a compound
+// operator to the copy, so an expression like a * b + c * d - e creates a
+// temporary object for every operator.  Wrapping the first operand with
+// lazy() instead builds a small expression tree that is evaluated, one
+// element at a time in a single loop, when it is assigned to a vector or
+// matrix:
+//
+//     vec3 r(lazy(a) * b + lazy(c) * d - e);
+//     assign(r, lazy(r) * s + t);
+//
+// The operators follow the ones in vec.h and mat.h: +, - and (for vectors)
+// * and / are element-wise, * between matrices, or between a matrix and a
+// vector, is the matrix product, and scalars may be used on either side of
+// * and on the right of /.
+//
+// Expressions refer to their vector and matrix operands rather than copying
+// them, so they are meant to be used within the statement that creates
+// them; keeping one around past the lifetime of an operand is an error.
+// The elements of the operands of a product are read several times each,
+// so a product of compound expressions recomputes them; it is usually
+// better to evaluate such operands first.
+//
+namespace LibMatrix
+{
+namespace Expr
+{
+
+// The element type and number of elements of the types that can take part
+// in an expression.  Dimension is the number of rows (and columns) of a
+// matrix, and zero for a vector.
+template<typename V>
+struct Traits;
+
+template<typename T>
+struct Traits<tvec2<T> >
+{
+    typedef T Element;
+    static const unsigned int size = 2;
+    static const unsigned int dimension = 0;
+};
+
+template<typename T>
+struct Traits<tvec3<T> >
+{
+    typedef T Element;
+    static const unsigned int size = 3;
+    static const unsigned int dimension = 0;
+};
+
+template<typename T>
+struct Traits<tvec4<T> >
+{
+    typedef T Element;
+    static const unsigned int size = 4;
+    static const unsigned int dimension = 0;
+};
+
+template<typename T>
+struct Traits<tmat2<T> >
+{
+    typedef T Element;
+    static const unsigned int size = 4;
+    static const unsigned int dimension = 2;
+};
+
+template<typename T>
+struct Traits<tmat3<T> >
+{
+    typedef T Element;
+    static const unsigned int size = 9;
+    static const unsigned int dimension = 3;
+};
+
+template<typename T>
+struct Traits<tmat4<T> >
+{
+    typedef T Element;
+    static const unsigned int size = 16;
+    static const unsigned int dimension = 4;
+};
+
+//
+// The base of every node of an expression tree, whose value is of type V.
+// E is the node type itself; it provides at(i), the value of element i
+// (column-major for matrices), and says whether that only depends on
+// element i of its operands ('elementwise').
+//
+template<typename E, typename V>
+class Expression
+{
+public:
+    typedef V Value;
+    typedef typename Traits<V>::Element Element;
+
+    const E& node() const { return static_cast<const E&>(*this); }
+    Element at(unsigned int i) const { return node().at(i); }
+
+    // Evaluate the expression.
+    operator V() const
+    {
+        V result;
+        Element* out(result.data());
+        for (unsigned int i = 0; i < Traits<V>::size; i++)
+        {
+            out[i] = node().at(i);
+        }
+        return result;
+    }
+};
+
+// A vector or matrix operand.
+template<typename V>
+class Ref : public Expression<Ref<V>, V>
+{
+public:
+    typedef typename Traits<V>::Element Element;
+    static const bool elementwise = true;
+
+    explicit Ref(const V& value) : data_(value) {}
+    Element at(unsigned int i) const { return data_[i]; }
+private:
+    const Element* data_;
+};
+
+// A scalar operand, with the same value for every element.
+template<typename V>
+class Scalar : public Expression<Scalar<V>, V>
+{
+public:
+    typedef typename Traits<V>::Element Element;
+    static const bool elementwise = true;
+
+    explicit Scalar(const Element& value) : value_(value) {}
+    Element at(unsigned int) const { return value_; }
+private:
+    Element value_;
+};
+
+struct Add
+{
+    template<typename T>
+    static T apply(const T& a, const T& b) { return a + b; }
+};
+
+struct Subtract
+{
+    template<typename T>
+    static T apply(const T& a, const T& b) { return a - b; }
+};
+
+struct Multiply
+{
+    template<typename T>
+    static T apply(const T& a, const T& b) { return a * b; }
+};
+
+struct Divide
+{
+    template<typename T>
+    static T apply(const T& a, const T& b) { return a / b; }
+};
+
+// An element-wise operation on two operands of the same type.
+template<typename Op, typename L, typename R, typename V>
+class Binary : public Expression<Binary<Op, L, R, V>, V>
+{
+public:
+    typedef typename Traits<V>::Element Element;
+    static const bool elementwise = L::elementwise && R::elementwise;
+
+    Binary(const L& lhs, const R& rhs) : lhs_(lhs), rhs_(rhs) {}
+    Element at(unsigned int i) const { return Op::apply(lhs_.at(i), rhs_.at(i)); }
+private:
+    L lhs_;
+    R rhs_;
+};
+
+// The negation of an operand.
+template<typename E, typename V>
+class Negate : public Expression<Negate<E, V>, V>
+{
+public:
+    typedef typename Traits<V>::Element Element;
+    static const bool elementwise = E::elementwise;
+
+    explicit Negate(const E& operand) : operand_(operand) {}
+    Element at(unsigned int i) const { return -operand_.at(i); }
+private:
+    E operand_;
+};
+
+// The product of two matrices.  The sums are formed in the same order as
+// the matrix operators in mat.h.
+template<typename L, typename R, typename V>
+class MatrixProduct : public Expression<MatrixProduct<L, R, V>, V>
+{
+public:
+    typedef typename Traits<V>::Element Element;
+    static const bool elementwise = false;
+    static const unsigned int dimension = Traits<V>::dimension;
+
+    MatrixProduct(const L& lhs, const R& rhs) : lhs_(lhs), rhs_(rhs) {}
+    Element at(unsigned int i) const
+    {
+        unsigned int row(i % dimension);
+        unsigned int col(i / dimension);
+        Element sum(lhs_.at(row) * rhs_.at(col * dimension));
+        for (unsigned int k = 1; k < dimension; k++)
+        {
+            sum += lhs_.at(k * dimension + row) * rhs_.at(col * dimension + k);
+        }
+        return sum;
+    }
+private:
+    L lhs_;
+    R rhs_;
+};
+
+// The product of a matrix (left) and a column vector (right).
+template<typename L, typename R, typename V>
+class MatrixVectorProduct : public Expression<MatrixVectorProduct<L, R, V>, V>
+{
+public:
+    typedef typename Traits<V>::Element Element;
+    static const bool elementwise = false;
+    static const unsigned int dimension = Traits<V>::size;
+
+    MatrixVectorProduct(const L& lhs, const R& rhs) : lhs_(lhs), rhs_(rhs) {}
+    Element at(unsigned int i) const
+    {
+        Element sum(lhs_.at(i) * rhs_.at(0));
+        for (unsigned int k = 1; k < dimension; k++)
+        {
+            sum += lhs_.at(k * dimension + i) * rhs_.at(k);
+        }
+        return sum;
+    }
+private:
+    L lhs_;
+    R rhs_;
+};
+
+// The product of a row vector (left) and a matrix (right).
+template<typename L, typename R, typename V>
+class VectorMatrixProduct : public Expression<VectorMatrixProduct<L, R, V>, V>
+{
+public:
+    typedef typename Traits<V>::Element Element;
+    static const bool elementwise = false;
+    static const unsigned int dimension = Traits<V>::size;
+
+    VectorMatrixProduct(const L& lhs, const R& rhs) : lhs_(lhs), rhs_(rhs) {}
+    Element at(unsigned int i) const
+    {
+        Element sum(lhs_.at(0) * rhs_.at(i * dimension));
+        for (unsigned int k = 1; k < dimension; k++)
+        {
+            sum += lhs_.at(k) * rhs_.at(i * dimension + k);
+        }
+        return sum;
+    }
+private:
+    L lhs_;
+    R rhs_;
+};
+
+//
+// Which node a * between operands of types VL and VR makes; there is no
+// Node (and so no operator*) for other combinations.
+//
+template<typename L, typename VL, typename R, typename VR>
+struct Product
+{
+};
+
+template<typename L, typename R, typename T>
+struct Product<L, tvec2<T>, R, tvec2<T> >
+{
+    typedef Binary<Multiply, L, R, tvec2<T> > Node;
+};
+
+template<typename L, typename R, typename T>
+struct Product<L, tvec3<T>, R, tvec3<T> >
+{
+    typedef Binary<Multiply, L, R, tvec3<T> > Node;
+};
+
+template<typename L, typename R, typename T>
+struct Product<L, tvec4<T>, R, tvec4<T> >
+{
+    typedef Binary<Multiply, L, R, tvec4<T> > Node;
+};
+
+template<typename L, typename R, typename T>
+struct Product<L, tmat2<T>, R, tmat2<T> >
+{
+    typedef MatrixProduct<L, R, tmat2<T> > Node;
+};
+
+template<typename L, typename R, typename T>
+struct Product<L, tmat3<T>, R, tmat3<T> >
+{
+    typedef MatrixProduct<L, R, tmat3<T> > Node;
+};
+
+template<typename L, typename R, typename T>
+struct Product<L, tmat4<T>, R, tmat4<T> >
+{
+    typedef MatrixProduct<L, R, tmat4<T> > Node;
+};
+
+template<typename L, typename R, typename T>
+struct Product<L, tmat2<T>, R, tvec2<T> >
+{
+    typedef MatrixVectorProduct<L, R, tvec2<T> > Node;
+};
+
+template<typename L, typename R, typename T>
+struct Product<L, tmat3<T>, R, tvec3<T> >
+{
+    typedef MatrixVectorProduct<L, R, tvec3<T> > Node;
+};
+
+template<typename L, typename R, typename T>
+struct Product<L, tmat4<T>, R, tvec4<T> >
+{
+    typedef MatrixVectorProduct<L, R, tvec4<T> > Node;
+};
+
+template<typename L, typename R, typename T>
+struct Product<L, tvec2<T>, R, tmat2<T> >
+{
+    typedef VectorMatrixProduct<L, R, tvec2<T> > Node;
+};
+
+template<typename L, typename R, typename T>
+struct Product<L, tvec3<T>, R, tmat3<T> >
+{
+    typedef VectorMatrixProduct<L, R, tvec3<T> > Node;
+};
+
+template<typename L, typename R, typename T>
+struct Product<L, tvec4<T>, R, tmat4<T> >
+{
+    typedef VectorMatrixProduct<L, R, tvec4<T> > Node;
+};
+
+// Element-wise division is only defined for vectors.
+template<typename L, typename R, typename V>
+struct Quotient
+{
+};
+
+template<typename L, typename R, typename T>
+struct Quotient<L, R, tvec2<T> >
+{
+    typedef Binary<Divide, L, R, tvec2<T> > Node;
+};
+
+template<typename L, typename R, typename T>
+struct Quotient<L, R, tvec3<T> >
+{
+    typedef Binary<Divide, L, R, tvec3<T> > Node;
+};
+
+template<typename L, typename R, typename T>
+struct Quotient<L, R, tvec4<T> >
+{
+    typedef Binary<Divide, L, R, tvec4<T> > Node;
+};
+
+//
+// The operators.  Each one takes expressions and plain vectors or matrices
+// in any combination, as long as at least one operand is an expression.
+//
+template<typename L, typename R, typename V>
+const Binary<Add, L, R, V>
+operator+(const Expression<L, V>& lhs, const Expression<R, V>& rhs)
+{
+    return Binary<Add, L, R, V>(lhs.node(), rhs.node());
+}
+
+template<typename L, typename V>
+const Binary<Add, L, Ref<V>, V>
+operator+(const Expression<L, V>& lhs, const V& rhs)
+{
+    return Binary<Add, L, Ref<V>, V>(lhs.node(), Ref<V>(rhs));
+}
+
+template<typename R, typename V>
+const Binary<Add, Ref<V>, R, V>
+operator+(const V& lhs, const Expression<R, V>& rhs)
+{
+    return Binary<Add, Ref<V>, R, V>(Ref<V>(lhs), rhs.node());
+}
+
+template<typename L, typename R, typename V>
+const Binary<Subtract, L, R, V>
+operator-(const Expression<L, V>& lhs, const Expression<R, V>& rhs)
+{
+    return Binary<Subtract, L, R, V>(lhs.node(), rhs.node());
+}
+
+template<typename L, typename V>
+const Binary<Subtract, L, Ref<V>, V>
+operator-(const Expression<L, V>& lhs, const V& rhs)
+{
+    return Binary<Subtract, L, Ref<V>, V>(lhs.node(), Ref<V>(rhs));
+}
+
+template<typename R, typename V>
+const Binary<Subtract, Ref<V>, R, V>
+operator-(const V& lhs, const Expression<R, V>& rhs)
+{
+    return Binary<Subtract, Ref<V>, R, V>(Ref<V>(lhs), rhs.node());
+}
+
+template<typename E, typename V>
+const Negate<E, V>
+operator-(const Expression<E, V>& operand)
+{
+    return Negate<E, V>(operand.node());
+}
+
+template<typename L, typename VL, typename R, typename VR>
+const typename Product<L, VL, R, VR>::Node
+operator*(const Expression<L, VL>& lhs, const Expression<R, VR>& rhs)
+{
+    return typename Product<L, VL, R, VR>::Node(lhs.node(), rhs.node());
+}
+
+template<typename L, typename VL, typename VR>
+const typename Product<L, VL, Ref<VR>, VR>::Node
+operator*(const Expression<L, VL>& lhs, const VR& rhs)
+{
+    return typename Product<L, VL, Ref<VR>, VR>::Node(lhs.node(), Ref<VR>(rhs));
+}
+
+template<typename VL, typename R, typename VR>
+const typename Product<Ref<VL>, VL, R, VR>::Node
+operator*(const VL& lhs, const Expression<R, VR>& rhs)
+{
+    return typename Product<Ref<VL>, VL, R, VR>::Node(Ref<VL>(lhs), rhs.node());
+}
+
+template<typename L, typename V>
+const Binary<Multiply, L, Scalar<V>, V>
+operator*(const Expression<L, V>& lhs, const typename Traits<V>::Element& rhs)
+{
+    return Binary<Multiply, L, Scalar<V>, V>(lhs.node(), Scalar<V>(rhs));
+}
+
+template<typename R, typename V>
+const Binary<Multiply, Scalar<V>, R, V>
+operator*(const typename Traits<V>::Element& lhs, const Expression<R, V>& rhs)
+{
+    return Binary<Multiply, Scalar<V>, R, V>(Scalar<V>(lhs), rhs.node());
+}
+
+template<typename L, typename R, typename V>
+const typename Quotient<L, R, V>::Node
+operator/(const Expression<L, V>& lhs, const Expression<R, V>& rhs)
+{
+    return typename Quotient<L, R, V>::Node(lhs.node(), rhs.node());
+}
+
+template<typename L, typename V>
+const typename Quotient<L, Ref<V>, V>::Node
+operator/(const Expression<L, V>& lhs, const V& rhs)
+{
+    return typename Quotient<L, Ref<V>, V>::Node(lhs.node(), Ref<V>(rhs));
+}
+
+template<typename R, typename V>
+const typename Quotient<Ref<V>, R, V>::Node
+operator/(const V& lhs, const Expression<R, V>& rhs)
+{
+    return typename Quotient<Ref<V>, R, V>::Node(Ref<V>(lhs), rhs.node());
+}
+
+template<typename L, typename V>
+const Binary<Divide, L, Scalar<V>, V>
+operator/(const Expression<L, V>& lhs, const typename Traits<V>::Element& rhs)
+{
+    return Binary<Divide, L, Scalar<V>, V>(lhs.node(), Scalar<V>(rhs));
+}
+
+} // namespace Expr
+
+// Start a lazy expression with 'value' as its first operand.
+template<typename V>
+const Expr::Ref<V>
+lazy(const V& value)
+{
+    return Expr::Ref<V>(value);
+}
+
+//
+// Evaluate 'expr' straight into 'dst'.  Unlike dst = expr, which evaluates
+// into a new object and copies that, no temporary vector or matrix is
+// created unless 'expr' contains a product (whose operands might include
+// 'dst' itself).
+//
+template<typename E, typename V>
+void
+assign(V& dst, const Expr::Expression<E, V>& expr)
+{
+    typedef typename Expr::Traits<V>::Element Element;
+    const unsigned int size(Expr::Traits<V>::size);
+    Element* out(dst.data());
+    if (E::elementwise)
+    {
+        for (unsigned int i = 0; i < size; i++)
+        {
+            out[i] = expr.node().at(i);
+        }
+        return;
+    }
+    Element result[size];
+    for (unsigned int i = 0; i < size; i++)
+    {
+        result[i] = expr.node().at(i);
+    }
+    for (unsigned int i = 0; i < size; i++)
+    {
+        out[i] = result[i];
+    }
+}
+
+} // namespace LibMatrix
+
+#endif // EXPR_H_
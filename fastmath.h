@@ -0,0 +1,170 @@
+//
+// Copyright (c) 2013 Linaro Limited
+//
+// All rights reserved. This program and the accompanying materials
+// are made available under the terms of the MIT License which accompanies
+// this distribution, and is available at
+// http://www.opensource.org/licenses/mit-license.php
+//
+// Contributors:
+//     Jesse Barker - original implementation.
+//
+#ifndef FASTMATH_H_
+#define FASTMATH_H_
+
+#include <math.h>
+#include <string.h>
+#include <stdint.h>
+#include "simd.h"
+
+namespace LibMatrix
+{
+//
+// Opt-in approximations of the math library functions used when generating
+// transforms, for code that builds many of them (e.g. a transform per
+// instance, every frame).  They work in single precision throughout and
+// avoid the function calls, the double precision conversions and the
+// divides of the precise versions.
+//
+// They can be selected per call, by passing LibMatrix::fast to the
+// overloads that take it, e.g.
+//
+//     mat4 r(LibMatrix::Mat4::rotate(angle, x, y, z, LibMatrix::fast));
+//     v.normalize(LibMatrix::fast);
+//
+// or everywhere, by defining LIBMATRIX_FAST_MATH when building both the
+// library and the code using it, in which case the overloads without the
+// tag use them too.
+//
+struct Fast {};
+static const Fast fast = Fast();
+
+namespace FastMath
+{
+
+// The maximum errors below were measured against the double precision
+// math library on x86 with SSE; test/fastmath_test.cc checks them.
+
+//
+// Reduce |radians| to x in [-pi/4, pi/4] with a three-part pi/4 (so the
+// reduction is exact well beyond the range of angles in degrees), and return
+// the octant j (always even) such that |radians| = j * pi/4 + x.
+//
+// Beyond 2^17 the three parts no longer multiply exactly and the octant
+// soon overflows an int, so larger magnitudes are clamped to 2^17: the
+// results stay finite, but stop changing.  Code that accumulates angles
+// without bound should wrap them itself (e.g. with fmodf()).  NaN and
+// infinity are clamped too (the callers make their results NaN).
+//
+inline int
+reduce(float radians, float& x)
+{
+    static const float fourOverPi(1.27323954473516f);
+    // 2^17.  The clamp compares the bits of |radians| as an integer, which
+    // orders NaN and infinity above any finite float.  (A float comparison
+    // may trap on NaN, so GCC will not turn it into a select, and loops over
+    // arrays of angles would no longer be vectorized.)
+    static const int32_t maxMagnitudeBits(0x48000000);
+    x = fabsf(radians);
+    int32_t bits;
+    memcpy(&bits, &x, sizeof(bits));
+    bits = bits < maxMagnitudeBits ? bits : maxMagnitudeBits;
+    memcpy(&x, &bits, sizeof(x));
+    // Round the octant up to even, so that x - j * pi/4 is in [-pi/4, pi/4].
+    int j(static_cast<int>(x * fourOverPi));
+    j = (j + 1) & ~1;
+    float y(static_cast<float>(j));
+    x = ((x - y * 0.78515625f) - y * 2.4187564849853515625e-4f) - y * 3.77489497744594108e-8f;
+    return j;
+}
+
+//
+// Set 's' and 'c' to the sine and cosine of 'radians'.  The argument is
+// reduced with reduce(), and the sine and cosine are then minimax
+// polynomials.  For |radians| <= 8192 the absolute error of either is at
+// most 1e-7, and up to 2^17 at most 2e-6.  Larger arguments are clamped by
+// reduce(), and NaN and infinite arguments give NaN.
+//
+inline void
+sincos(float radians, float& s, float& c)
+{
+    float sign(radians < 0.0f ? -1.0f : 1.0f);
+    float x;
+    int j(reduce(radians, x));
+    // 0, or NaN if 'radians' is NaN or infinite.
+    float invalid(radians - radians);
+    float z(x * x);
+    float ps(((-1.9515295891e-4f * z + 8.3321608736e-3f) * z - 1.6666654611e-1f) * z * x + x);
+    float pc(((2.443315711809948e-5f * z - 1.388731625493765e-3f) * z + 4.166664568298827e-2f) *
+             z * z - 0.5f * z + 1.0f);
+    // Swap and negate the polynomials according to the octant.  This is
+    // done arithmetically (multiplying by exactly 0 and 1, or -1 and 1), as
+    // branches or selects stop loops over arrays of angles from being
+    // vectorized.
+    float swap(static_cast<float>((j >> 1) & 1));
+    float keep(1.0f - swap);
+    float sinSign(sign * static_cast<float>(1 - (j & 4) / 2));
+    float cosSign(static_cast<float>(1 - ((j + 2) & 4) / 2));
+    s = (ps * keep + pc * swap) * sinSign + invalid;
+    c = (pc * keep + ps * swap) * cosSign + invalid;
+}
+
+//
+// The tangent of 'radians', with the same reduction as sincos() followed by
+// a minimax polynomial for tan on [-pi/4, pi/4], and -1/tan of the reduced
+// argument in the odd quadrants.  For |radians| < pi/2 (i.e. for any field
+// of view) the relative error is at most 2e-7.  Larger arguments work too,
+// but the error of the reduction is magnified near the poles (up to 5e-5
+// where |tan| < 1000, for |radians| <= 8192).  As with sincos(), larger
+// arguments are clamped to 2^17, and NaN and infinity give NaN.
+//
+inline float
+tan(float radians)
+{
+    float sign(radians < 0.0f ? -1.0f : 1.0f);
+    float x;
+    int j(reduce(radians, x));
+    float z(x * x);
+    float t(((((((9.38540185543e-3f * z + 3.11992232697e-3f) * z + 2.44301354525e-2f) * z +
+                5.34112807005e-2f) * z + 1.33387994085e-1f) * z + 3.33331568548e-1f) * z * x + x));
+    if (j & 2)
+    {
+        t = -1.0f / t;
+    }
+    return t * sign + (radians - radians);
+}
+
+//
+// 1/sqrt(x) for x > 0.  With SSE or NEON this starts from the hardware
+// estimate and refines it with Newton-Raphson iteration (one step on SSE,
+// whose estimate is the more precise, two on NEON), for a relative error of
+// at most 3e-7 (5 ulps) over the whole range of normal floats.
+// Otherwise, and for doubles, it is the precise 1/sqrt(x).
+//
+inline float
+rsqrt(float x)
+{
+#if defined(LIBMATRIX_HAVE_SSE)
+    float r(_mm_cvtss_f32(_mm_rsqrt_ss(_mm_set_ss(x))));
+    return r * (1.5f - 0.5f * x * r * r);
+#elif defined(LIBMATRIX_HAVE_NEON)
+    float32x2_t v(vdup_n_f32(x));
+    float32x2_t r(vrsqrte_f32(v));
+    r = vmul_f32(r, vrsqrts_f32(vmul_f32(v, r), r));
+    r = vmul_f32(r, vrsqrts_f32(vmul_f32(v, r), r));
+    return vget_lane_f32(r, 0);
+#else
+    return 1.0f / sqrtf(x);
+#endif
+}
+
+inline double
+rsqrt(double x)
+{
+    return 1.0 / sqrt(x);
+}
+
+} // namespace FastMath
+} // namespace LibMatrix
+
+#endif // FASTMATH_H_
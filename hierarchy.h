@@ -0,0 +1,279 @@
+//
+// Copyright (c) 2013 Linaro Limited
+//
+// All rights reserved. This program and the accompanying materials
+// are made available under the terms of the MIT License which accompanies
+// this distribution, and is available at
+// http://www.opensource.org/licenses/mit-license.php
+//
+// Contributors:
+//     Jesse Barker - original implementation.
+//
+#ifndef HIERARCHY_H_
+#define HIERARCHY_H_
+
+#include <stdexcept>
+#include <vector>
+#include <algorithm>
+#include "mat.h"
+#include "quat.h"
+#include "batch.h"
+#include "thread-pool.h"
+
+namespace LibMatrix
+{
+
+//
+// A retained-mode alternative to walking a scene with Stack4 every frame.
+// The nodes of one or more trees are kept in flat arrays, each node after
+// its parent, with a local transform (relative to its parent) and a world
+// transform (the product of the local transforms from its root down).
+//
+// Changing a local transform only marks the node dirty.  update() then
+// recomputes the world transforms of the dirty nodes and everything below
+// them, in a single pass over the arrays in order, so a parent's world
+// transform is always ready before its children need it.  Runs of dirty
+// siblings (which are adjacent when a tree is added breadth first) are
+// multiplied by their parent's world transform with one Batch::multiply().
+// The pass starts at the first dirty node, and costs nothing when no node
+// has changed.
+//
+// update(pool) does the same work a level at a time, splitting each level
+// across the threads of 'pool'.  For that, the nodes have to be added level
+// by level (all the roots, then all their children, and so on), so that
+// each level is a contiguous range of the arrays whose parents are all in
+// the levels before it.  A hierarchy added in any other order is updated
+// serially instead (see isLevelOrdered()).
+//
+// Either way, each world transform is formed with the same products, in the
+// same order, as by pushing the local transforms from its root down onto a
+// Stack4 with operator*=() (starting from the identity), so the results are
+// the same, bit for bit.
+//
+class TransformHierarchy
+{
+public:
+    // The parent of the root of a tree.
+    static const unsigned int noParent = 0xffffffff;
+
+    TransformHierarchy() :
+        firstDirty_(0),
+        levelOrdered_(true) {}
+
+    // Add a node below 'parent' (an existing node, or noParent for a new
+    // tree) and return its index.  Its world transform is computed by the
+    // next update().  Throws std::invalid_argument if there is no such
+    // parent.
+    unsigned int add(unsigned int parent, const mat4& local = mat4())
+    {
+        if (parent != noParent && parent >= size())
+        {
+            throw std::invalid_argument("Parent node does not exist");
+        }
+        const unsigned int depth(parent == noParent ? 0 : depth_[parent] + 1);
+        const unsigned int numLevels(levelBegin_.size());
+        if (depth == numLevels)
+        {
+            levelBegin_.push_back(size());
+        }
+        else if (depth + 1 != numLevels)
+        {
+            levelOrdered_ = false;
+        }
+        local_.push_back(local);
+        world_.push_back(local);
+        parent_.push_back(parent);
+        depth_.push_back(depth);
+        dirty_.push_back(1);
+        firstDirty_ = std::min(firstDirty_, size() - 1);
+        return size() - 1;
+    }
+
+    // Make room for 'count' nodes in total without reallocating.
+    void reserve(unsigned int count)
+    {
+        local_.reserve(count);
+        world_.reserve(count);
+        parent_.reserve(count);
+        depth_.reserve(count);
+        dirty_.reserve(count);
+    }
+
+    unsigned int size() const { return parent_.size(); }
+    unsigned int getParent(unsigned int node) const { return parent_[node]; }
+    // The number of nodes above 'node' (0 for a root).
+    unsigned int getDepth(unsigned int node) const { return depth_[node]; }
+    // Whether the nodes were added level by level, so that update(pool)
+    // can work on them a level at a time.
+    bool isLevelOrdered() const { return levelOrdered_; }
+    bool isDirty(unsigned int node) const { return dirty_[node] != 0; }
+
+    const mat4& getLocal(unsigned int node) const { return local_[node]; }
+
+    // Replace the local transform of 'node'.
+    void setLocal(unsigned int node, const mat4& local)
+    {
+        local_[node] = local;
+        dirty_[node] = 1;
+        firstDirty_ = std::min(firstDirty_, node);
+    }
+    // Set the local transform of 'node' to
+    // translate(translation) * rotation * scale(scale) (see Mat4::compose()).
+    void setLocal(unsigned int node, const vec3& translation, const mat3& rotation, const vec3& scale)
+    {
+        setLocal(node, Mat4::compose(translation, rotation, scale));
+    }
+    void setLocal(unsigned int node, const vec3& translation, float angle, const vec3& axis,
+                  const vec3& scale)
+    {
+        setLocal(node, Mat4::compose(translation, angle, axis, scale));
+    }
+    void setLocal(unsigned int node, const vec3& translation, const quat& rotation, const vec3& scale)
+    {
+        setLocal(node, Mat4::compose(translation, rotation.toMat3(), scale));
+    }
+
+    // The world transform of 'node' as of the last update().
+    const mat4& getWorld(unsigned int node) const { return world_[node]; }
+    // All of the world transforms, in node order (e.g. for uploading).
+    const mat4* getWorlds() const { return world_.empty() ? 0 : &world_[0]; }
+
+    // Recompute the world transforms of the dirty nodes and their
+    // descendants, and mark every node clean.
+    void update()
+    {
+        const unsigned int count(size());
+        if (firstDirty_ >= count)
+        {
+            return;
+        }
+        // Nodes before the first dirty one cannot have dirty parents.
+        updateRange(firstDirty_, count);
+        markClean();
+    }
+
+    // As update(), but with each level split across the threads of 'pool'
+    // in chunks of 'grain' nodes.  Levels of no more than 'grain' nodes are
+    // handled on the calling thread.
+    void update(ThreadPool& pool, unsigned int grain = Batch::defaultGrain)
+    {
+        const unsigned int count(size());
+        if (firstDirty_ >= count)
+        {
+            return;
+        }
+        if (!levelOrdered_)
+        {
+            update();
+            return;
+        }
+        const unsigned int numLevels(levelBegin_.size());
+        unsigned int level(std::upper_bound(levelBegin_.begin(), levelBegin_.end(), firstDirty_) -
+                           levelBegin_.begin() - 1);
+        for (; level < numLevels; level++)
+        {
+            const unsigned int begin(std::max(levelBegin_[level], firstDirty_));
+            const unsigned int end(level + 1 < numLevels ? levelBegin_[level + 1] : count);
+            LevelTask task(*this, begin);
+            pool.parallelFor(end - begin, grain, task);
+        }
+        markClean();
+    }
+
+private:
+    // Computes the world transforms for a slice of one level.
+    class LevelTask : public RangeTask
+    {
+    public:
+        LevelTask(TransformHierarchy& hierarchy, unsigned int levelBegin) :
+            hierarchy_(hierarchy), levelBegin_(levelBegin) {}
+        void run(unsigned int begin, unsigned int end)
+        {
+            hierarchy_.updateRange(levelBegin_ + begin, levelBegin_ + end);
+        }
+    private:
+        TransformHierarchy& hierarchy_;
+        unsigned int levelBegin_;
+    };
+
+    // Propagate the dirty flags into [first, last) and recompute the world
+    // transforms of its dirty nodes.  The world transforms and dirty flags
+    // of their parents must already be final.
+    void updateRange(unsigned int first, unsigned int last)
+    {
+        const mat4 identity;
+        // Raw pointers, as stores through unsigned char could otherwise
+        // alias the vectors' own and force reloads on every node.
+        const unsigned int* parents(&parent_[0]);
+        unsigned char* dirty(&dirty_[0]);
+        // The pending run of dirty siblings, [begin, node).
+        unsigned int begin(first);
+        unsigned int runParent(noParent);
+        for (unsigned int node = first; node < last; node++)
+        {
+            const unsigned int parent(parents[node]);
+            if (parent != noParent)
+            {
+                dirty[node] |= dirty[parent];
+            }
+            if (!dirty[node])
+            {
+                if (runParent != noParent)
+                {
+                    flush(begin, node, world_[runParent]);
+                    runParent = noParent;
+                }
+                continue;
+            }
+            if (parent != noParent && parent == runParent)
+            {
+                continue;
+            }
+            if (runParent != noParent)
+            {
+                flush(begin, node, world_[runParent]);
+                runParent = noParent;
+            }
+            if (parent == noParent)
+            {
+                // As Stack4 would, starting from the identity.
+                flush(node, node + 1, identity);
+                continue;
+            }
+            begin = node;
+            runParent = parent;
+        }
+        if (runParent != noParent)
+        {
+            flush(begin, last, world_[runParent]);
+        }
+    }
+
+    // Compute the world transforms of the siblings [begin, end) below a
+    // parent with the world transform 'parentWorld'.
+    void flush(unsigned int begin, unsigned int end, const mat4& parentWorld)
+    {
+        Batch::multiply(&world_[begin], parentWorld, &local_[begin], end - begin);
+    }
+
+    void markClean()
+    {
+        std::fill(dirty_.begin() + firstDirty_, dirty_.end(), 0);
+        firstDirty_ = size();
+    }
+
+    std::vector<mat4> local_;
+    std::vector<mat4> world_;
+    std::vector<unsigned int> parent_;
+    std::vector<unsigned int> depth_;
+    std::vector<unsigned char> dirty_;
+    // No node before this one is dirty.
+    unsigned int firstDirty_;
+    // The first node of each level, while levelOrdered_.
+    std::vector<unsigned int> levelBegin_;
+    bool levelOrdered_;
+};
+
+} // namespace LibMatrix
+
+#endif // HIERARCHY_H_
@@ -17,26 +17,6 @@ namespace LibMatrix
 namespace Mat4
 {
 
-mat4
-translate(float x, float y, float z)
-{
-    mat4 t;
-    t[0][3] = x;
-    t[1][3] = y;
-    t[2][3] = z;
-    return t;
-}
-
-mat4
-scale(float x, float y, float z)
-{
-    mat4 s;
-    s[0][0] = x;
-    s[1][1] = y;
-    s[2][2] = z;
-    return s;
-}
-
 //
 // As per the OpenGL "red book" definition of rotation, from the appendix
 // on Homogeneous Coordinates and Transformation Matrices, the "upper left"
@@ -51,98 +31,94 @@ scale(float x, float y, float z)
 // |  z'  0  -x' |
 // | -y'  x'  0  |
 //
-// where x', y' and z' are the elements of u
+// where x', y' and z' are the elements of u.  Each element is computed
+// directly, with the terms summed in the order above.
 //
+static inline mat4
+rotation(const vec3& u, float s, float c)
+{
+    float xx(u.x() * u.x());
+    float yy(u.y() * u.y());
+    float zz(u.z() * u.z());
+    float xy(u.x() * u.y());
+    float xz(u.x() * u.z());
+    float yz(u.y() * u.z());
+    float sx(s * u.x());
+    float sy(s * u.y());
+    float sz(s * u.z());
+    return mat4(xx + c * (1 - xx), xy + (c * -xy + sz), xz + (c * -xz - sy), 0,
+                xy + (c * -xy - sz), yy + c * (1 - yy), yz + (c * -yz + sx), 0,
+                xz + (c * -xz + sy), yz + (c * -yz - sx), zz + c * (1 - zz), 0,
+                0, 0, 0, 1);
+}
+
 mat4
 rotate(float angle, float x, float y, float z)
 {
+#if defined(LIBMATRIX_FAST_MATH)
+    return rotate(angle, x, y, z, fast);
+#else
     vec3 u(x, y, z);
     u.normalize();
-    mat3 uuT = outer(u, u);
-    mat3 s;   
-    s[0][0] = 0;
-    s[0][1] = -u.z();
-    s[0][2] = u.y();
-    s[1][0] = u.z();
-    s[1][1] = 0;
-    s[1][2] = -u.x();
-    s[2][0] = -u.y();
-    s[2][1] = u.x();
-    s[2][2] = 0;
-    mat3 i;
-    i -= uuT;
     // degrees to radians
     float angleRadians(angle * M_PI / 180.0);
-    i *= cos(angleRadians);
-    s *= sin(angleRadians);
-    i += s;
-    mat3 m = uuT + i;
-    mat4 r;
-    r[0][0] = m[0][0];
-    r[0][1] = m[0][1];
-    r[0][2] = m[0][2];
-    r[1][0] = m[1][0];
-    r[1][1] = m[1][1];
-    r[1][2] = m[1][2];
-    r[2][0] = m[2][0];
-    r[2][1] = m[2][1];
-    r[2][2] = m[2][2];
-    return r;
+    return rotation(u, sin(angleRadians), cos(angleRadians));
+#endif
 }
 
 mat4
-frustum(float left, float right, float bottom, float top, float near, float far)
+rotate(float angle, float x, float y, float z, Fast)
 {
-    float twiceNear(2 * near);
-    float width(right - left);
-    float height(top - bottom);
-    float depth(far - near);
-    mat4 f;
-    f[0][0] = twiceNear / width;
-    f[0][2] = (right + left) / width;
-    f[1][1] = twiceNear / height;
-    f[1][2] = (top + bottom) / height;
-    f[2][2] = -(far + near) / depth;
-    f[2][3] = -(twiceNear * far) / depth;
-    f[3][2] = -1;
-    f[3][3] = 0;
-    return f;
+    vec3 u(x, y, z);
+    u.normalize(fast);
+    // FastMath::sincos() clamps very large arguments, so wrap angles that
+    // have been accumulated without bound (exactly) first.
+    if (fabsf(angle) >= 360.0f)
+    {
+        angle = fmodf(angle, 360.0f);
+    }
+    float s;
+    float c;
+    FastMath::sincos(angle * static_cast<float>(M_PI / 180.0), s, c);
+    return rotation(u, s, c);
 }
 
-mat4
-ortho(float left, float right, float bottom, float top, float near, float far)
+// f is the cotangent of half the field of view.
+static inline mat4
+perspectiveFromCotangent(float f, float aspect, float zNear, float zFar)
 {
-    float width(right - left);
-    float height(top - bottom);
-    float depth(far - near);
-    mat4 o;
-    o[0][0] = 2 / width;
-    o[0][3] = (right + left) / width;
-    o[1][1] = 2 / height;
-    o[1][3] = (top + bottom) / height;
-    o[2][2] = -2 / depth;
-    o[2][3] = (far + near) / depth;
-    return o;
+    float depth(zNear - zFar);
+    return mat4(f / aspect, 0, 0, 0,
+                0, f, 0, 0,
+                0, 0, (zFar + zNear) / depth, -1,
+                0, 0, (2 * zFar * zNear) / depth, 0);
 }
 
 mat4
 perspective(float fovy, float aspect, float zNear, float zFar)
 {
+#if defined(LIBMATRIX_FAST_MATH)
+    return perspective(fovy, aspect, zNear, zFar, fast);
+#else
     // degrees to radians
     float fovyRadians(fovy * M_PI / 180.0);
     // cotangent(x) = 1/tan(x)
-    float f = 1/tan(fovyRadians / 2);
-    float depth(zNear - zFar);
-    mat4 p;
-    p[0][0] = f / aspect;
-    p[1][1] = f;
-    p[2][2] = (zFar + zNear) / depth;
-    p[2][3] = (2 * zFar * zNear) / depth;
-    p[3][2] = -1;
-    p[3][3] = 0;
-    return p;
+    return perspectiveFromCotangent(1/tan(fovyRadians / 2), aspect, zNear, zFar);
+#endif
 }
 
+mat4
+perspective(float fovy, float aspect, float zNear, float zFar, Fast)
+{
+    // Half of fovy, in radians.
+    float halfAngle(fovy * static_cast<float>(M_PI / 360.0));
+    return perspectiveFromCotangent(1 / FastMath::tan(halfAngle), aspect, zNear, zFar);
+}
+
+//
+// The rows of the upper 3x3 are s, u and -f, and the translation is that
+// rotation applied to -eye.
+//
 mat4 lookAt(float eyeX, float eyeY, float eyeZ, 
     float centerX, float centerY, float centerZ, 
     float upX, float upY, float upZ)
@@ -154,18 +130,32 @@ mat4 lookAt(float eyeX, float eyeY, float eyeZ,
     vec3 u = vec3::cross(s, f);
     s.normalize();
     u.normalize();
-    mat4 la;
-    la[0][0] = s.x();
-    la[0][1] = s.y();
-    la[0][2] = s.z();
-    la[1][0] = u.x();
-    la[1][1] = u.y();
-    la[1][2] = u.z();
-    la[2][0] = -f.x();
-    la[2][1] = -f.y();
-    la[2][2] = -f.z();
-    la *= translate(-eyeX, -eyeY, -eyeZ);
-    return la;
+    vec3 eye(eyeX, eyeY, eyeZ);
+    return mat4(s.x(), u.x(), -f.x(), 0,
+                s.y(), u.y(), -f.y(), 0,
+                s.z(), u.z(), -f.z(), 0,
+                -vec3::dot(s, eye), -vec3::dot(u, eye), vec3::dot(f, eye), 1);
+}
+
+mat4
+compose(const vec3& translation, const mat3& rotation, const vec3& scale)
+{
+    const float* r(rotation);
+    return mat4(r[0] * scale.x(), r[1] * scale.x(), r[2] * scale.x(), 0,
+                r[3] * scale.y(), r[4] * scale.y(), r[5] * scale.y(), 0,
+                r[6] * scale.z(), r[7] * scale.z(), r[8] * scale.z(), 0,
+                translation.x(), translation.y(), translation.z(), 1);
+}
+
+mat4
+compose(const vec3& translation, float angle, const vec3& axis, const vec3& scale)
+{
+    mat4 m(rotate(angle, axis.x(), axis.y(), axis.z()));
+    m.setColumn(0, m.column(0) * scale.x());
+    m.setColumn(1, m.column(1) * scale.y());
+    m.setColumn(2, m.column(2) * scale.z());
+    m.setColumn(3, vec4(translation.x(), translation.y(), translation.z(), 1));
+    return m;
 }
 
 } // namespace Mat4
@@ -15,9 +15,44 @@
 #include <iostream>
 #include <iomanip>
 #include "vec.h"
+#include "simd.h"
+
+// The vectorized 4x4 multiply cannot run at compile time, so it is only
+// usable in constant expressions where the compiler can tell us that it is
+// being evaluated at compile time, and a scalar path can be taken instead.
+#if __cplusplus >= 201402L
+#if defined(__has_builtin)
+#if __has_builtin(__builtin_is_constant_evaluated)
+#define LIBMATRIX_HAVE_CONSTANT_EVALUATED
+#endif
+#elif defined(__GNUC__) && __GNUC__ >= 9
+#define LIBMATRIX_HAVE_CONSTANT_EVALUATED
+#endif
+#endif
+
+#if defined(LIBMATRIX_HAVE_CONSTANT_EVALUATED)
+#define LIBMATRIX_CONSTEXPR_MULTIPLY constexpr
+#else
+#define LIBMATRIX_CONSTEXPR_MULTIPLY
+#endif
 
 namespace LibMatrix
 {
+// Tag for the matrix constructors that leave the elements unset, for
+// results whose every element is about to be overwritten, e.g.
+//     mat4 m(LibMatrix::uninitialized);
+// Reading an element of such a matrix before writing it is undefined.
+// These constructors cannot be used in constant expressions.
+struct Uninitialized {};
+static const Uninitialized uninitialized = Uninitialized();
+
+// Fails to compile unless 'condition' holds, for checking template
+// arguments such as the indices of tmat4::at<Row, Col>().
+template<bool condition>
+struct CompileTimeCheck;
+template<>
+struct CompileTimeCheck<true> {};
+
 // Proxy class for providing the functionality of a doubly-dimensioned array
 // representation of matrices.  Each matrix class defines its operator[]
 // to return an ArrayProxy.  The ArrayProxy then returns the appropriate item
@@ -26,13 +61,12 @@ template<typename T, unsigned int dimension>
 class ArrayProxy
 {
 public:
-    ArrayProxy(T* data) { data_ = data; }
-    ~ArrayProxy() { data_ = 0; }
-    T& operator[](int index)
+    LIBMATRIX_CONSTEXPR ArrayProxy(T* data) : data_(data) {}
+    LIBMATRIX_CONSTEXPR T& operator[](int index)
     {
         return data_[index * dimension];
     }
-    const T& operator[](int index) const
+    LIBMATRIX_CONSTEXPR const T& operator[](int index) const
     {
         return data_[index * dimension];
     }
@@ -55,28 +89,31 @@ template<typename T>
 class tmat2
 {
 public:
-    tmat2()
+    LIBMATRIX_CONSTEXPR tmat2() :
+        m_()
     {
         setIdentity();
     }
-    tmat2(const tmat2& m)
+    explicit tmat2(Uninitialized) {}
+    // Brace initialization (where available) lets the compiler write each
+    // element just once.
+    LIBMATRIX_CONSTEXPR tmat2(const T& c0r0, const T& c0r1, const T& c1r0, const T& c1r1)
+#if __cplusplus >= 201103L
+        : m_{c0r0, c0r1,
+            c1r0, c1r1}
     {
-        m_[0] = m.m_[0];
-        m_[1] = m.m_[1];
-        m_[2] = m.m_[2];
-        m_[3] = m.m_[3];
     }
-    tmat2(const T& c0r0, const T& c0r1, const T& c1r0, const T& c1r1)
+#else
     {
         m_[0] = c0r0;
         m_[1] = c0r1;
         m_[2] = c1r0;
         m_[3] = c1r1;
     }
-    ~tmat2() {}
+#endif
 
     // Reset this to the identity matrix.
-    void setIdentity()
+    LIBMATRIX_CONSTEXPR void setIdentity()
     {
         m_[0] = 1;
         m_[1] = 0;
@@ -85,7 +122,7 @@ public:
     }
 
     // Transpose this.  Return a reference to this.
-    tmat2& transpose()
+    LIBMATRIX_CONSTEXPR tmat2& transpose()
     {
         T tmp_val = m_[1];
         m_[1] = m_[2];
@@ -94,7 +131,7 @@ public:
     }
 
     // Compute the determinant of this and return it.
-    T determinant()
+    LIBMATRIX_CONSTEXPR T determinant() const
     {
         return (m_[0] * m_[3]) - (m_[2] * m_[1]);
     }
@@ -103,22 +140,30 @@ public:
     //
     // NOTE: If this is non-invertible, we will
     //       throw to avoid undefined behavior.
-    tmat2& inverse() throw(std::runtime_error)
+    tmat2& inverse()
     {
         T d(determinant());
         if (d == static_cast<T>(0))
         {
             throw std::runtime_error("Matrix is noninvertible!!!!");
         }
-        T c0r0(m_[3] / d);
-        T c0r1(-m_[1] / d);
-        T c1r0(-m_[2] / d);
-        T c1r1(m_[0] / d);
-        m_[0] = c0r0;
-        m_[1] = c0r1;
-        m_[2] = c1r0;
-        m_[3] = c1r1;        
-        return *this;
+        return invert(d);
+    }
+
+    // Compute the inverse of this into 'out' without throwing.  Return true
+    // on success.  If the magnitude of the determinant is not greater than
+    // 'epsilon', return false and leave 'out' untouched, so near-singular
+    // matrices can be rejected along with singular ones.
+    bool tryInverse(T epsilon, tmat2& out) const
+    {
+        T d(determinant());
+        if (magnitude(d) <= epsilon)
+        {
+            return false;
+        }
+        out = *this;
+        out.invert(d);
+        return true;
     }
 
     // Print the elements of the matrix to standard out.
@@ -143,10 +188,14 @@ public:
     // Allow raw data access for API calls and the like.
     // For example, it is valid to pass a tmat2<float> into a call to
     // the OpenGL command "glUniformMatrix2fv()".
-    operator const T*() const { return &m_[0];}
+    LIBMATRIX_CONSTEXPR operator const T*() const { return &m_[0];}
+
+    // Allow writable raw access to the (column-major) elements, for the
+    // batch kernels and the like.
+    T* data() { return &m_[0]; }
 
     // Test if 'rhs' is equal to this.
-    bool operator==(const tmat2& rhs) const
+    LIBMATRIX_CONSTEXPR bool operator==(const tmat2& rhs) const
     {
         return m_[0] == rhs.m_[0] &&
                m_[1] == rhs.m_[1] &&
@@ -155,26 +204,13 @@ public:
     }
 
     // Test if 'rhs' is not equal to this.
-    bool operator!=(const tmat2& rhs) const
+    LIBMATRIX_CONSTEXPR bool operator!=(const tmat2& rhs) const
     {
         return !(*this == rhs);
     }
 
-    // A direct assignment of 'rhs' to this.  Return a reference to this.
-    tmat2& operator=(const tmat2& rhs)
-    {
-        if (this != &rhs)
-        {
-            m_[0] = rhs.m_[0];
-            m_[1] = rhs.m_[1];
-            m_[2] = rhs.m_[2];
-            m_[3] = rhs.m_[3];
-        }
-        return *this;
-    }
-
     // Add another matrix to this.  Return a reference to this.
-    tmat2& operator+=(const tmat2& rhs)
+    LIBMATRIX_CONSTEXPR tmat2& operator+=(const tmat2& rhs)
     {
         m_[0] += rhs.m_[0];
         m_[1] += rhs.m_[1];
@@ -184,13 +220,13 @@ public:
     }
 
     // Add another matrix to a copy of this.  Return the copy.
-    const tmat2 operator+(const tmat2& rhs)
+    LIBMATRIX_CONSTEXPR const tmat2 operator+(const tmat2& rhs) const
     {
         return tmat2(*this) += rhs;
     }
 
     // Subtract another matrix from this.  Return a reference to this.
-    tmat2& operator-=(const tmat2& rhs)
+    LIBMATRIX_CONSTEXPR tmat2& operator-=(const tmat2& rhs)
     {
         m_[0] -= rhs.m_[0];
         m_[1] -= rhs.m_[1];
@@ -200,13 +236,13 @@ public:
     }
 
     // Subtract another matrix from a copy of this.  Return the copy.
-    const tmat2 operator-(const tmat2& rhs)
+    LIBMATRIX_CONSTEXPR const tmat2 operator-(const tmat2& rhs) const
     {
         return tmat2(*this) += rhs;
     }
 
     // Multiply this by another matrix.  Return a reference to this.
-    tmat2& operator*=(const tmat2& rhs)
+    LIBMATRIX_CONSTEXPR tmat2& operator*=(const tmat2& rhs)
     {
         T c0r0((m_[0] * rhs.m_[0]) + (m_[2] * rhs.m_[1]));
         T c0r1((m_[1] * rhs.m_[0]) + (m_[3] * rhs.m_[1]));
@@ -220,13 +256,13 @@ public:
     }
 
     // Multiply a copy of this by another matrix.  Return the copy.
-    const tmat2 operator*(const tmat2& rhs)
+    LIBMATRIX_CONSTEXPR const tmat2 operator*(const tmat2& rhs) const
     {
         return tmat2(*this) *= rhs;
     }
 
     // Multiply this by a scalar.  Return a reference to this.
-    tmat2& operator*=(const T& rhs)
+    LIBMATRIX_CONSTEXPR tmat2& operator*=(const T& rhs)
     {
         m_[0] *= rhs;
         m_[1] *= rhs;
@@ -236,13 +272,13 @@ public:
     }
 
     // Multiply a copy of this by a scalar.  Return the copy.
-    const tmat2 operator*(const T& rhs)
+    LIBMATRIX_CONSTEXPR const tmat2 operator*(const T& rhs) const
     {
         return tmat2(*this) *= rhs;
     }
 
     // Divide this by a scalar.  Return a reference to this.
-    tmat2& operator/=(const T& rhs)
+    LIBMATRIX_CONSTEXPR tmat2& operator/=(const T& rhs)
     {
         m_[0] /= rhs;
         m_[1] /= rhs;
@@ -252,7 +288,7 @@ public:
     }
 
     // Divide a copy of this by a scalar.  Return the copy.
-    const tmat2 operator/(const T& rhs)
+    LIBMATRIX_CONSTEXPR const tmat2 operator/(const T& rhs) const
     {
         return tmat2(*this) /= rhs;
     }
@@ -260,23 +296,83 @@ public:
     // Use an instance of the ArrayProxy class to support double-indexed
     // references to a matrix (i.e., m[1][1]).  See comments above the
     // ArrayProxy definition for more details.
-    ArrayProxy<T, 2> operator[](int index)
+    LIBMATRIX_CONSTEXPR ArrayProxy<T, 2> operator[](int index)
     {
         return ArrayProxy<T, 2>(&m_[index]);
     }
-    const ArrayProxy<T, 2> operator[](int index) const
+    LIBMATRIX_CONSTEXPR const ArrayProxy<T, 2> operator[](int index) const
     {
         return ArrayProxy<T, 2>(const_cast<T*>(&m_[index]));
     }
 
+    // Direct access to the element at 'row', 'col', without the
+    // ArrayProxy.  m(row, col) is the same element as m[row][col].
+    LIBMATRIX_CONSTEXPR T& operator()(unsigned int row, unsigned int col)
+    {
+        return m_[col * 2 + row];
+    }
+    LIBMATRIX_CONSTEXPR const T& operator()(unsigned int row, unsigned int col) const
+    {
+        return m_[col * 2 + row];
+    }
+
+    // The same, with the indices fixed (and checked) at compile time.
+    template<unsigned int Row, unsigned int Col>
+    LIBMATRIX_CONSTEXPR T& at()
+    {
+        (void) sizeof(CompileTimeCheck<(Row < 2 && Col < 2)>);
+        return m_[Col * 2 + Row];
+    }
+    template<unsigned int Row, unsigned int Col>
+    LIBMATRIX_CONSTEXPR const T& at() const
+    {
+        (void) sizeof(CompileTimeCheck<(Row < 2 && Col < 2)>);
+        return m_[Col * 2 + Row];
+    }
+
+    // Get and set whole columns and rows as vectors.
+    LIBMATRIX_CONSTEXPR const tvec2<T> column(unsigned int col) const
+    {
+        const T* c(&m_[col * 2]);
+        return tvec2<T>(c[0], c[1]);
+    }
+    LIBMATRIX_CONSTEXPR const tvec2<T> row(unsigned int row) const
+    {
+        return tvec2<T>(m_[row], m_[2 + row]);
+    }
+    LIBMATRIX_CONSTEXPR void setColumn(unsigned int col, const tvec2<T>& v)
+    {
+        m_[col * 2 + 0] = v.x();
+        m_[col * 2 + 1] = v.y();
+    }
+    LIBMATRIX_CONSTEXPR void setRow(unsigned int row, const tvec2<T>& v)
+    {
+        m_[row] = v.x();
+        m_[2 + row] = v.y();
+    }
+
 private:
+    // Replace this with its inverse, given its (nonzero) determinant 'd'.
+    tmat2& invert(const T& d)
+    {
+        T c0r0(m_[3] / d);
+        T c0r1(-m_[1] / d);
+        T c1r0(-m_[2] / d);
+        T c1r1(m_[0] / d);
+        m_[0] = c0r0;
+        m_[1] = c0r1;
+        m_[2] = c1r0;
+        m_[3] = c1r1;
+        return *this;
+    }
+
     T m_[4];
 };
 
 // Multiply a scalar and a matrix just like the member operator, but allow
 // the scalar to be the left-hand operand.
 template<typename T>
-const tmat2<T> operator*(const T& lhs, const tmat2<T>& rhs)
+LIBMATRIX_CONSTEXPR const tmat2<T> operator*(const T& lhs, const tmat2<T>& rhs)
 {
     return tmat2<T>(rhs) * lhs;
 }
@@ -284,7 +380,7 @@ const tmat2<T> operator*(const T& lhs, const tmat2<T>& rhs)
 // Multiply a copy of a vector and a matrix (matrix is right-hand operand).
 // Return the copy.
 template<typename T>
-const tvec2<T> operator*(const tvec2<T>& lhs, const tmat2<T>& rhs)
+LIBMATRIX_CONSTEXPR const tvec2<T> operator*(const tvec2<T>& lhs, const tmat2<T>& rhs)
 {
     T x((lhs.x() * rhs[0][0]) + (lhs.y() * rhs[1][0]));
     T y((lhs.x() * rhs[0][1]) + (lhs.y() * rhs[1][1]));
@@ -294,7 +390,7 @@ const tvec2<T> operator*(const tvec2<T>& lhs, const tmat2<T>& rhs)
 // Multiply a copy of a vector and a matrix (matrix is left-hand operand).
 // Return the copy.
 template<typename T>
-const tvec2<T> operator*(const tmat2<T>& lhs, const tvec2<T>& rhs)
+LIBMATRIX_CONSTEXPR const tvec2<T> operator*(const tmat2<T>& lhs, const tvec2<T>& rhs)
 {
     T x((lhs[0][0] * rhs.x()) + (lhs[0][1] * rhs.y()));
     T y((lhs[1][0] * rhs.x()) + (lhs[1][1] * rhs.y()));
@@ -305,7 +401,7 @@ const tvec2<T> operator*(const tmat2<T>& lhs, const tvec2<T>& rhs)
 template<typename T>
 const tmat2<T> outer(const tvec2<T>& a, const tvec2<T>& b)
 {
-    tmat2<T> product;
+    tmat2<T> product(uninitialized);
     product[0][0] = a.x() * b.x();
     product[0][1] = a.x() * b.y();
     product[1][0] = a.y() * b.x();
@@ -321,25 +417,22 @@ template<typename T>
 class tmat3
 {
 public:
-    tmat3()
+    LIBMATRIX_CONSTEXPR tmat3() :
+        m_()
     {
         setIdentity();
     }
-    tmat3(const tmat3& m)
-    {
-        m_[0] = m.m_[0];
-        m_[1] = m.m_[1];
-        m_[2] = m.m_[2];
-        m_[3] = m.m_[3];
-        m_[4] = m.m_[4];
-        m_[5] = m.m_[5];
-        m_[6] = m.m_[6];
-        m_[7] = m.m_[7];
-        m_[8] = m.m_[8];
-    }
-    tmat3(const T& c0r0, const T& c0r1, const T& c0r2,
+    explicit tmat3(Uninitialized) {}
+    LIBMATRIX_CONSTEXPR tmat3(const T& c0r0, const T& c0r1, const T& c0r2,
           const T& c1r0, const T& c1r1, const T& c1r2,
           const T& c2r0, const T& c2r1, const T& c2r2)
+#if __cplusplus >= 201103L
+        : m_{c0r0, c0r1, c0r2,
+            c1r0, c1r1, c1r2,
+            c2r0, c2r1, c2r2}
+    {
+    }
+#else
     {
         m_[0] = c0r0;
         m_[1] = c0r1;
@@ -351,10 +444,10 @@ public:
         m_[7] = c2r1;
         m_[8] = c2r2;
     }
-    ~tmat3() {}
+#endif
 
     // Reset this to the identity matrix.
-    void setIdentity()
+    LIBMATRIX_CONSTEXPR void setIdentity()
     {
         m_[0] = 1;
         m_[1] = 0;
@@ -368,7 +461,7 @@ public:
     }
 
     // Transpose this.  Return a reference to this.
-    tmat3& transpose()
+    LIBMATRIX_CONSTEXPR tmat3& transpose()
     {
         T tmp_val = m_[1];
         m_[1] = m_[3];
@@ -383,7 +476,7 @@ public:
     }
 
     // Compute the determinant of this and return it.
-    T determinant()
+    LIBMATRIX_CONSTEXPR T determinant() const
     {
         tmat2<T> minor0(m_[4], m_[5], m_[7], m_[8]);
         tmat2<T> minor3(m_[1], m_[2], m_[7], m_[8]);
@@ -397,32 +490,30 @@ public:
     //
     // NOTE: If this is non-invertible, we will
     //       throw to avoid undefined behavior.
-    tmat3& inverse() throw(std::runtime_error)
+    tmat3& inverse()
     {
         T d(determinant());
         if (d == static_cast<T>(0))
         {
             throw std::runtime_error("Matrix is noninvertible!!!!");
         }
-        tmat2<T> minor0(m_[4], m_[5], m_[7], m_[8]);
-        tmat2<T> minor1(m_[7], m_[8], m_[1], m_[2]);
-        tmat2<T> minor2(m_[1], m_[2], m_[4], m_[5]);
-        tmat2<T> minor3(m_[6], m_[8], m_[3], m_[5]);
-        tmat2<T> minor4(m_[0], m_[2], m_[6], m_[8]);
-        tmat2<T> minor5(m_[3], m_[5], m_[0], m_[2]);
-        tmat2<T> minor6(m_[3], m_[4], m_[6], m_[7]);
-        tmat2<T> minor7(m_[6], m_[7], m_[0], m_[1]);
-        tmat2<T> minor8(m_[0], m_[1], m_[3], m_[4]);
-        m_[0] = minor0.determinant() / d;
-        m_[1] = minor1.determinant() / d;
-        m_[2] = minor2.determinant() / d;
-        m_[3] = minor3.determinant() / d;
-        m_[4] = minor4.determinant() / d;
-        m_[5] = minor5.determinant() / d;
-        m_[6] = minor6.determinant() / d;
-        m_[7] = minor7.determinant() / d;
-        m_[8] = minor8.determinant() / d;
-        return *this;       
+        return invert(d);
+    }
+
+    // Compute the inverse of this into 'out' without throwing.  Return true
+    // on success.  If the magnitude of the determinant is not greater than
+    // 'epsilon', return false and leave 'out' untouched, so near-singular
+    // matrices can be rejected along with singular ones.
+    bool tryInverse(T epsilon, tmat3& out) const
+    {
+        T d(determinant());
+        if (magnitude(d) <= epsilon)
+        {
+            return false;
+        }
+        out = *this;
+        out.invert(d);
+        return true;
     }
 
     // Print the elements of the matrix to standard out.
@@ -459,10 +550,14 @@ public:
     // Allow raw data access for API calls and the like.
     // For example, it is valid to pass a tmat3<float> into a call to
     // the OpenGL command "glUniformMatrix3fv()".
-    operator const T*() const { return &m_[0];}
+    LIBMATRIX_CONSTEXPR operator const T*() const { return &m_[0];}
+
+    // Allow writable raw access to the (column-major) elements, for the
+    // batch kernels and the like.
+    T* data() { return &m_[0]; }
 
     // Test if 'rhs' is equal to this.
-    bool operator==(const tmat3& rhs) const
+    LIBMATRIX_CONSTEXPR bool operator==(const tmat3& rhs) const
     {
         return m_[0] == rhs.m_[0] &&
                m_[1] == rhs.m_[1] &&
@@ -476,31 +571,13 @@ public:
     }
 
     // Test if 'rhs' is not equal to this.
-    bool operator!=(const tmat3& rhs) const
+    LIBMATRIX_CONSTEXPR bool operator!=(const tmat3& rhs) const
     {
         return !(*this == rhs);
     }
 
-    // A direct assignment of 'rhs' to this.  Return a reference to this.
-    tmat3& operator=(const tmat3& rhs)
-    {
-        if (this != &rhs)
-        {
-            m_[0] = rhs.m_[0];
-            m_[1] = rhs.m_[1];
-            m_[2] = rhs.m_[2];
-            m_[3] = rhs.m_[3];
-            m_[4] = rhs.m_[4];
-            m_[5] = rhs.m_[5];
-            m_[6] = rhs.m_[6];
-            m_[7] = rhs.m_[7];
-            m_[8] = rhs.m_[8];
-        }
-        return *this;
-    }
-
     // Add another matrix to this.  Return a reference to this.
-    tmat3& operator+=(const tmat3& rhs)
+    LIBMATRIX_CONSTEXPR tmat3& operator+=(const tmat3& rhs)
     {
         m_[0] += rhs.m_[0];
         m_[1] += rhs.m_[1];
@@ -515,13 +592,13 @@ public:
     }
 
     // Add another matrix to a copy of this.  Return the copy.
-    const tmat3 operator+(const tmat3& rhs)
+    LIBMATRIX_CONSTEXPR const tmat3 operator+(const tmat3& rhs) const
     {
         return tmat3(*this) += rhs;
     }
 
     // Subtract another matrix from this.  Return a reference to this.
-    tmat3& operator-=(const tmat3& rhs)
+    LIBMATRIX_CONSTEXPR tmat3& operator-=(const tmat3& rhs)
     {
         m_[0] -= rhs.m_[0];
         m_[1] -= rhs.m_[1];
@@ -536,13 +613,13 @@ public:
     }
 
     // Subtract another matrix from a copy of this.  Return the copy.
-    const tmat3 operator-(const tmat3& rhs)
+    LIBMATRIX_CONSTEXPR const tmat3 operator-(const tmat3& rhs) const
     {
         return tmat3(*this) -= rhs;
     }
 
     // Multiply this by another matrix.  Return a reference to this.
-    tmat3& operator*=(const tmat3& rhs)
+    LIBMATRIX_CONSTEXPR tmat3& operator*=(const tmat3& rhs)
     {
         T c0r0((m_[0] * rhs.m_[0]) + (m_[3] * rhs.m_[1]) + (m_[6] * rhs.m_[2]));
         T c0r1((m_[1] * rhs.m_[0]) + (m_[4] * rhs.m_[1]) + (m_[7] * rhs.m_[2]));
@@ -566,13 +643,13 @@ public:
     }
 
     // Multiply a copy of this by another matrix.  Return the copy.
-    const tmat3 operator*(const tmat3& rhs)
+    LIBMATRIX_CONSTEXPR const tmat3 operator*(const tmat3& rhs) const
     {
         return tmat3(*this) *= rhs;
     }
 
     // Multiply this by a scalar.  Return a reference to this.
-    tmat3& operator*=(const T& rhs)
+    LIBMATRIX_CONSTEXPR tmat3& operator*=(const T& rhs)
     {
         m_[0] *= rhs;
         m_[1] *= rhs;
@@ -587,13 +664,13 @@ public:
     }
 
     // Multiply a copy of this by a scalar.  Return the copy.
-    const tmat3 operator*(const T& rhs)
+    LIBMATRIX_CONSTEXPR const tmat3 operator*(const T& rhs) const
     {
         return tmat3(*this) *= rhs;
     }
 
     // Divide this by a scalar.  Return a reference to this.
-    tmat3& operator/=(const T& rhs)
+    LIBMATRIX_CONSTEXPR tmat3& operator/=(const T& rhs)
     {
         m_[0] /= rhs;
         m_[1] /= rhs;
@@ -608,7 +685,7 @@ public:
     }
 
     // Divide a copy of this by a scalar.  Return the copy.
-    const tmat3 operator/(const T& rhs)
+    LIBMATRIX_CONSTEXPR const tmat3 operator/(const T& rhs) const
     {
         return tmat3(*this) /= rhs;
     }
@@ -616,23 +693,95 @@ public:
     // Use an instance of the ArrayProxy class to support double-indexed
     // references to a matrix (i.e., m[1][1]).  See comments above the
     // ArrayProxy definition for more details.
-    ArrayProxy<T, 3> operator[](int index)
+    LIBMATRIX_CONSTEXPR ArrayProxy<T, 3> operator[](int index)
     {
         return ArrayProxy<T, 3>(&m_[index]);
     }
-    const ArrayProxy<T, 3> operator[](int index) const
+    LIBMATRIX_CONSTEXPR const ArrayProxy<T, 3> operator[](int index) const
     {
         return ArrayProxy<T, 3>(const_cast<T*>(&m_[index]));
     }
 
+    // Direct access to the element at 'row', 'col', without the
+    // ArrayProxy.  m(row, col) is the same element as m[row][col].
+    LIBMATRIX_CONSTEXPR T& operator()(unsigned int row, unsigned int col)
+    {
+        return m_[col * 3 + row];
+    }
+    LIBMATRIX_CONSTEXPR const T& operator()(unsigned int row, unsigned int col) const
+    {
+        return m_[col * 3 + row];
+    }
+
+    // The same, with the indices fixed (and checked) at compile time.
+    template<unsigned int Row, unsigned int Col>
+    LIBMATRIX_CONSTEXPR T& at()
+    {
+        (void) sizeof(CompileTimeCheck<(Row < 3 && Col < 3)>);
+        return m_[Col * 3 + Row];
+    }
+    template<unsigned int Row, unsigned int Col>
+    LIBMATRIX_CONSTEXPR const T& at() const
+    {
+        (void) sizeof(CompileTimeCheck<(Row < 3 && Col < 3)>);
+        return m_[Col * 3 + Row];
+    }
+
+    // Get and set whole columns and rows as vectors.
+    LIBMATRIX_CONSTEXPR const tvec3<T> column(unsigned int col) const
+    {
+        const T* c(&m_[col * 3]);
+        return tvec3<T>(c[0], c[1], c[2]);
+    }
+    LIBMATRIX_CONSTEXPR const tvec3<T> row(unsigned int row) const
+    {
+        return tvec3<T>(m_[row], m_[3 + row], m_[6 + row]);
+    }
+    LIBMATRIX_CONSTEXPR void setColumn(unsigned int col, const tvec3<T>& v)
+    {
+        m_[col * 3 + 0] = v.x();
+        m_[col * 3 + 1] = v.y();
+        m_[col * 3 + 2] = v.z();
+    }
+    LIBMATRIX_CONSTEXPR void setRow(unsigned int row, const tvec3<T>& v)
+    {
+        m_[row] = v.x();
+        m_[3 + row] = v.y();
+        m_[6 + row] = v.z();
+    }
+
 private:
+    // Replace this with its inverse, given its (nonzero) determinant 'd'.
+    tmat3& invert(const T& d)
+    {
+        tmat2<T> minor0(m_[4], m_[5], m_[7], m_[8]);
+        tmat2<T> minor1(m_[7], m_[8], m_[1], m_[2]);
+        tmat2<T> minor2(m_[1], m_[2], m_[4], m_[5]);
+        tmat2<T> minor3(m_[6], m_[8], m_[3], m_[5]);
+        tmat2<T> minor4(m_[0], m_[2], m_[6], m_[8]);
+        tmat2<T> minor5(m_[3], m_[5], m_[0], m_[2]);
+        tmat2<T> minor6(m_[3], m_[4], m_[6], m_[7]);
+        tmat2<T> minor7(m_[6], m_[7], m_[0], m_[1]);
+        tmat2<T> minor8(m_[0], m_[1], m_[3], m_[4]);
+        m_[0] = minor0.determinant() / d;
+        m_[1] = minor1.determinant() / d;
+        m_[2] = minor2.determinant() / d;
+        m_[3] = minor3.determinant() / d;
+        m_[4] = minor4.determinant() / d;
+        m_[5] = minor5.determinant() / d;
+        m_[6] = minor6.determinant() / d;
+        m_[7] = minor7.determinant() / d;
+        m_[8] = minor8.determinant() / d;
+        return *this;
+    }
+
     T m_[9];
 };
 
 // Multiply a scalar and a matrix just like the member operator, but allow
 // the scalar to be the left-hand operand.
 template<typename T>
-const tmat3<T> operator*(const T& lhs, const tmat3<T>& rhs)
+LIBMATRIX_CONSTEXPR const tmat3<T> operator*(const T& lhs, const tmat3<T>& rhs)
 {
     return tmat3<T>(rhs) * lhs;
 }
@@ -640,7 +789,7 @@ const tmat3<T> operator*(const T& lhs, const tmat3<T>& rhs)
 // Multiply a copy of a vector and a matrix (matrix is right-hand operand).
 // Return the copy.
 template<typename T>
-const tvec3<T> operator*(const tvec3<T>& lhs, const tmat3<T>& rhs)
+LIBMATRIX_CONSTEXPR const tvec3<T> operator*(const tvec3<T>& lhs, const tmat3<T>& rhs)
 {
     T x((lhs.x() * rhs[0][0]) + (lhs.y() * rhs[1][0]) + (lhs.z() * rhs[2][0]));
     T y((lhs.x() * rhs[0][1]) + (lhs.y() * rhs[1][1]) + (lhs.z() * rhs[2][1]));
@@ -651,7 +800,7 @@ const tvec3<T> operator*(const tvec3<T>& lhs, const tmat3<T>& rhs)
 // Multiply a copy of a vector and a matrix (matrix is left-hand operand).
 // Return the copy.
 template<typename T>
-const tvec3<T> operator*(const tmat3<T>& lhs, const tvec3<T>& rhs)
+LIBMATRIX_CONSTEXPR const tvec3<T> operator*(const tmat3<T>& lhs, const tvec3<T>& rhs)
 {
     T x((lhs[0][0] * rhs.x()) + (lhs[0][1] * rhs.y()) + (lhs[0][2] * rhs.z()));
     T y((lhs[1][0] * rhs.x()) + (lhs[1][1] * rhs.y()) + (lhs[1][2] * rhs.z()));
@@ -663,7 +812,7 @@ const tvec3<T> operator*(const tmat3<T>& lhs, const tvec3<T>& rhs)
 template<typename T>
 const tmat3<T> outer(const tvec3<T>& a, const tvec3<T>& b)
 {
-    tmat3<T> product;
+    tmat3<T> product(uninitialized);
     product[0][0] = a.x() * b.x();
     product[0][1] = a.x() * b.y();
     product[0][2] = a.x() * b.z();
@@ -676,6 +825,16 @@ const tmat3<T> outer(const tvec3<T>& a, const tvec3<T>& b)
     return product;
 }
 
+// Modes for tmat4::inverse().
+enum InverseMode
+{
+    // Always use the general 4x4 inverse.
+    InverseGeneral,
+    // Check whether the matrix is affine and, if so, use the cheaper affine
+    // inverse; otherwise fall back to the general one.
+    InverseCheckAffine
+};
+
 // A template class for creating, managing and operating on a 4x4 matrix
 // of any type you like (intended for built-in types, but as long as it 
 // supports the basic arithmetic and assignment operators, any type should
@@ -684,33 +843,46 @@ template<typename T>
 class tmat4
 {
 public:
-    tmat4()
+    LIBMATRIX_CONSTEXPR tmat4() :
+        m_()
     {
         setIdentity();
     }
-    tmat4(const tmat4& m)
-    {
-        m_[0] = m.m_[0];
-        m_[1] = m.m_[1];
-        m_[2] = m.m_[2];
-        m_[3] = m.m_[3];
-        m_[4] = m.m_[4];
-        m_[5] = m.m_[5];
-        m_[6] = m.m_[6];
-        m_[7] = m.m_[7];
-        m_[8] = m.m_[8];
-        m_[9] = m.m_[9];
-        m_[10] = m.m_[10];
-        m_[11] = m.m_[11];
-        m_[12] = m.m_[12];
-        m_[13] = m.m_[13];
-        m_[14] = m.m_[14];
-        m_[15] = m.m_[15];
-    }
-    ~tmat4() {}
+    explicit tmat4(Uninitialized) {}
+    LIBMATRIX_CONSTEXPR tmat4(const T& c0r0, const T& c0r1, const T& c0r2, const T& c0r3,
+          const T& c1r0, const T& c1r1, const T& c1r2, const T& c1r3,
+          const T& c2r0, const T& c2r1, const T& c2r2, const T& c2r3,
+          const T& c3r0, const T& c3r1, const T& c3r2, const T& c3r3)
+#if __cplusplus >= 201103L
+        : m_{c0r0, c0r1, c0r2, c0r3,
+            c1r0, c1r1, c1r2, c1r3,
+            c2r0, c2r1, c2r2, c2r3,
+            c3r0, c3r1, c3r2, c3r3}
+    {
+    }
+#else
+    {
+        m_[0] = c0r0;
+        m_[1] = c0r1;
+        m_[2] = c0r2;
+        m_[3] = c0r3;
+        m_[4] = c1r0;
+        m_[5] = c1r1;
+        m_[6] = c1r2;
+        m_[7] = c1r3;
+        m_[8] = c2r0;
+        m_[9] = c2r1;
+        m_[10] = c2r2;
+        m_[11] = c2r3;
+        m_[12] = c3r0;
+        m_[13] = c3r1;
+        m_[14] = c3r2;
+        m_[15] = c3r3;
+    }
+#endif
 
     // Reset this to the identity matrix.
-    void setIdentity()
+    LIBMATRIX_CONSTEXPR void setIdentity()
     {
         m_[0] = 1;
         m_[1] = 0;
@@ -731,7 +903,7 @@ public:
     }
 
     // Transpose this.  Return a reference to this.
-    tmat4& transpose()
+    LIBMATRIX_CONSTEXPR tmat4& transpose()
     {
         T tmp_val = m_[1];
         m_[1] = m_[4];
@@ -755,64 +927,130 @@ public:
     }
 
     // Compute the determinant of this and return it.
-    T determinant()
+    T determinant() const
     {
-        tmat3<T> minor0(m_[5], m_[6], m_[7], m_[9], m_[10], m_[11], m_[13], m_[14], m_[15]);
-        tmat3<T> minor4(m_[1], m_[2], m_[3], m_[9], m_[10], m_[11], m_[13], m_[14], m_[15]);
-        tmat3<T> minor8(m_[1], m_[2], m_[3], m_[5], m_[6], m_[7], m_[13], m_[14], m_[15]);
-        tmat3<T> minor12(m_[1], m_[2], m_[3], m_[5], m_[6], m_[7], m_[9], m_[10], m_[11]);
-        return (m_[0] * minor0.determinant()) -
-               (m_[4] * minor4.determinant()) +
-               (m_[8] * minor8.determinant()) -
-               (m_[12] * minor12.determinant());
+        return Mat4Kernel<T>::determinant(m_);
     }
 
     // Invert this.  Return a reference to this.
     //
+    // The cofactors are computed by Mat4Kernel (see simd.h), which shares
+    // the 2x2 sub-determinants between them rather than building a 3x3
+    // minor for each.
+    //
     // NOTE: If this is non-invertible, we will
     //       throw to avoid undefined behavior.
-    tmat4& inverse() throw(std::runtime_error)
+    tmat4& inverse()
     {
-        T d(determinant());
+        if (!Mat4Kernel<T>::inverse(m_, m_, static_cast<T>(0)))
+        {
+            throw std::runtime_error("Matrix is noninvertible!!!!");
+        }
+        return *this;
+    }
+
+    // Compute the inverse of this into 'out' without throwing.  Return true
+    // on success.  If the magnitude of the determinant is not greater than
+    // 'epsilon', return false and leave 'out' untouched, so near-singular
+    // matrices can be rejected along with singular ones.
+    bool tryInverse(T epsilon, tmat4& out) const
+    {
+        return Mat4Kernel<T>::inverse(out.m_, m_, epsilon);
+    }
+
+    // Invert this using the method selected by 'mode' (see InverseMode).
+    // Return a reference to this.
+    //
+    // NOTE: If this is non-invertible, we will
+    //       throw to avoid undefined behavior.
+    tmat4& inverse(InverseMode mode)
+    {
+        if (mode == InverseCheckAffine && isAffine())
+        {
+            return inverseAffine();
+        }
+        return inverse();
+    }
+
+    // Test whether this is affine, i.e. whether its bottom row is
+    // (0, 0, 0, 1).  This is true of everything built from Mat4::translate,
+    // Mat4::rotate, Mat4::scale and Mat4::lookAt.
+    bool isAffine() const
+    {
+        return m_[3] == static_cast<T>(0) &&
+               m_[7] == static_cast<T>(0) &&
+               m_[11] == static_cast<T>(0) &&
+               m_[15] == static_cast<T>(1);
+    }
+
+    // Invert this, assuming that it is affine (see isAffine()).  Only the
+    // upper 3x3 is inverted, and the translation is transformed by the
+    // result.  Return a reference to this.
+    //
+    // NOTE: If the upper 3x3 is non-invertible, we will
+    //       throw to avoid undefined behavior.
+    tmat4& inverseAffine()
+    {
+        // The rows of the inverse of the upper 3x3 are the cross products
+        // of pairs of its columns, divided by the determinant.
+        T inv[9];
+        inv[0] = (m_[5] * m_[10]) - (m_[6] * m_[9]);
+        inv[1] = (m_[6] * m_[8]) - (m_[4] * m_[10]);
+        inv[2] = (m_[4] * m_[9]) - (m_[5] * m_[8]);
+        inv[3] = (m_[9] * m_[2]) - (m_[10] * m_[1]);
+        inv[4] = (m_[10] * m_[0]) - (m_[8] * m_[2]);
+        inv[5] = (m_[8] * m_[1]) - (m_[9] * m_[0]);
+        inv[6] = (m_[1] * m_[6]) - (m_[2] * m_[5]);
+        inv[7] = (m_[2] * m_[4]) - (m_[0] * m_[6]);
+        inv[8] = (m_[0] * m_[5]) - (m_[1] * m_[4]);
+        T d((m_[0] * inv[0]) + (m_[1] * inv[1]) + (m_[2] * inv[2]));
         if (d == static_cast<T>(0))
         {
             throw std::runtime_error("Matrix is noninvertible!!!!");
         }
-        tmat3<T> minor0(m_[5], m_[6], m_[7], m_[9], m_[10], m_[11], m_[13], m_[14], m_[15]);
-        tmat3<T> minor1(m_[1], m_[2], m_[3], m_[13], m_[14], m_[15], m_[9], m_[10], m_[11]);
-        tmat3<T> minor2(m_[1], m_[2], m_[3], m_[5], m_[6], m_[7], m_[13], m_[14], m_[15]);
-        tmat3<T> minor3(m_[1], m_[2], m_[3], m_[9], m_[10], m_[11], m_[5], m_[6], m_[7]);
-
-        tmat3<T> minor4(m_[4], m_[6], m_[7], m_[12], m_[14], m_[15], m_[8], m_[10], m_[11]);
-        tmat3<T> minor5(m_[0], m_[2], m_[3], m_[8], m_[10], m_[11], m_[12], m_[14], m_[15]);
-        tmat3<T> minor6(m_[0], m_[2], m_[3], m_[12], m_[14], m_[15], m_[4], m_[6], m_[7]);
-        tmat3<T> minor7(m_[0], m_[2], m_[3], m_[4], m_[6], m_[7], m_[8], m_[10], m_[11]);
-
-        tmat3<T> minor8(m_[4], m_[5], m_[7], m_[8], m_[9], m_[11], m_[12], m_[13], m_[15]);
-        tmat3<T> minor9(m_[0], m_[1], m_[3], m_[12], m_[13], m_[15], m_[8], m_[9], m_[11]);
-        tmat3<T> minor10(m_[0], m_[1], m_[3], m_[4], m_[5], m_[7], m_[12], m_[13], m_[15]);
-        tmat3<T> minor11(m_[0], m_[1], m_[3], m_[8], m_[9], m_[11], m_[4], m_[5], m_[7]);
-
-        tmat3<T> minor12(m_[4], m_[5], m_[6], m_[12], m_[13], m_[14], m_[8], m_[9], m_[10]);
-        tmat3<T> minor13(m_[0], m_[1], m_[2], m_[8], m_[9], m_[10], m_[12], m_[13], m_[14]);
-        tmat3<T> minor14(m_[0], m_[1], m_[2], m_[12], m_[13], m_[14], m_[4], m_[5], m_[6]);
-        tmat3<T> minor15(m_[0], m_[1], m_[2], m_[4], m_[5], m_[6], m_[8], m_[9], m_[10]);
-        m_[0] = minor0.determinant() / d;
-        m_[1] = minor1.determinant() / d;
-        m_[2] = minor2.determinant() / d;
-        m_[3] = minor3.determinant() / d;
-        m_[4] = minor4.determinant() / d;
-        m_[5] = minor5.determinant() / d;
-        m_[6] = minor6.determinant() / d;
-        m_[7] = minor7.determinant() / d;
-        m_[8] = minor8.determinant() / d;
-        m_[9] = minor9.determinant() / d;
-        m_[10] = minor10.determinant() / d;
-        m_[11] = minor11.determinant() / d;
-        m_[12] = minor12.determinant() / d;
-        m_[13] = minor13.determinant() / d;
-        m_[14] = minor14.determinant() / d;
-        m_[15] = minor15.determinant() / d;
+        scaleByInverse(inv, inv, 9, d);
+        T tx(m_[12]);
+        T ty(m_[13]);
+        T tz(m_[14]);
+        m_[0] = inv[0];
+        m_[1] = inv[3];
+        m_[2] = inv[6];
+        m_[4] = inv[1];
+        m_[5] = inv[4];
+        m_[6] = inv[7];
+        m_[8] = inv[2];
+        m_[9] = inv[5];
+        m_[10] = inv[8];
+        m_[12] = -((inv[0] * tx) + (inv[1] * ty) + (inv[2] * tz));
+        m_[13] = -((inv[3] * tx) + (inv[4] * ty) + (inv[5] * tz));
+        m_[14] = -((inv[6] * tx) + (inv[7] * ty) + (inv[8] * tz));
+        return *this;
+    }
+
+    // Invert this, assuming that it is a rigid-body transform (an affine
+    // matrix whose upper 3x3 is a pure rotation, such as a product of
+    // Mat4::translate and Mat4::rotate).  The upper 3x3 is transposed, and
+    // the translation is rotated back by it.  Return a reference to this.
+    //
+    // NOTE: No check is made that this really is rigid; if it is not, the
+    //       result is not its inverse.
+    tmat4& inverseRigid()
+    {
+        T tx(m_[12]);
+        T ty(m_[13]);
+        T tz(m_[14]);
+        m_[12] = -((m_[0] * tx) + (m_[1] * ty) + (m_[2] * tz));
+        m_[13] = -((m_[4] * tx) + (m_[5] * ty) + (m_[6] * tz));
+        m_[14] = -((m_[8] * tx) + (m_[9] * ty) + (m_[10] * tz));
+        T tmp_val = m_[1];
+        m_[1] = m_[4];
+        m_[4] = tmp_val;
+        tmp_val = m_[2];
+        m_[2] = m_[8];
+        m_[8] = tmp_val;
+        tmp_val = m_[6];
+        m_[6] = m_[9];
+        m_[9] = tmp_val;
         return *this;
     }
 
@@ -866,10 +1104,14 @@ public:
     // Allow raw data access for API calls and the like.
     // For example, it is valid to pass a tmat4<float> into a call to
     // the OpenGL command "glUniformMatrix4fv()".
-    operator const T*() const { return &m_[0];}
+    LIBMATRIX_CONSTEXPR operator const T*() const { return &m_[0];}
+
+    // Allow writable raw access to the (column-major) elements, for the
+    // batch kernels and the like.
+    T* data() { return &m_[0]; }
 
     // Test if 'rhs' is equal to this.
-    bool operator==(const tmat4& rhs) const
+    LIBMATRIX_CONSTEXPR bool operator==(const tmat4& rhs) const
     {
         return m_[0] == rhs.m_[0] &&
                m_[1] == rhs.m_[1] &&
@@ -890,38 +1132,13 @@ public:
     }
 
     // Test if 'rhs' is not equal to this.
-    bool operator!=(const tmat4& rhs) const
+    LIBMATRIX_CONSTEXPR bool operator!=(const tmat4& rhs) const
     {
         return !(*this == rhs);
     }
 
-    // A direct assignment of 'rhs' to this.  Return a reference to this.
-    tmat4& operator=(const tmat4& rhs)
-    {
-        if (this != &rhs)
-        {
-            m_[0] = rhs.m_[0];
-            m_[1] = rhs.m_[1];
-            m_[2] = rhs.m_[2];
-            m_[3] = rhs.m_[3];
-            m_[4] = rhs.m_[4];
-            m_[5] = rhs.m_[5];
-            m_[6] = rhs.m_[6];
-            m_[7] = rhs.m_[7];
-            m_[8] = rhs.m_[8];
-            m_[9] = rhs.m_[9];
-            m_[10] = rhs.m_[10];
-            m_[11] = rhs.m_[11];
-            m_[12] = rhs.m_[12];
-            m_[13] = rhs.m_[13];
-            m_[14] = rhs.m_[14];
-            m_[15] = rhs.m_[15];
-        }
-        return *this;
-    }
-
     // Add another matrix to this.  Return a reference to this.
-    tmat4& operator+=(const tmat4& rhs)
+    LIBMATRIX_CONSTEXPR tmat4& operator+=(const tmat4& rhs)
     {
         m_[0] += rhs.m_[0];
         m_[1] += rhs.m_[1];
@@ -943,13 +1160,13 @@ public:
     }
 
     // Add another matrix to a copy of this.  Return the copy.
-    const tmat4 operator+(const tmat4& rhs)
+    LIBMATRIX_CONSTEXPR const tmat4 operator+(const tmat4& rhs) const
     {
         return tmat4(*this) += rhs;
     }
 
     // Subtract another matrix from this.  Return a reference to this.
-    tmat4& operator-=(const tmat4& rhs)
+    LIBMATRIX_CONSTEXPR tmat4& operator-=(const tmat4& rhs)
     {
         m_[0] -= rhs.m_[0];
         m_[1] -= rhs.m_[1];
@@ -971,57 +1188,44 @@ public:
     }
 
     // Subtract another matrix from a copy of this.  Return the copy.
-    const tmat4 operator-(const tmat4& rhs)
+    LIBMATRIX_CONSTEXPR const tmat4 operator-(const tmat4& rhs) const
     {
         return tmat4(*this) -= rhs;
     }
 
     // Multiply this by another matrix.  Return a reference to this.
-    tmat4& operator*=(const tmat4& rhs)
-    {
-        T c0r0((m_[0] * rhs.m_[0]) + (m_[4] * rhs.m_[1]) + (m_[8] * rhs.m_[2]) + (m_[12] * rhs.m_[3]));
-        T c0r1((m_[1] * rhs.m_[0]) + (m_[5] * rhs.m_[1]) + (m_[9] * rhs.m_[2]) + (m_[13] * rhs.m_[3]));
-        T c0r2((m_[2] * rhs.m_[0]) + (m_[6] * rhs.m_[1]) + (m_[10] * rhs.m_[2]) + (m_[14] * rhs.m_[3]));
-        T c0r3((m_[3] * rhs.m_[0]) + (m_[7] * rhs.m_[1]) + (m_[11] * rhs.m_[2]) + (m_[15] * rhs.m_[3]));
-        T c1r0((m_[0] * rhs.m_[4]) + (m_[4] * rhs.m_[5]) + (m_[8] * rhs.m_[6]) + (m_[12] * rhs.m_[7]));
-        T c1r1((m_[1] * rhs.m_[4]) + (m_[5] * rhs.m_[5]) + (m_[9] * rhs.m_[6]) + (m_[13] * rhs.m_[7]));
-        T c1r2((m_[2] * rhs.m_[4]) + (m_[6] * rhs.m_[5]) + (m_[10] * rhs.m_[6]) + (m_[14] * rhs.m_[7]));
-        T c1r3((m_[3] * rhs.m_[4]) + (m_[7] * rhs.m_[5]) + (m_[11] * rhs.m_[6]) + (m_[15] * rhs.m_[7]));
-        T c2r0((m_[0] * rhs.m_[8]) + (m_[4] * rhs.m_[9]) + (m_[8] * rhs.m_[10]) + (m_[12] * rhs.m_[11]));
-        T c2r1((m_[1] * rhs.m_[8]) + (m_[5] * rhs.m_[9]) + (m_[9] * rhs.m_[10]) + (m_[13] * rhs.m_[11]));
-        T c2r2((m_[2] * rhs.m_[8]) + (m_[6] * rhs.m_[9]) + (m_[10] * rhs.m_[10]) + (m_[14] * rhs.m_[11]));
-        T c2r3((m_[3] * rhs.m_[8]) + (m_[7] * rhs.m_[9]) + (m_[11] * rhs.m_[10]) + (m_[15] * rhs.m_[11]));
-        T c3r0((m_[0] * rhs.m_[12]) + (m_[4] * rhs.m_[13]) + (m_[8] * rhs.m_[14]) + (m_[12] * rhs.m_[15]));
-        T c3r1((m_[1] * rhs.m_[12]) + (m_[5] * rhs.m_[13]) + (m_[9] * rhs.m_[14]) + (m_[13] * rhs.m_[15]));
-        T c3r2((m_[2] * rhs.m_[12]) + (m_[6] * rhs.m_[13]) + (m_[10] * rhs.m_[14]) + (m_[14] * rhs.m_[15]));
-        T c3r3((m_[3] * rhs.m_[12]) + (m_[7] * rhs.m_[13]) + (m_[11] * rhs.m_[14]) + (m_[15] * rhs.m_[15]));
-        m_[0] = c0r0;
-        m_[1] = c0r1;
-        m_[2] = c0r2;
-        m_[3] = c0r3;
-        m_[4] = c1r0;
-        m_[5] = c1r1;
-        m_[6] = c1r2;
-        m_[7] = c1r3;
-        m_[8] = c2r0;
-        m_[9] = c2r1;
-        m_[10] = c2r2;
-        m_[11] = c2r3;
-        m_[12] = c3r0;
-        m_[13] = c3r1;
-        m_[14] = c3r2;
-        m_[15] = c3r3;
+    //
+    // The work is done by Mat4Kernel (see simd.h), which uses vector
+    // instructions for the element types that have them.
+    LIBMATRIX_CONSTEXPR_MULTIPLY tmat4& operator*=(const tmat4& rhs)
+    {
+#if defined(LIBMATRIX_HAVE_CONSTANT_EVALUATED)
+        if (__builtin_is_constant_evaluated())
+        {
+            return multiplyScalar(rhs);
+        }
+#endif
+        Mat4Kernel<T>::multiply(m_, m_, rhs.m_);
         return *this;
     }
 
-    // Multiply a copy of this by another matrix.  Return the copy.
-    const tmat4 operator*(const tmat4& rhs)
+    // Multiply this by another matrix.  Return the product, which is written
+    // straight into a new matrix rather than into a copy of this.
+    LIBMATRIX_CONSTEXPR_MULTIPLY const tmat4 operator*(const tmat4& rhs) const
     {
-        return tmat4(*this) *= rhs;
+#if defined(LIBMATRIX_HAVE_CONSTANT_EVALUATED)
+        if (__builtin_is_constant_evaluated())
+        {
+            return tmat4(*this).multiplyScalar(rhs);
+        }
+#endif
+        tmat4 product(uninitialized);
+        Mat4Kernel<T>::multiply(product.m_, m_, rhs.m_);
+        return product;
     }
 
     // Multiply this by a scalar.  Return a reference to this.
-    tmat4& operator*=(const T& rhs)
+    LIBMATRIX_CONSTEXPR tmat4& operator*=(const T& rhs)
     {
         m_[0] *= rhs;
         m_[1] *= rhs;
@@ -1043,13 +1247,13 @@ public:
     }
 
     // Multiply a copy of this by a scalar.  Return the copy.
-    const tmat4 operator*(const T& rhs)
+    LIBMATRIX_CONSTEXPR const tmat4 operator*(const T& rhs) const
     {
         return tmat4(*this) *= rhs;
     }
 
     // Divide this by a scalar.  Return a reference to this.
-    tmat4& operator/=(const T& rhs)
+    LIBMATRIX_CONSTEXPR tmat4& operator/=(const T& rhs)
     {
         m_[0] /= rhs;
         m_[1] /= rhs;
@@ -1071,7 +1275,7 @@ public:
     }
 
     // Divide a copy of this by a scalar.  Return the copy.
-    const tmat4 operator/(const T& rhs)
+    LIBMATRIX_CONSTEXPR const tmat4 operator/(const T& rhs) const
     {
         return tmat4(*this) /= rhs;
     }
@@ -1079,23 +1283,95 @@ public:
     // Use an instance of the ArrayProxy class to support double-indexed
     // references to a matrix (i.e., m[1][1]).  See comments above the
     // ArrayProxy definition for more details.
-    ArrayProxy<T, 4> operator[](int index)
+    LIBMATRIX_CONSTEXPR ArrayProxy<T, 4> operator[](int index)
     {
         return ArrayProxy<T, 4>(&m_[index]);
     }
-    const ArrayProxy<T, 4> operator[](int index) const
+    LIBMATRIX_CONSTEXPR const ArrayProxy<T, 4> operator[](int index) const
     {
         return ArrayProxy<T, 4>(const_cast<T*>(&m_[index]));
     }
 
+    // Direct access to the element at 'row', 'col', without the
+    // ArrayProxy.  m(row, col) is the same element as m[row][col].
+    LIBMATRIX_CONSTEXPR T& operator()(unsigned int row, unsigned int col)
+    {
+        return m_[col * 4 + row];
+    }
+    LIBMATRIX_CONSTEXPR const T& operator()(unsigned int row, unsigned int col) const
+    {
+        return m_[col * 4 + row];
+    }
+
+    // The same, with the indices fixed (and checked) at compile time.
+    template<unsigned int Row, unsigned int Col>
+    LIBMATRIX_CONSTEXPR T& at()
+    {
+        (void) sizeof(CompileTimeCheck<(Row < 4 && Col < 4)>);
+        return m_[Col * 4 + Row];
+    }
+    template<unsigned int Row, unsigned int Col>
+    LIBMATRIX_CONSTEXPR const T& at() const
+    {
+        (void) sizeof(CompileTimeCheck<(Row < 4 && Col < 4)>);
+        return m_[Col * 4 + Row];
+    }
+
+    // Get and set whole columns and rows as vectors.
+    LIBMATRIX_CONSTEXPR const tvec4<T> column(unsigned int col) const
+    {
+        const T* c(&m_[col * 4]);
+        return tvec4<T>(c[0], c[1], c[2], c[3]);
+    }
+    LIBMATRIX_CONSTEXPR const tvec4<T> row(unsigned int row) const
+    {
+        return tvec4<T>(m_[row], m_[4 + row], m_[8 + row], m_[12 + row]);
+    }
+    LIBMATRIX_CONSTEXPR void setColumn(unsigned int col, const tvec4<T>& v)
+    {
+        m_[col * 4 + 0] = v.x();
+        m_[col * 4 + 1] = v.y();
+        m_[col * 4 + 2] = v.z();
+        m_[col * 4 + 3] = v.w();
+    }
+    LIBMATRIX_CONSTEXPR void setRow(unsigned int row, const tvec4<T>& v)
+    {
+        m_[row] = v.x();
+        m_[4 + row] = v.y();
+        m_[8 + row] = v.z();
+        m_[12 + row] = v.w();
+    }
+
 private:
+#if defined(LIBMATRIX_HAVE_CONSTANT_EVALUATED)
+    // The same sums as the generic Mat4Kernel<T>::multiply(), for constant
+    // expressions.
+    constexpr tmat4& multiplyScalar(const tmat4& rhs)
+    {
+        T product[16] = {};
+        for (unsigned int c = 0; c < 16; c += 4)
+        {
+            for (unsigned int r = 0; r < 4; r++)
+            {
+                product[c + r] = (m_[r] * rhs.m_[c]) + (m_[r + 4] * rhs.m_[c + 1]) +
+                                 (m_[r + 8] * rhs.m_[c + 2]) + (m_[r + 12] * rhs.m_[c + 3]);
+            }
+        }
+        for (unsigned int i = 0; i < 16; i++)
+        {
+            m_[i] = product[i];
+        }
+        return *this;
+    }
+#endif
+
     T m_[16];
 };
 
 // Multiply a scalar and a matrix just like the member operator, but allow
 // the scalar to be the left-hand operand.
 template<typename T>
-const tmat4<T> operator*(const T& lhs, const tmat4<T>& rhs)
+LIBMATRIX_CONSTEXPR const tmat4<T> operator*(const T& lhs, const tmat4<T>& rhs)
 {
     return tmat4<T>(rhs) * lhs;
 }
@@ -1103,7 +1379,7 @@ const tmat4<T> operator*(const T& lhs, const tmat4<T>& rhs)
 // Multiply a copy of a vector and a matrix (matrix is right-hand operand).
 // Return the copy.
 template<typename T>
-const tvec4<T> operator*(const tvec4<T>& lhs, const tmat4<T>& rhs)
+LIBMATRIX_CONSTEXPR const tvec4<T> operator*(const tvec4<T>& lhs, const tmat4<T>& rhs)
 {
     T x((lhs.x() * rhs[0][0]) + (lhs.y() * rhs[1][0]) + (lhs.z() * rhs[2][0]) + (lhs.w() * rhs[3][0]));
     T y((lhs.x() * rhs[0][1]) + (lhs.y() * rhs[1][1]) + (lhs.z() * rhs[2][1]) + (lhs.w() * rhs[3][1]));
@@ -1115,7 +1391,7 @@ const tvec4<T> operator*(const tvec4<T>& lhs, const tmat4<T>& rhs)
 // Multiply a copy of a vector and a matrix (matrix is left-hand operand).
 // Return the copy.
 template<typename T>
-const tvec4<T> operator*(const tmat4<T>& lhs, const tvec4<T>& rhs)
+LIBMATRIX_CONSTEXPR const tvec4<T> operator*(const tmat4<T>& lhs, const tvec4<T>& rhs)
 {
     T x((lhs[0][0] * rhs.x()) + (lhs[0][1] * rhs.y()) + (lhs[0][2] * rhs.z()) + (lhs[0][3] * rhs.w()));
     T y((lhs[1][0] * rhs.x()) + (lhs[1][1] * rhs.y()) + (lhs[1][2] * rhs.z()) + (lhs[1][3] * rhs.w()));
@@ -1128,7 +1404,7 @@ const tvec4<T> operator*(const tmat4<T>& lhs, const tvec4<T>& rhs)
 template<typename T>
 const tmat4<T> outer(const tvec4<T>& a, const tvec4<T>& b)
 {
-    tmat4<T> product;
+    tmat4<T> product(uninitialized);
     product[0][0] = a.x() * b.x();
     product[0][1] = a.x() * b.y();
     product[0][2] = a.x() * b.z();
@@ -1179,14 +1455,81 @@ namespace Mat4
 // Some functions to generate transformation matrices that used to be provided
 // by OpenGL.
 //
-mat4 translate(float x, float y, float z);
-mat4 scale(float x, float y, float z);
+// The ones that need no trigonometry are defined here, so that they can be
+// used in constant expressions (see LIBMATRIX_CONSTEXPR in vec.h).  All of
+// them build their result column by column, in storage order.
+//
+inline LIBMATRIX_CONSTEXPR mat4
+translate(float x, float y, float z)
+{
+    return mat4(1, 0, 0, 0,
+                0, 1, 0, 0,
+                0, 0, 1, 0,
+                x, y, z, 1);
+}
+
+inline LIBMATRIX_CONSTEXPR mat4
+scale(float x, float y, float z)
+{
+    return mat4(x, 0, 0, 0,
+                0, y, 0, 0,
+                0, 0, z, 0,
+                0, 0, 0, 1);
+}
+
+inline LIBMATRIX_CONSTEXPR mat4
+frustum(float left, float right, float bottom, float top, float near, float far)
+{
+    float twiceNear(2 * near);
+    float width(right - left);
+    float height(top - bottom);
+    float depth(far - near);
+    return mat4(twiceNear / width, 0, 0, 0,
+                0, twiceNear / height, 0, 0,
+                (right + left) / width, (top + bottom) / height, -(far + near) / depth, -1,
+                0, 0, -(twiceNear * far) / depth, 0);
+}
+
+inline LIBMATRIX_CONSTEXPR mat4
+ortho(float left, float right, float bottom, float top, float near, float far)
+{
+    float width(right - left);
+    float height(top - bottom);
+    float depth(far - near);
+    return mat4(2 / width, 0, 0, 0,
+                0, 2 / height, 0, 0,
+                0, 0, -2 / depth, 0,
+                (right + left) / width, (top + bottom) / height, (far + near) / depth, 1);
+}
+
 mat4 rotate(float angle, float x, float y, float z);
-mat4 frustum(float left, float right, float bottom, float top, float near, float far);
-mat4 ortho(float left, float right, float bottom, float top, float near, float far);
 mat4 perspective(float fovy, float aspect, float zNear, float zFar);
+// The same, using the single precision approximations in fastmath.h for
+// the sine, cosine, tangent and normalization.  Built with
+// LIBMATRIX_FAST_MATH, the versions above are these.
+mat4 rotate(float angle, float x, float y, float z, Fast);
+mat4 perspective(float fovy, float aspect, float zNear, float zFar, Fast);
 mat4 lookAt(float eyeX, float eyeY, float eyeZ, float centerX, float centerY, float centerZ, float upX, float upY, float upZ);
 
+//
+// Build translate(translation) * rotation * scale(scale) directly, without
+// any matrix products.  The rotation is either a 3x3 matrix or an angle (in
+// degrees) and axis, as for rotate().
+//
+mat4 compose(const vec3& translation, const mat3& rotation, const vec3& scale);
+mat4 compose(const vec3& translation, float angle, const vec3& axis, const vec3& scale);
+
 } // namespace Mat4
 } // namespace LibMatrix
+
+#if __cplusplus >= 201103L
+static_assert(std::is_trivially_copyable<LibMatrix::mat2>::value &&
+              std::is_trivially_copyable<LibMatrix::mat3>::value &&
+              std::is_trivially_copyable<LibMatrix::mat4>::value &&
+              std::is_trivially_copyable<LibMatrix::dmat4>::value,
+              "matrices must be trivially copyable");
+static_assert(std::is_trivially_destructible<LibMatrix::mat4>::value,
+              "matrices must be trivially destructible");
+#endif
+
 #endif // MAT_H_
@@ -23,6 +23,7 @@ using LibMatrix::mat3;
 using LibMatrix::vec2;
 using LibMatrix::vec3;
 using LibMatrix::vec4;
+using LibMatrix::dualquat;
 
 Shader::Shader(unsigned int type, const string& source) :
     handle_(0),
@@ -336,6 +337,37 @@ Program::Symbol::operator=(const int& i)
     return *this;
 }
 
+Program::Symbol&
+Program::Symbol::operator=(const dualquat& dq)
+{
+    if (type_ == Uniform)
+    {
+        glUniform4fv(location_, 2, dq);
+    }
+    return *this;
+}
+
+Program::Symbol&
+Program::Symbol::set(const mat4* m, unsigned int count)
+{
+    if (type_ == Uniform && count)
+    {
+        // The matrices are contiguous and column-major, as for a single one.
+        glUniformMatrix4fv(location_, count, GL_FALSE, m[0]);
+    }
+    return *this;
+}
+
+Program::Symbol&
+Program::Symbol::set(const dualquat* dq, unsigned int count)
+{
+    if (type_ == Uniform && count)
+    {
+        glUniform4fv(location_, 2 * count, dq[0]);
+    }
+    return *this;
+}
+
 Program::Symbol&
 Program::operator[](const std::string& name)
 {
@@ -16,6 +16,7 @@
 #include <vector>
 #include <map>
 #include "mat.h"
+#include "quat.h"
 
 // Simple shader container.  Abstracts all of the OpenGL bits, but leaves
 // much of the semantics intact.  This is typically only referenced directly
@@ -132,6 +133,13 @@ public:
         Symbol& operator=(const LibMatrix::vec4& v);
         Symbol& operator=(const float& f);
         Symbol& operator=(const int& i);
+        // A dual quaternion goes to a vec4[2] uniform (real, then dual).
+        Symbol& operator=(const LibMatrix::dualquat& dq);
+        // Load 'count' consecutive elements of an array uniform (mat4[] or,
+        // for dual quaternions, vec4[] with two elements each) in one call,
+        // e.g. a bone palette from the Batch functions.
+        Symbol& set(const LibMatrix::mat4* m, unsigned int count);
+        Symbol& set(const LibMatrix::dualquat* dq, unsigned int count);
 private:
         Symbol();
         SymbolType type_;
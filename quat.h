@@ -0,0 +1,653 @@
+//
+// Copyright (c) 2013 Linaro Limited
+//
+// All rights reserved. This program and the accompanying materials
+// are made available under the terms of the MIT License which accompanies
+// this distribution, and is available at
+// http://www.opensource.org/licenses/mit-license.php
+//
+// Contributors:
+//     Jesse Barker - original implementation.
+//
+#ifndef QUAT_H_
+#define QUAT_H_
+
+#include <iostream> // only needed for print() functions...
+#include <math.h>
+#include "vec.h"
+#include "mat.h"
+
+namespace LibMatrix
+{
+//
+// A template class for rotations represented as quaternions, stored as the
+// vector part (x, y, z) followed by the scalar part w.  As with the
+// matrices, the product a * b rotates by b first and then by a.  The
+// rotation members and conversions assume a unit quaternion; composing many
+// of them accumulates rounding error, so renormalize now and then.
+//
+template<typename T>
+class tquat
+{
+public:
+    // The identity rotation.
+    LIBMATRIX_CONSTEXPR tquat() :
+        x_(0),
+        y_(0),
+        z_(0),
+        w_(1) {}
+    LIBMATRIX_CONSTEXPR tquat(const T x, const T y, const T z, const T w) :
+        x_(x),
+        y_(y),
+        z_(z),
+        w_(w) {}
+    // A rotation of 'angle' degrees about 'axis', which need not be unit
+    // length; the same rotation as Mat4::rotate().
+    tquat(const T angle, const tvec3<T>& axis)
+    {
+        T halfAngle(angle * M_PI / 360.0);
+        T s(sin(halfAngle) / axis.length());
+        x_ = axis.x() * s;
+        y_ = axis.y() * s;
+        z_ = axis.z() * s;
+        w_ = cos(halfAngle);
+    }
+    // The rotation of a pure rotation matrix (or the upper 3x3 of a rigid
+    // transform).  This picks the largest of the four components to
+    // recover first, so it stays accurate for rotations near 180 degrees.
+    explicit tquat(const tmat3<T>& m)
+    {
+        fromRotation(m(0, 0), m(0, 1), m(0, 2),
+                     m(1, 0), m(1, 1), m(1, 2),
+                     m(2, 0), m(2, 1), m(2, 2));
+    }
+    explicit tquat(const tmat4<T>& m)
+    {
+        fromRotation(m(0, 0), m(0, 1), m(0, 2),
+                     m(1, 0), m(1, 1), m(1, 2),
+                     m(2, 0), m(2, 1), m(2, 2));
+    }
+
+    // Print the elements of the quaternion to standard out.
+    // Really only useful for debug and test.
+    void print() const
+    {
+        std::cout << "| " << x_ << " " << y_ << " " << z_ << " " << w_ << " |" << std::endl;
+    }
+
+    // Allow raw data access for API calls and the like (x, y, z, w order,
+    // so a tquat<float> can go straight to "glUniform4fv()").
+    LIBMATRIX_CONSTEXPR operator const T*() const { return &x_;}
+
+    // Allow writable raw access to the elements, for the batch kernels
+    // and the like.
+    T* data() { return &x_; }
+
+    // Get and set access members for the individual elements.
+    LIBMATRIX_CONSTEXPR const T x() const { return x_; }
+    LIBMATRIX_CONSTEXPR const T y() const { return y_; }
+    LIBMATRIX_CONSTEXPR const T z() const { return z_; }
+    LIBMATRIX_CONSTEXPR const T w() const { return w_; }
+
+    LIBMATRIX_CONSTEXPR void x(const T& val) { x_ = val; }
+    LIBMATRIX_CONSTEXPR void y(const T& val) { y_ = val; }
+    LIBMATRIX_CONSTEXPR void z(const T& val) { z_ = val; }
+    LIBMATRIX_CONSTEXPR void w(const T& val) { w_ = val; }
+
+    // Multiply this by a scalar.  Return a reference to this.
+    LIBMATRIX_CONSTEXPR tquat& operator*=(const T& rhs)
+    {
+        x_ *= rhs;
+        y_ *= rhs;
+        z_ *= rhs;
+        w_ *= rhs;
+        return *this;
+    }
+
+    // Multiply a copy of this by a scalar.  Return the copy.
+    LIBMATRIX_CONSTEXPR const tquat operator*(const T& rhs) const
+    {
+        return tquat(*this) *= rhs;
+    }
+
+    // Component-wise addition of another quaternion to this (as for
+    // blending).  Return a reference to this.
+    LIBMATRIX_CONSTEXPR tquat& operator+=(const tquat& rhs)
+    {
+        x_ += rhs.x_;
+        y_ += rhs.y_;
+        z_ += rhs.z_;
+        w_ += rhs.w_;
+        return *this;
+    }
+
+    // Component-wise addition of another quaternion to a copy of this.
+    // Return the copy.
+    LIBMATRIX_CONSTEXPR const tquat operator+(const tquat& rhs) const
+    {
+        return tquat(*this) += rhs;
+    }
+
+    // Post-multiply this by another quaternion, i.e. rotate by rhs before
+    // this.  Return a reference to this.
+    LIBMATRIX_CONSTEXPR tquat& operator*=(const tquat& rhs)
+    {
+        return *this = *this * rhs;
+    }
+
+    // Multiply this by another quaternion.  Return the product.
+    LIBMATRIX_CONSTEXPR const tquat operator*(const tquat& rhs) const
+    {
+        return tquat(w_ * rhs.x_ + x_ * rhs.w_ + y_ * rhs.z_ - z_ * rhs.y_,
+                     w_ * rhs.y_ - x_ * rhs.z_ + y_ * rhs.w_ + z_ * rhs.x_,
+                     w_ * rhs.z_ + x_ * rhs.y_ - y_ * rhs.x_ + z_ * rhs.w_,
+                     w_ * rhs.w_ - x_ * rhs.x_ - y_ * rhs.y_ - z_ * rhs.z_);
+    }
+
+    // Rotate a vector by this.  This is cheaper than building the matrix
+    // for a single vector; for many, use toMat3() or the batch transforms.
+    LIBMATRIX_CONSTEXPR const tvec3<T> operator*(const tvec3<T>& v) const
+    {
+        // v + 2w(u x v) + 2u x (u x v), where u is the vector part.
+        const tvec3<T> u(x_, y_, z_);
+        const tvec3<T> t(tvec3<T>::cross(u, v) * T(2));
+        return v + t * w_ + tvec3<T>::cross(u, t);
+    }
+
+    // The inverse of a unit quaternion.
+    LIBMATRIX_CONSTEXPR const tquat conjugate() const
+    {
+        return tquat(-x_, -y_, -z_, w_);
+    }
+
+    // The inverse of any non-zero quaternion.
+    LIBMATRIX_CONSTEXPR const tquat inverse() const
+    {
+        T n(dot(*this, *this));
+        return tquat(-x_ / n, -y_ / n, -z_ / n, w_ / n);
+    }
+
+    // Compute the length of this and return it.
+    T length() const
+    {
+        return sqrt(dot(*this, *this));
+    }
+
+    // Make this a unit quaternion.
+    void normalize()
+    {
+        T l = length();
+        x_ /= l;
+        y_ /= l;
+        z_ /= l;
+        w_ /= l;
+    }
+
+    // Compute the dot product of two quaternions (the cosine of half the
+    // angle between two unit quaternions).
+    LIBMATRIX_CONSTEXPR static T dot(const tquat& q1, const tquat& q2)
+    {
+        return (q1.x_ * q2.x_) + (q1.y_ * q2.y_) + (q1.z_ * q2.z_) + (q1.w_ * q2.w_);
+    }
+
+    // The rotation matrix for this.
+    const tmat3<T> toMat3() const
+    {
+        tmat3<T> m(uninitialized);
+        writeRotation(m.data(), 3);
+        return m;
+    }
+
+    // The rotation matrix for this, as a 4x4 transform.
+    const tmat4<T> toMat4() const
+    {
+        tmat4<T> m(uninitialized);
+        T* d(m.data());
+        writeRotation(d, 4);
+        d[3] = d[7] = d[11] = 0;
+        d[12] = d[13] = d[14] = 0;
+        d[15] = 1;
+        return m;
+    }
+
+    // Write the rotation matrix for this into the upper 3x3 of column-major
+    // storage whose columns are 'stride' elements apart (3 for a tmat3, 4
+    // for a tmat4).  The batch conversions use this to write straight into
+    // the output array; going through a returned temporary costs several
+    // times as much, as the compiler stores it element by element and then
+    // reloads it to copy it.
+    void writeRotation(T* r, unsigned int stride) const
+    {
+        T x2(x_ + x_);
+        T y2(y_ + y_);
+        T z2(z_ + z_);
+        T xx(x_ * x2);
+        T yy(y_ * y2);
+        T zz(z_ * z2);
+        T xy(x_ * y2);
+        T xz(x_ * z2);
+        T yz(y_ * z2);
+        T wx(w_ * x2);
+        T wy(w_ * y2);
+        T wz(w_ * z2);
+        r[0] = 1 - (yy + zz);
+        r[1] = xy + wz;
+        r[2] = xz - wy;
+        r[stride] = xy - wz;
+        r[stride + 1] = 1 - (xx + zz);
+        r[stride + 2] = yz + wx;
+        r[2 * stride] = xz + wy;
+        r[2 * stride + 1] = yz - wx;
+        r[2 * stride + 2] = 1 - (xx + yy);
+    }
+
+private:
+    void fromRotation(T m00, T m01, T m02, T m10, T m11, T m12, T m20, T m21, T m22)
+    {
+        T trace(m00 + m11 + m22);
+        if (trace > 0)
+        {
+            T s(sqrt(trace + 1) * 2);
+            w_ = s / 4;
+            x_ = (m21 - m12) / s;
+            y_ = (m02 - m20) / s;
+            z_ = (m10 - m01) / s;
+        }
+        else if (m00 > m11 && m00 > m22)
+        {
+            T s(sqrt(1 + m00 - m11 - m22) * 2);
+            w_ = (m21 - m12) / s;
+            x_ = s / 4;
+            y_ = (m01 + m10) / s;
+            z_ = (m02 + m20) / s;
+        }
+        else if (m11 > m22)
+        {
+            T s(sqrt(1 + m11 - m00 - m22) * 2);
+            w_ = (m02 - m20) / s;
+            x_ = (m01 + m10) / s;
+            y_ = s / 4;
+            z_ = (m12 + m21) / s;
+        }
+        else
+        {
+            T s(sqrt(1 + m22 - m00 - m11) * 2);
+            w_ = (m10 - m01) / s;
+            x_ = (m02 + m20) / s;
+            y_ = (m12 + m21) / s;
+            z_ = s / 4;
+        }
+    }
+
+    T x_;
+    T y_;
+    T z_;
+    T w_;
+};
+
+typedef tquat<float> quat;
+typedef tquat<double> dquat;
+
+// Normalized linear interpolation from a (t = 0) to b (t = 1) along the
+// shorter arc.  It does not move at a constant angular rate, but is much
+// cheaper than slerp() and is close to it when a and b are near each other.
+template<typename T>
+const tquat<T>
+nlerp(const tquat<T>& a, const tquat<T>& b, const T t)
+{
+    T bt(tquat<T>::dot(a, b) < 0 ? -t : t);
+    T at(1 - t);
+    tquat<T> q(a.x() * at + b.x() * bt,
+               a.y() * at + b.y() * bt,
+               a.z() * at + b.z() * bt,
+               a.w() * at + b.w() * bt);
+    q.normalize();
+    return q;
+}
+
+// Spherical linear interpolation from a (t = 0) to b (t = 1) along the
+// shorter arc, at a constant angular rate.  Nearly equal rotations fall back
+// to nlerp(), where sin() of the angle between them is too small to divide
+// by.
+template<typename T>
+const tquat<T>
+slerp(const tquat<T>& a, const tquat<T>& b, const T t)
+{
+    T cosTheta(tquat<T>::dot(a, b));
+    T sign(1);
+    if (cosTheta < 0)
+    {
+        cosTheta = -cosTheta;
+        sign = -1;
+    }
+    if (cosTheta > T(0.9995))
+    {
+        return nlerp(a, b, t);
+    }
+    T theta(acos(cosTheta));
+    T sinTheta(sin(theta));
+    T at(sin((1 - t) * theta) / sinTheta);
+    T bt(sign * sin(t * theta) / sinTheta);
+    return tquat<T>(a.x() * at + b.x() * bt,
+                    a.y() * at + b.y() * bt,
+                    a.z() * at + b.z() * bt,
+                    a.w() * at + b.w() * bt);
+}
+
+//
+// A template class for rigid transforms (a rotation followed by a
+// translation) represented as dual quaternions: a unit quaternion 'real'
+// for the rotation and a quaternion 'dual' that is half the translation
+// times the rotation.  Unlike matrices, these can be blended linearly
+// without shearing or shrinking the result, which is what skinning needs.
+// The product a * b applies b first, as with the matrices.
+//
+// The eight elements are contiguous (real, then dual), so a tdualquat<float>
+// can be uploaded as a uniform vec4[2] (see Program::Symbol).
+//
+template<typename T>
+class tdualquat
+{
+public:
+    // The identity transform.
+    LIBMATRIX_CONSTEXPR tdualquat() :
+        real_(),
+        dual_(0, 0, 0, 0) {}
+    LIBMATRIX_CONSTEXPR tdualquat(const tquat<T>& real, const tquat<T>& dual) :
+        real_(real),
+        dual_(dual) {}
+    // Rotate by 'rotation' (which must be unit length), then translate.
+    LIBMATRIX_CONSTEXPR tdualquat(const tquat<T>& rotation, const tvec3<T>& translation) :
+        real_(rotation),
+        dual_(tquat<T>(translation.x(), translation.y(), translation.z(), 0) * rotation * T(0.5)) {}
+
+    // Print the elements of the dual quaternion to standard out.
+    // Really only useful for debug and test.
+    void print() const
+    {
+        real_.print();
+        dual_.print();
+    }
+
+    // Allow raw data access for API calls and the like.
+    LIBMATRIX_CONSTEXPR operator const T*() const { return real_; }
+
+    // Allow writable raw access to the elements, for the batch kernels
+    // and the like.
+    T* data() { return real_.data(); }
+
+    LIBMATRIX_CONSTEXPR const tquat<T>& real() const { return real_; }
+    LIBMATRIX_CONSTEXPR const tquat<T>& dual() const { return dual_; }
+
+    // Post-multiply this by another dual quaternion, i.e. apply rhs before
+    // this.  Return a reference to this.
+    LIBMATRIX_CONSTEXPR tdualquat& operator*=(const tdualquat& rhs)
+    {
+        return *this = *this * rhs;
+    }
+
+    // Multiply this by another dual quaternion.  Return the product.
+    LIBMATRIX_CONSTEXPR const tdualquat operator*(const tdualquat& rhs) const
+    {
+        return tdualquat(real_ * rhs.real_, real_ * rhs.dual_ + dual_ * rhs.real_);
+    }
+
+    // The inverse of a unit dual quaternion.
+    LIBMATRIX_CONSTEXPR const tdualquat conjugate() const
+    {
+        return tdualquat(real_.conjugate(), dual_.conjugate());
+    }
+
+    // Make this a unit dual quaternion: scale both parts so the rotation is
+    // unit length, then remove any part of the dual that is not orthogonal
+    // to it (which would otherwise show up as scale in toMat4()).
+    void normalize()
+    {
+        T s(1 / real_.length());
+        real_ *= s;
+        dual_ *= s;
+        dual_ += real_ * -tquat<T>::dot(real_, dual_);
+    }
+
+    // The rotation part of the transform.
+    LIBMATRIX_CONSTEXPR const tquat<T>& rotation() const { return real_; }
+
+    // The translation part of the transform, i.e. 2 * dual * conjugate(real).
+    LIBMATRIX_CONSTEXPR const tvec3<T> translation() const
+    {
+        const tvec3<T> rv(real_.x(), real_.y(), real_.z());
+        const tvec3<T> dv(dual_.x(), dual_.y(), dual_.z());
+        return (dv * real_.w() - rv * dual_.w() + tvec3<T>::cross(rv, dv)) * T(2);
+    }
+
+    // Transform a point by this.
+    LIBMATRIX_CONSTEXPR const tvec3<T> operator*(const tvec3<T>& p) const
+    {
+        return real_ * p + translation();
+    }
+
+    // The matrix for this.
+    const tmat4<T> toMat4() const
+    {
+        tmat4<T> m(uninitialized);
+        writeMatrix(m.data());
+        return m;
+    }
+
+    // Write the matrix for this into column-major storage for a tmat4 (see
+    // tquat::writeRotation()).
+    void writeMatrix(T* m) const
+    {
+        const tvec3<T> t(translation());
+        real_.writeRotation(m, 4);
+        m[3] = m[7] = m[11] = 0;
+        m[12] = t.x();
+        m[13] = t.y();
+        m[14] = t.z();
+        m[15] = 1;
+    }
+
+private:
+    tquat<T> real_;
+    tquat<T> dual_;
+};
+
+typedef tdualquat<float> dualquat;
+typedef tdualquat<double> ddualquat;
+
+namespace Mat4
+{
+
+// The rotation matrix for a unit quaternion; the same as q.toMat4().
+template<typename T>
+const tmat4<T>
+rotate(const tquat<T>& q)
+{
+    return q.toMat4();
+}
+
+} // namespace Mat4
+
+//
+// Operations on whole arrays of quaternions, in the manner of batch.h:
+// results go straight into a caller-provided array, which may be the same
+// as any of the inputs.  The loops are simple enough for the compiler to
+// vectorize.
+//
+namespace Batch
+{
+
+// Compute lhs[i] * rhs[i] into out[i] for 'count' pairs of quaternions.
+template<typename T>
+void
+multiply(tquat<T>* out, const tquat<T>* lhs, const tquat<T>* rhs, unsigned int count)
+{
+    for (unsigned int i = 0; i < count; i++)
+    {
+        out[i] = lhs[i] * rhs[i];
+    }
+}
+
+// Compute lhs * rhs[i] into out[i] for 'count' quaternions.
+template<typename T>
+void
+multiply(tquat<T>* out, const tquat<T>& lhs, const tquat<T>* rhs, unsigned int count)
+{
+    const tquat<T> l(lhs);
+    for (unsigned int i = 0; i < count; i++)
+    {
+        out[i] = l * rhs[i];
+    }
+}
+
+// Normalize 'count' quaternions from in[i] into out[i].
+template<typename T>
+void
+normalize(tquat<T>* out, const tquat<T>* in, unsigned int count)
+{
+    for (unsigned int i = 0; i < count; i++)
+    {
+        const tquat<T>& q(in[i]);
+        T s(1 / sqrt(tquat<T>::dot(q, q)));
+        out[i] = tquat<T>(q.x() * s, q.y() * s, q.z() * s, q.w() * s);
+    }
+}
+
+// Interpolate a[i] towards b[i] by 't' into out[i] for 'count' pairs, as
+// for nlerp() and slerp() (e.g. blending two animation poses).
+template<typename T>
+void
+nlerp(tquat<T>* out, const tquat<T>* a, const tquat<T>* b, const T t, unsigned int count)
+{
+    for (unsigned int i = 0; i < count; i++)
+    {
+        out[i] = LibMatrix::nlerp(a[i], b[i], t);
+    }
+}
+
+template<typename T>
+void
+slerp(tquat<T>* out, const tquat<T>* a, const tquat<T>* b, const T t, unsigned int count)
+{
+    for (unsigned int i = 0; i < count; i++)
+    {
+        out[i] = LibMatrix::slerp(a[i], b[i], t);
+    }
+}
+
+// Convert 'count' unit quaternions in[i] to rotation matrices out[i].
+template<typename T>
+void
+toMat4(tmat4<T>* out, const tquat<T>* in, unsigned int count)
+{
+    for (unsigned int i = 0; i < count; i++)
+    {
+        T* m(out[i].data());
+        in[i].writeRotation(m, 4);
+        m[3] = m[7] = m[11] = 0;
+        m[12] = m[13] = m[14] = 0;
+        m[15] = 1;
+    }
+}
+
+// Compute lhs[i] * rhs[i] into out[i] for 'count' pairs of dual
+// quaternions.
+template<typename T>
+void
+multiply(tdualquat<T>* out, const tdualquat<T>* lhs, const tdualquat<T>* rhs,
+         unsigned int count)
+{
+    for (unsigned int i = 0; i < count; i++)
+    {
+        out[i] = lhs[i] * rhs[i];
+    }
+}
+
+// Compute lhs * rhs[i] into out[i] for 'count' dual quaternions (e.g. a
+// parent transform applied to its children).
+template<typename T>
+void
+multiply(tdualquat<T>* out, const tdualquat<T>& lhs, const tdualquat<T>* rhs,
+         unsigned int count)
+{
+    const tdualquat<T> l(lhs);
+    for (unsigned int i = 0; i < count; i++)
+    {
+        out[i] = l * rhs[i];
+    }
+}
+
+//
+// Dual quaternion linear blending for skinning.  For each of 'count'
+// vertices (or vertex groups), blend 'influences' transforms from 'palette'
+// into out[i]: palette[bones[i * influences + k]] weighted by
+// weights[i * influences + k], for k from 0 to influences - 1.  The weights
+// are expected to sum to 1.  Transforms are flipped onto the same
+// hemisphere as the first one before they are added, so blends always take
+// the shorter path, and the result is renormalized.  'out' must not
+// overlap 'palette'.
+//
+template<typename T>
+void
+blend(tdualquat<T>* out, const tdualquat<T>* palette, const unsigned int* bones,
+      const T* weights, unsigned int influences, unsigned int count)
+{
+    for (unsigned int i = 0; i < count; i++)
+    {
+        const unsigned int* b(bones + i * influences);
+        const T* w(weights + i * influences);
+        // Accumulate the eight elements directly, so the compiler can keep
+        // them in registers.
+        const T* pivot(palette[b[0]]);
+        T sum[8];
+        for (unsigned int j = 0; j < 8; j++)
+        {
+            sum[j] = pivot[j] * w[0];
+        }
+        for (unsigned int k = 1; k < influences; k++)
+        {
+            const T* dq(palette[b[k]]);
+            T d(pivot[0] * dq[0] + pivot[1] * dq[1] + pivot[2] * dq[2] + pivot[3] * dq[3]);
+            // Arithmetic rather than a branch, as the signs are
+            // unpredictable.
+            T wk(w[k] * (1 - 2 * T(d < 0)));
+            for (unsigned int j = 0; j < 8; j++)
+            {
+                sum[j] += dq[j] * wk;
+            }
+        }
+        T s(1 / sqrt(sum[0] * sum[0] + sum[1] * sum[1] + sum[2] * sum[2] + sum[3] * sum[3]));
+        T* o(out[i].data());
+        for (unsigned int j = 0; j < 8; j++)
+        {
+            o[j] = sum[j] * s;
+        }
+    }
+}
+
+// Convert 'count' unit dual quaternions in[i] to matrices out[i].  The
+// output is a plain array of tmat4, ready to upload as a uniform mat4[]
+// (see Program::Symbol::set()).
+template<typename T>
+void
+toMat4(tmat4<T>* out, const tdualquat<T>* in, unsigned int count)
+{
+    for (unsigned int i = 0; i < count; i++)
+    {
+        in[i].writeMatrix(out[i].data());
+    }
+}
+
+} // namespace Batch
+} // namespace LibMatrix
+
+#if __cplusplus >= 201103L
+static_assert(std::is_trivially_copyable<LibMatrix::quat>::value &&
+              std::is_trivially_copyable<LibMatrix::dquat>::value &&
+              std::is_trivially_copyable<LibMatrix::dualquat>::value,
+              "quaternions must be trivially copyable");
+static_assert(sizeof(LibMatrix::dualquat) == 8 * sizeof(float),
+              "dual quaternions must be uploadable as vec4[2]");
+#endif
+
+#endif // QUAT_H_
@@ -0,0 +1,1197 @@
+//
+// Copyright (c) 2013 Linaro Limited
+//
+// All rights reserved. This program and the accompanying materials
+// are made available under the terms of the MIT License which accompanies
+// this distribution, and is available at
+// http://www.opensource.org/licenses/mit-license.php
+//
+// Contributors:
+//     Jesse Barker - original implementation.
+//
+#ifndef SIMD_H_
+#define SIMD_H_
+
+// Compile-time selection of the vector instruction set used by the matrix
+// kernels.  Whatever the compiler has been told it may use is picked up from
+// its predefined macros (e.g. build with -mavx to get the AVX double
+// precision kernels on x86).  Defining LIBMATRIX_NO_SIMD forces the generic
+// scalar code everywhere.
+#ifndef LIBMATRIX_NO_SIMD
+#if defined(__SSE__) || defined(_M_X64)
+#define LIBMATRIX_HAVE_SSE 1
+#include <xmmintrin.h>
+#endif
+#if defined(__SSE2__) || defined(_M_X64)
+#define LIBMATRIX_HAVE_SSE2 1
+#include <emmintrin.h>
+#endif
+#if defined(__AVX__)
+#define LIBMATRIX_HAVE_AVX 1
+#include <immintrin.h>
+#endif
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define LIBMATRIX_HAVE_NEON 1
+#include <arm_neon.h>
+#endif
+#endif // LIBMATRIX_NO_SIMD
+#include <math.h>
+
+// Hint that the memory at 'addr' is about to be read.
+#if defined(__GNUC__)
+#define LIBMATRIX_PREFETCH(addr) __builtin_prefetch(addr)
+#else
+#define LIBMATRIX_PREFETCH(addr)
+#endif
+
+namespace LibMatrix
+{
+// Scale 'count' elements of 'in' by 1/d into 'out'.  The floating point
+// overloads multiply by a single reciprocal; the generic version divides
+// every element so that integer types keep their truncating behavior.
+template<typename T>
+inline void
+scaleByInverse(T* out, const T* in, unsigned int count, T d)
+{
+    for (unsigned int i = 0; i < count; i++)
+    {
+        out[i] = in[i] / d;
+    }
+}
+
+inline void
+scaleByInverse(float* out, const float* in, unsigned int count, float d)
+{
+    float r(1.0f / d);
+    for (unsigned int i = 0; i < count; i++)
+    {
+        out[i] = in[i] * r;
+    }
+}
+
+inline void
+scaleByInverse(double* out, const double* in, unsigned int count, double d)
+{
+    double r(1.0 / d);
+    for (unsigned int i = 0; i < count; i++)
+    {
+        out[i] = in[i] * r;
+    }
+}
+
+// Return the absolute value of 'v'.  Unlike std::abs(), this covers every
+// element type the matrix templates are used with.
+template<typename T>
+inline T
+magnitude(const T& v)
+{
+    return (v < static_cast<T>(0)) ? -v : v;
+}
+
+// Kernels for 4x4 matrices operating directly on the column-major element
+// storage of tmat4.  The generic template works for any element type; the
+// specializations below replace it where a vector instruction set is
+// available for that type.
+template<typename T>
+struct Mat4Kernel
+{
+    // Compute lhs * rhs into out.  'out' may alias either operand.
+    static void multiply(T* out, const T* lhs, const T* rhs)
+    {
+        T c0r0((lhs[0] * rhs[0]) + (lhs[4] * rhs[1]) + (lhs[8] * rhs[2]) + (lhs[12] * rhs[3]));
+        T c0r1((lhs[1] * rhs[0]) + (lhs[5] * rhs[1]) + (lhs[9] * rhs[2]) + (lhs[13] * rhs[3]));
+        T c0r2((lhs[2] * rhs[0]) + (lhs[6] * rhs[1]) + (lhs[10] * rhs[2]) + (lhs[14] * rhs[3]));
+        T c0r3((lhs[3] * rhs[0]) + (lhs[7] * rhs[1]) + (lhs[11] * rhs[2]) + (lhs[15] * rhs[3]));
+        T c1r0((lhs[0] * rhs[4]) + (lhs[4] * rhs[5]) + (lhs[8] * rhs[6]) + (lhs[12] * rhs[7]));
+        T c1r1((lhs[1] * rhs[4]) + (lhs[5] * rhs[5]) + (lhs[9] * rhs[6]) + (lhs[13] * rhs[7]));
+        T c1r2((lhs[2] * rhs[4]) + (lhs[6] * rhs[5]) + (lhs[10] * rhs[6]) + (lhs[14] * rhs[7]));
+        T c1r3((lhs[3] * rhs[4]) + (lhs[7] * rhs[5]) + (lhs[11] * rhs[6]) + (lhs[15] * rhs[7]));
+        T c2r0((lhs[0] * rhs[8]) + (lhs[4] * rhs[9]) + (lhs[8] * rhs[10]) + (lhs[12] * rhs[11]));
+        T c2r1((lhs[1] * rhs[8]) + (lhs[5] * rhs[9]) + (lhs[9] * rhs[10]) + (lhs[13] * rhs[11]));
+        T c2r2((lhs[2] * rhs[8]) + (lhs[6] * rhs[9]) + (lhs[10] * rhs[10]) + (lhs[14] * rhs[11]));
+        T c2r3((lhs[3] * rhs[8]) + (lhs[7] * rhs[9]) + (lhs[11] * rhs[10]) + (lhs[15] * rhs[11]));
+        T c3r0((lhs[0] * rhs[12]) + (lhs[4] * rhs[13]) + (lhs[8] * rhs[14]) + (lhs[12] * rhs[15]));
+        T c3r1((lhs[1] * rhs[12]) + (lhs[5] * rhs[13]) + (lhs[9] * rhs[14]) + (lhs[13] * rhs[15]));
+        T c3r2((lhs[2] * rhs[12]) + (lhs[6] * rhs[13]) + (lhs[10] * rhs[14]) + (lhs[14] * rhs[15]));
+        T c3r3((lhs[3] * rhs[12]) + (lhs[7] * rhs[13]) + (lhs[11] * rhs[14]) + (lhs[15] * rhs[15]));
+        out[0] = c0r0;
+        out[1] = c0r1;
+        out[2] = c0r2;
+        out[3] = c0r3;
+        out[4] = c1r0;
+        out[5] = c1r1;
+        out[6] = c1r2;
+        out[7] = c1r3;
+        out[8] = c2r0;
+        out[9] = c2r1;
+        out[10] = c2r2;
+        out[11] = c2r3;
+        out[12] = c3r0;
+        out[13] = c3r1;
+        out[14] = c3r2;
+        out[15] = c3r3;
+    }
+
+    // The array kernels below work on 'count' consecutive matrices of 16
+    // elements each, and prefetch their inputs this many matrices ahead.
+    static const unsigned int prefetchDistance = 4;
+
+    // Prefetch every cache line of the matrix at 'm'.
+    static void prefetch(const T* m)
+    {
+        const char* bytes(reinterpret_cast<const char*>(m));
+        for (unsigned int offset = 0; offset < 16 * sizeof(T); offset += 64)
+        {
+            LIBMATRIX_PREFETCH(bytes + offset);
+        }
+    }
+
+    // Compute lhs[i] * rhs[i] into out[i].  'out' may alias either input.
+    static void multiplyArray(T* out, const T* lhs, const T* rhs, unsigned int count)
+    {
+        for (unsigned int i = 0; i < count; i++)
+        {
+            if (i + prefetchDistance < count)
+            {
+                prefetch(lhs + 16 * prefetchDistance);
+                prefetch(rhs + 16 * prefetchDistance);
+            }
+            multiply(out, lhs, rhs);
+            out += 16;
+            lhs += 16;
+            rhs += 16;
+        }
+    }
+
+    // Compute lhs * rhs[i] into out[i].  'out' may alias 'rhs', but not
+    // 'lhs'.
+    static void multiplyArrayLeft(T* out, const T* lhs, const T* rhs, unsigned int count)
+    {
+        for (unsigned int i = 0; i < count; i++)
+        {
+            if (i + prefetchDistance < count)
+            {
+                prefetch(rhs + 16 * prefetchDistance);
+            }
+            multiply(out, lhs, rhs);
+            out += 16;
+            rhs += 16;
+        }
+    }
+
+    // Compute lhs[i] * rhs into out[i].  'out' may alias 'lhs', but not
+    // 'rhs'.
+    static void multiplyArrayRight(T* out, const T* lhs, const T* rhs, unsigned int count)
+    {
+        for (unsigned int i = 0; i < count; i++)
+        {
+            if (i + prefetchDistance < count)
+            {
+                prefetch(lhs + 16 * prefetchDistance);
+            }
+            multiply(out, lhs, rhs);
+            out += 16;
+            lhs += 16;
+        }
+    }
+
+    // Transform the 'count' 4-component vectors at 'in' by 'm' into 'out'.
+    // If 'divide' is set, each result is divided through by its own w.
+    // 'out' may alias 'in'.
+    static void transformArray4(T* out, const T* m, const T* in, unsigned int count, bool divide)
+    {
+        for (unsigned int i = 0; i < count; i++)
+        {
+            T x((m[0] * in[0]) + (m[4] * in[1]) + (m[8] * in[2]) + (m[12] * in[3]));
+            T y((m[1] * in[0]) + (m[5] * in[1]) + (m[9] * in[2]) + (m[13] * in[3]));
+            T z((m[2] * in[0]) + (m[6] * in[1]) + (m[10] * in[2]) + (m[14] * in[3]));
+            T w((m[3] * in[0]) + (m[7] * in[1]) + (m[11] * in[2]) + (m[15] * in[3]));
+            if (divide)
+            {
+                x /= w;
+                y /= w;
+                z /= w;
+                w /= w;
+            }
+            out[0] = x;
+            out[1] = y;
+            out[2] = z;
+            out[3] = w;
+            out += 4;
+            in += 4;
+        }
+    }
+
+    // Transform the 'count' 3-component vectors at 'in' by 'm' into 'out',
+    // with 'w' standing in for the missing fourth component (1 for points,
+    // 0 for directions).  If 'divide' is set, each result is divided by the
+    // w it would have had.  'out' may alias 'in'.
+    static void transformArray3(T* out, const T* m, const T* in, unsigned int count, T w, bool divide)
+    {
+        T tx(m[12] * w);
+        T ty(m[13] * w);
+        T tz(m[14] * w);
+        T tw(m[15] * w);
+        for (unsigned int i = 0; i < count; i++)
+        {
+            T x((m[0] * in[0]) + (m[4] * in[1]) + (m[8] * in[2]) + tx);
+            T y((m[1] * in[0]) + (m[5] * in[1]) + (m[9] * in[2]) + ty);
+            T z((m[2] * in[0]) + (m[6] * in[1]) + (m[10] * in[2]) + tz);
+            if (divide)
+            {
+                T d((m[3] * in[0]) + (m[7] * in[1]) + (m[11] * in[2]) + tw);
+                x /= d;
+                y /= d;
+                z /= d;
+            }
+            out[0] = x;
+            out[1] = y;
+            out[2] = z;
+            out += 3;
+            in += 3;
+        }
+    }
+
+    // Compute the determinant of 'in' from its twelve 2x2 sub-determinants
+    // (the same ones inverse() shares between its cofactors).
+    static T determinant(const T* in)
+    {
+        T s0((in[0] * in[5]) - (in[4] * in[1]));
+        T s1((in[0] * in[6]) - (in[4] * in[2]));
+        T s2((in[0] * in[7]) - (in[4] * in[3]));
+        T s3((in[1] * in[6]) - (in[5] * in[2]));
+        T s4((in[1] * in[7]) - (in[5] * in[3]));
+        T s5((in[2] * in[7]) - (in[6] * in[3]));
+        T c0((in[8] * in[13]) - (in[12] * in[9]));
+        T c1((in[8] * in[14]) - (in[12] * in[10]));
+        T c2((in[8] * in[15]) - (in[12] * in[11]));
+        T c3((in[9] * in[14]) - (in[13] * in[10]));
+        T c4((in[9] * in[15]) - (in[13] * in[11]));
+        T c5((in[10] * in[15]) - (in[14] * in[11]));
+        return (s0 * c5) - (s1 * c4) + (s2 * c3) + (s3 * c2) - (s4 * c1) + (s5 * c0);
+    }
+
+    // Compute the inverse of 'in' into 'out'.  The 2x2 sub-determinants of
+    // the upper and lower halves are computed once and shared by all sixteen
+    // cofactors, and the adjugate is scaled by the determinant in one pass.
+    // If the magnitude of the determinant is not greater than 'epsilon',
+    // return false and leave 'out' untouched.  'out' may alias 'in'.
+    //
+    // The formulation is symmetric in rows and columns, so it does not
+    // matter that the storage is column-major.
+    static bool inverse(T* out, const T* in, T epsilon)
+    {
+        T s0((in[0] * in[5]) - (in[4] * in[1]));
+        T s1((in[0] * in[6]) - (in[4] * in[2]));
+        T s2((in[0] * in[7]) - (in[4] * in[3]));
+        T s3((in[1] * in[6]) - (in[5] * in[2]));
+        T s4((in[1] * in[7]) - (in[5] * in[3]));
+        T s5((in[2] * in[7]) - (in[6] * in[3]));
+        T c0((in[8] * in[13]) - (in[12] * in[9]));
+        T c1((in[8] * in[14]) - (in[12] * in[10]));
+        T c2((in[8] * in[15]) - (in[12] * in[11]));
+        T c3((in[9] * in[14]) - (in[13] * in[10]));
+        T c4((in[9] * in[15]) - (in[13] * in[11]));
+        T c5((in[10] * in[15]) - (in[14] * in[11]));
+        T d((s0 * c5) - (s1 * c4) + (s2 * c3) + (s3 * c2) - (s4 * c1) + (s5 * c0));
+        if (magnitude(d) <= epsilon)
+        {
+            return false;
+        }
+        T adj[16];
+        adj[0] = (in[5] * c5) - (in[6] * c4) + (in[7] * c3);
+        adj[1] = -(in[1] * c5) + (in[2] * c4) - (in[3] * c3);
+        adj[2] = (in[13] * s5) - (in[14] * s4) + (in[15] * s3);
+        adj[3] = -(in[9] * s5) + (in[10] * s4) - (in[11] * s3);
+        adj[4] = -(in[4] * c5) + (in[6] * c2) - (in[7] * c1);
+        adj[5] = (in[0] * c5) - (in[2] * c2) + (in[3] * c1);
+        adj[6] = -(in[12] * s5) + (in[14] * s2) - (in[15] * s1);
+        adj[7] = (in[8] * s5) - (in[10] * s2) + (in[11] * s1);
+        adj[8] = (in[4] * c4) - (in[5] * c2) + (in[7] * c0);
+        adj[9] = -(in[0] * c4) + (in[1] * c2) - (in[3] * c0);
+        adj[10] = (in[12] * s4) - (in[13] * s2) + (in[15] * s0);
+        adj[11] = -(in[8] * s4) + (in[9] * s2) - (in[11] * s0);
+        adj[12] = -(in[4] * c3) + (in[5] * c1) - (in[6] * c0);
+        adj[13] = (in[0] * c3) - (in[1] * c1) + (in[2] * c0);
+        adj[14] = -(in[12] * s3) + (in[13] * s1) - (in[14] * s0);
+        adj[15] = (in[8] * s3) - (in[9] * s1) + (in[10] * s0);
+        scaleByInverse(out, adj, 16, d);
+        return true;
+    }
+};
+
+//
+// The vector kernels all use the same column-broadcast scheme: each column
+// of the result is the sum of the columns of 'lhs', each scaled by one
+// element of the matching column of 'rhs'.  All of 'lhs' is loaded before
+// anything is stored, and each column of 'rhs' is read before the same
+// column of 'out' is written, so aliasing either operand is safe.
+//
+#if defined(LIBMATRIX_HAVE_SSE)
+// Return the sum of c0..c2 scaled by the three elements at 'v'.
+inline __m128
+sseTransform3(__m128 c0, __m128 c1, __m128 c2, const float* v)
+{
+    __m128 col = _mm_mul_ps(c0, _mm_set1_ps(v[0]));
+    col = _mm_add_ps(col, _mm_mul_ps(c1, _mm_set1_ps(v[1])));
+    return _mm_add_ps(col, _mm_mul_ps(c2, _mm_set1_ps(v[2])));
+}
+
+// Multiply the matrix whose columns are c0..c3 by 'rhs' into 'out'.
+inline void
+sseMultiply(float* out, __m128 c0, __m128 c1, __m128 c2, __m128 c3, const float* rhs)
+{
+    for (unsigned int i = 0; i < 16; i += 4)
+    {
+        __m128 col = sseTransform3(c0, c1, c2, rhs + i);
+        col = _mm_add_ps(col, _mm_mul_ps(c3, _mm_set1_ps(rhs[i + 3])));
+        _mm_storeu_ps(out + i, col);
+    }
+}
+
+template<>
+inline void
+Mat4Kernel<float>::multiply(float* out, const float* lhs, const float* rhs)
+{
+    sseMultiply(out, _mm_loadu_ps(lhs), _mm_loadu_ps(lhs + 4),
+                _mm_loadu_ps(lhs + 8), _mm_loadu_ps(lhs + 12), rhs);
+}
+
+// With a common left-hand operand, its columns stay in registers for the
+// whole array.
+template<>
+inline void
+Mat4Kernel<float>::multiplyArrayLeft(float* out, const float* lhs, const float* rhs, unsigned int count)
+{
+    __m128 c0 = _mm_loadu_ps(lhs);
+    __m128 c1 = _mm_loadu_ps(lhs + 4);
+    __m128 c2 = _mm_loadu_ps(lhs + 8);
+    __m128 c3 = _mm_loadu_ps(lhs + 12);
+    for (unsigned int i = 0; i < count; i++)
+    {
+        if (i + prefetchDistance < count)
+        {
+            prefetch(rhs + 16 * prefetchDistance);
+        }
+        sseMultiply(out, c0, c1, c2, c3, rhs);
+        out += 16;
+        rhs += 16;
+    }
+}
+
+template<>
+inline void
+Mat4Kernel<float>::transformArray4(float* out, const float* m, const float* in, unsigned int count, bool divide)
+{
+    __m128 c0 = _mm_loadu_ps(m);
+    __m128 c1 = _mm_loadu_ps(m + 4);
+    __m128 c2 = _mm_loadu_ps(m + 8);
+    __m128 c3 = _mm_loadu_ps(m + 12);
+    for (unsigned int i = 0; i < count; i++)
+    {
+        __m128 v = sseTransform3(c0, c1, c2, in);
+        v = _mm_add_ps(v, _mm_mul_ps(c3, _mm_set1_ps(in[3])));
+        if (divide)
+        {
+            v = _mm_div_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 3, 3, 3)));
+        }
+        _mm_storeu_ps(out, v);
+        out += 4;
+        in += 4;
+    }
+}
+
+// The translation column is scaled by 'w' once up front.  Only the first
+// three lanes of each result are stored.
+template<>
+inline void
+Mat4Kernel<float>::transformArray3(float* out, const float* m, const float* in, unsigned int count, float w, bool divide)
+{
+    __m128 c0 = _mm_loadu_ps(m);
+    __m128 c1 = _mm_loadu_ps(m + 4);
+    __m128 c2 = _mm_loadu_ps(m + 8);
+    __m128 t = _mm_mul_ps(_mm_loadu_ps(m + 12), _mm_set1_ps(w));
+    for (unsigned int i = 0; i < count; i++)
+    {
+        __m128 v = _mm_add_ps(sseTransform3(c0, c1, c2, in), t);
+        if (divide)
+        {
+            v = _mm_div_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 3, 3, 3)));
+        }
+        _mm_storel_pi(reinterpret_cast<__m64*>(out), v);
+        _mm_store_ss(out + 2, _mm_movehl_ps(v, v));
+        out += 3;
+        in += 3;
+    }
+}
+
+// Swizzle helpers for the SSE inverse.  _mm_shuffle_ps() needs its mask as
+// an immediate, so these have to be macros; they are undefined again below.
+#define LIBMATRIX_SHUFFLE(a, b, x, y, z, w) \
+    _mm_shuffle_ps((a), (b), (x) | ((y) << 2) | ((z) << 4) | ((w) << 6))
+#define LIBMATRIX_SWIZZLE(v, x, y, z, w) LIBMATRIX_SHUFFLE(v, v, x, y, z, w)
+
+// Helpers for the SSE inverse, working on 2x2 matrices packed into one
+// register as (c0r0, c0r1, c1r0, c1r1).
+//
+// Return a * b.
+inline __m128
+mat2Multiply(__m128 a, __m128 b)
+{
+    return _mm_add_ps(_mm_mul_ps(a, LIBMATRIX_SWIZZLE(b, 0, 3, 0, 3)),
+                      _mm_mul_ps(LIBMATRIX_SWIZZLE(a, 1, 0, 3, 2),
+                                 LIBMATRIX_SWIZZLE(b, 2, 1, 2, 1)));
+}
+
+// Return adj(a) * b.
+inline __m128
+mat2AdjMultiply(__m128 a, __m128 b)
+{
+    return _mm_sub_ps(_mm_mul_ps(LIBMATRIX_SWIZZLE(a, 3, 3, 0, 0), b),
+                      _mm_mul_ps(LIBMATRIX_SWIZZLE(a, 1, 1, 2, 2),
+                                 LIBMATRIX_SWIZZLE(b, 2, 3, 0, 1)));
+}
+
+// Return a * adj(b).
+inline __m128
+mat2MultiplyAdj(__m128 a, __m128 b)
+{
+    return _mm_sub_ps(_mm_mul_ps(a, LIBMATRIX_SWIZZLE(b, 3, 0, 3, 0)),
+                      _mm_mul_ps(LIBMATRIX_SWIZZLE(a, 1, 0, 3, 2),
+                                 LIBMATRIX_SWIZZLE(b, 2, 1, 2, 1)));
+}
+
+//
+// Block-wise inverse.  Splitting the matrix into 2x2 blocks
+//
+// | A  B |
+// | C  D |
+//
+// the inverse is (1/|M|) times the adjugates of
+//
+// X = |D|A - B(adj(D)C)    Y = |B|C - D(adj(A)B)
+// Z = |C|B - A(adj(D)C)    W = |A|D - C(adj(A)B)
+//
+// with |M| = |A||D| + |B||C| - tr(adj(A)B adj(D)C).  As with the generic
+// version, the rows-versus-columns orientation of the storage does not
+// matter.
+//
+template<>
+inline bool
+Mat4Kernel<float>::inverse(float* out, const float* in, float epsilon)
+{
+    __m128 c0 = _mm_loadu_ps(in);
+    __m128 c1 = _mm_loadu_ps(in + 4);
+    __m128 c2 = _mm_loadu_ps(in + 8);
+    __m128 c3 = _mm_loadu_ps(in + 12);
+
+    __m128 a = _mm_movelh_ps(c0, c1);
+    __m128 b = _mm_movehl_ps(c1, c0);
+    __m128 c = _mm_movelh_ps(c2, c3);
+    __m128 d = _mm_movehl_ps(c3, c2);
+
+    // (|A|, |B|, |C|, |D|)
+    __m128 detSub = _mm_sub_ps(
+        _mm_mul_ps(LIBMATRIX_SHUFFLE(c0, c2, 0, 2, 0, 2), LIBMATRIX_SHUFFLE(c1, c3, 1, 3, 1, 3)),
+        _mm_mul_ps(LIBMATRIX_SHUFFLE(c0, c2, 1, 3, 1, 3), LIBMATRIX_SHUFFLE(c1, c3, 0, 2, 0, 2)));
+    __m128 detA = LIBMATRIX_SWIZZLE(detSub, 0, 0, 0, 0);
+    __m128 detB = LIBMATRIX_SWIZZLE(detSub, 1, 1, 1, 1);
+    __m128 detC = LIBMATRIX_SWIZZLE(detSub, 2, 2, 2, 2);
+    __m128 detD = LIBMATRIX_SWIZZLE(detSub, 3, 3, 3, 3);
+
+    __m128 adjDC = mat2AdjMultiply(d, c);
+    __m128 adjAB = mat2AdjMultiply(a, b);
+    __m128 x = _mm_sub_ps(_mm_mul_ps(detD, a), mat2Multiply(b, adjDC));
+    __m128 w = _mm_sub_ps(_mm_mul_ps(detA, d), mat2Multiply(c, adjAB));
+    __m128 y = _mm_sub_ps(_mm_mul_ps(detB, c), mat2MultiplyAdj(d, adjAB));
+    __m128 z = _mm_sub_ps(_mm_mul_ps(detC, b), mat2MultiplyAdj(a, adjDC));
+
+    // Trace of adj(A)B * adj(D)C, summed across (and broadcast to) all lanes.
+    __m128 tr = _mm_mul_ps(adjAB, LIBMATRIX_SWIZZLE(adjDC, 0, 2, 1, 3));
+    tr = _mm_add_ps(tr, LIBMATRIX_SWIZZLE(tr, 1, 0, 3, 2));
+    tr = _mm_add_ps(tr, LIBMATRIX_SWIZZLE(tr, 2, 3, 0, 1));
+    __m128 detM = _mm_sub_ps(_mm_add_ps(_mm_mul_ps(detA, detD),
+                                        _mm_mul_ps(detB, detC)), tr);
+    if (magnitude(_mm_cvtss_f32(detM)) <= epsilon)
+    {
+        return false;
+    }
+
+    // One divide yields the scale, with the adjugate signs folded in.
+    __m128 scale = _mm_div_ps(_mm_setr_ps(1.0f, -1.0f, -1.0f, 1.0f), detM);
+    x = _mm_mul_ps(x, scale);
+    y = _mm_mul_ps(y, scale);
+    z = _mm_mul_ps(z, scale);
+    w = _mm_mul_ps(w, scale);
+
+    // Transposing the adjugate blocks is folded into the final shuffles.
+    _mm_storeu_ps(out, LIBMATRIX_SHUFFLE(x, y, 3, 1, 3, 1));
+    _mm_storeu_ps(out + 4, LIBMATRIX_SHUFFLE(x, y, 2, 0, 2, 0));
+    _mm_storeu_ps(out + 8, LIBMATRIX_SHUFFLE(z, w, 3, 1, 3, 1));
+    _mm_storeu_ps(out + 12, LIBMATRIX_SHUFFLE(z, w, 2, 0, 2, 0));
+    return true;
+}
+
+#undef LIBMATRIX_SWIZZLE
+#undef LIBMATRIX_SHUFFLE
+
+#elif defined(LIBMATRIX_HAVE_NEON)
+// Multiply the matrix whose columns are c0..c3 by 'rhs' into 'out'.
+inline void
+neonMultiply(float* out, float32x4_t c0, float32x4_t c1, float32x4_t c2, float32x4_t c3, const float* rhs)
+{
+    for (unsigned int i = 0; i < 16; i += 4)
+    {
+        float32x4_t col = vmulq_n_f32(c0, rhs[i]);
+        col = vmlaq_n_f32(col, c1, rhs[i + 1]);
+        col = vmlaq_n_f32(col, c2, rhs[i + 2]);
+        col = vmlaq_n_f32(col, c3, rhs[i + 3]);
+        vst1q_f32(out + i, col);
+    }
+}
+
+template<>
+inline void
+Mat4Kernel<float>::multiply(float* out, const float* lhs, const float* rhs)
+{
+    neonMultiply(out, vld1q_f32(lhs), vld1q_f32(lhs + 4),
+                 vld1q_f32(lhs + 8), vld1q_f32(lhs + 12), rhs);
+}
+
+// With a common left-hand operand, its columns stay in registers for the
+// whole array.
+template<>
+inline void
+Mat4Kernel<float>::multiplyArrayLeft(float* out, const float* lhs, const float* rhs, unsigned int count)
+{
+    float32x4_t c0 = vld1q_f32(lhs);
+    float32x4_t c1 = vld1q_f32(lhs + 4);
+    float32x4_t c2 = vld1q_f32(lhs + 8);
+    float32x4_t c3 = vld1q_f32(lhs + 12);
+    for (unsigned int i = 0; i < count; i++)
+    {
+        if (i + prefetchDistance < count)
+        {
+            prefetch(rhs + 16 * prefetchDistance);
+        }
+        neonMultiply(out, c0, c1, c2, c3, rhs);
+        out += 16;
+        rhs += 16;
+    }
+}
+
+template<>
+inline void
+Mat4Kernel<float>::transformArray4(float* out, const float* m, const float* in, unsigned int count, bool divide)
+{
+    float32x4_t c0 = vld1q_f32(m);
+    float32x4_t c1 = vld1q_f32(m + 4);
+    float32x4_t c2 = vld1q_f32(m + 8);
+    float32x4_t c3 = vld1q_f32(m + 12);
+    for (unsigned int i = 0; i < count; i++)
+    {
+        float32x4_t v = vmulq_n_f32(c0, in[0]);
+        v = vmlaq_n_f32(v, c1, in[1]);
+        v = vmlaq_n_f32(v, c2, in[2]);
+        v = vmlaq_n_f32(v, c3, in[3]);
+        vst1q_f32(out, v);
+        if (divide)
+        {
+            // 32-bit NEON has no vector divide.
+            float d(out[3]);
+            out[0] /= d;
+            out[1] /= d;
+            out[2] /= d;
+            out[3] /= d;
+        }
+        out += 4;
+        in += 4;
+    }
+}
+
+// The translation column is scaled by 'w' once up front.  Only the first
+// three lanes of each result are stored.
+template<>
+inline void
+Mat4Kernel<float>::transformArray3(float* out, const float* m, const float* in, unsigned int count, float w, bool divide)
+{
+    float32x4_t c0 = vld1q_f32(m);
+    float32x4_t c1 = vld1q_f32(m + 4);
+    float32x4_t c2 = vld1q_f32(m + 8);
+    float32x4_t t = vmulq_n_f32(vld1q_f32(m + 12), w);
+    for (unsigned int i = 0; i < count; i++)
+    {
+        float32x4_t v = vmulq_n_f32(c0, in[0]);
+        v = vmlaq_n_f32(v, c1, in[1]);
+        v = vmlaq_n_f32(v, c2, in[2]);
+        v = vaddq_f32(v, t);
+        float d(vgetq_lane_f32(v, 3));
+        vst1_f32(out, vget_low_f32(v));
+        vst1q_lane_f32(out + 2, v, 2);
+        if (divide)
+        {
+            out[0] /= d;
+            out[1] /= d;
+            out[2] /= d;
+        }
+        out += 3;
+        in += 3;
+    }
+}
+#endif
+
+#if defined(LIBMATRIX_HAVE_AVX)
+// Multiply the matrix whose columns are c0..c3 by 'rhs' into 'out'.
+inline void
+avxMultiply(double* out, __m256d c0, __m256d c1, __m256d c2, __m256d c3, const double* rhs)
+{
+    for (unsigned int i = 0; i < 16; i += 4)
+    {
+        __m256d col = _mm256_mul_pd(c0, _mm256_set1_pd(rhs[i]));
+        col = _mm256_add_pd(col, _mm256_mul_pd(c1, _mm256_set1_pd(rhs[i + 1])));
+        col = _mm256_add_pd(col, _mm256_mul_pd(c2, _mm256_set1_pd(rhs[i + 2])));
+        col = _mm256_add_pd(col, _mm256_mul_pd(c3, _mm256_set1_pd(rhs[i + 3])));
+        _mm256_storeu_pd(out + i, col);
+    }
+}
+
+template<>
+inline void
+Mat4Kernel<double>::multiply(double* out, const double* lhs, const double* rhs)
+{
+    avxMultiply(out, _mm256_loadu_pd(lhs), _mm256_loadu_pd(lhs + 4),
+                _mm256_loadu_pd(lhs + 8), _mm256_loadu_pd(lhs + 12), rhs);
+}
+
+// With a common left-hand operand, its columns stay in registers for the
+// whole array.
+template<>
+inline void
+Mat4Kernel<double>::multiplyArrayLeft(double* out, const double* lhs, const double* rhs, unsigned int count)
+{
+    __m256d c0 = _mm256_loadu_pd(lhs);
+    __m256d c1 = _mm256_loadu_pd(lhs + 4);
+    __m256d c2 = _mm256_loadu_pd(lhs + 8);
+    __m256d c3 = _mm256_loadu_pd(lhs + 12);
+    for (unsigned int i = 0; i < count; i++)
+    {
+        if (i + prefetchDistance < count)
+        {
+            prefetch(rhs + 16 * prefetchDistance);
+        }
+        avxMultiply(out, c0, c1, c2, c3, rhs);
+        out += 16;
+        rhs += 16;
+    }
+}
+
+// Broadcast the w lane of 'v' to all four lanes.
+inline __m256d
+avxSplatW(__m256d v)
+{
+    return _mm256_permute_pd(_mm256_permute2f128_pd(v, v, 0x11), 0xf);
+}
+
+template<>
+inline void
+Mat4Kernel<double>::transformArray4(double* out, const double* m, const double* in, unsigned int count, bool divide)
+{
+    __m256d c0 = _mm256_loadu_pd(m);
+    __m256d c1 = _mm256_loadu_pd(m + 4);
+    __m256d c2 = _mm256_loadu_pd(m + 8);
+    __m256d c3 = _mm256_loadu_pd(m + 12);
+    for (unsigned int i = 0; i < count; i++)
+    {
+        __m256d v = _mm256_mul_pd(c0, _mm256_set1_pd(in[0]));
+        v = _mm256_add_pd(v, _mm256_mul_pd(c1, _mm256_set1_pd(in[1])));
+        v = _mm256_add_pd(v, _mm256_mul_pd(c2, _mm256_set1_pd(in[2])));
+        v = _mm256_add_pd(v, _mm256_mul_pd(c3, _mm256_set1_pd(in[3])));
+        if (divide)
+        {
+            v = _mm256_div_pd(v, avxSplatW(v));
+        }
+        _mm256_storeu_pd(out, v);
+        out += 4;
+        in += 4;
+    }
+}
+
+// The translation column is scaled by 'w' once up front.  Only the first
+// three lanes of each result are stored.
+template<>
+inline void
+Mat4Kernel<double>::transformArray3(double* out, const double* m, const double* in, unsigned int count, double w, bool divide)
+{
+    __m256d c0 = _mm256_loadu_pd(m);
+    __m256d c1 = _mm256_loadu_pd(m + 4);
+    __m256d c2 = _mm256_loadu_pd(m + 8);
+    __m256d t = _mm256_mul_pd(_mm256_loadu_pd(m + 12), _mm256_set1_pd(w));
+    for (unsigned int i = 0; i < count; i++)
+    {
+        __m256d v = _mm256_mul_pd(c0, _mm256_set1_pd(in[0]));
+        v = _mm256_add_pd(v, _mm256_mul_pd(c1, _mm256_set1_pd(in[1])));
+        v = _mm256_add_pd(v, _mm256_mul_pd(c2, _mm256_set1_pd(in[2])));
+        v = _mm256_add_pd(v, t);
+        if (divide)
+        {
+            v = _mm256_div_pd(v, avxSplatW(v));
+        }
+        _mm_storeu_pd(out, _mm256_castpd256_pd128(v));
+        _mm_store_sd(out + 2, _mm256_extractf128_pd(v, 1));
+        out += 3;
+        in += 3;
+    }
+}
+#endif
+
+//
+// A minimal abstraction over a vector register holding 'width' values of T,
+// so that the structure-of-arrays kernels can be written once.  Loads and
+// stores must be aligned to the full register width unless the unaligned
+// versions are used.  ScalarLanes is the
+// generic single-lane version; Lanes<T> is the widest register available
+// for T.
+//
+template<typename T>
+struct ScalarLanes
+{
+    typedef T Type;
+    static const unsigned int width = 1;
+    static Type load(const T* p) { return *p; }
+    static void store(T* p, Type v) { *p = v; }
+    static Type loadUnaligned(const T* p) { return *p; }
+    static void storeUnaligned(T* p, Type v) { *p = v; }
+    static Type splat(T v) { return v; }
+    static Type add(Type a, Type b) { return a + b; }
+    static Type sub(Type a, Type b) { return a - b; }
+    static Type mul(Type a, Type b) { return a * b; }
+    static Type div(Type a, Type b) { return a / b; }
+    static Type sqrt(Type a) { return static_cast<T>(::sqrt(a)); }
+    static Type min(Type a, Type b) { return b < a ? b : a; }
+    // A bit per lane (lane 0 in bit 0) set where 'a' is less than zero.
+    static unsigned int negativeMask(Type a) { return a < 0 ? 1 : 0; }
+};
+
+template<typename T>
+struct Lanes : public ScalarLanes<T>
+{
+};
+
+#if defined(LIBMATRIX_HAVE_SSE)
+template<>
+struct Lanes<float>
+{
+    typedef __m128 Type;
+    static const unsigned int width = 4;
+    static Type load(const float* p) { return _mm_load_ps(p); }
+    static void store(float* p, Type v) { _mm_store_ps(p, v); }
+    static Type loadUnaligned(const float* p) { return _mm_loadu_ps(p); }
+    static void storeUnaligned(float* p, Type v) { _mm_storeu_ps(p, v); }
+    static Type splat(float v) { return _mm_set1_ps(v); }
+    static Type add(Type a, Type b) { return _mm_add_ps(a, b); }
+    static Type sub(Type a, Type b) { return _mm_sub_ps(a, b); }
+    static Type mul(Type a, Type b) { return _mm_mul_ps(a, b); }
+    static Type div(Type a, Type b) { return _mm_div_ps(a, b); }
+    static Type sqrt(Type a) { return _mm_sqrt_ps(a); }
+    static Type min(Type a, Type b) { return _mm_min_ps(a, b); }
+    static unsigned int negativeMask(Type a)
+    {
+        return _mm_movemask_ps(_mm_cmplt_ps(a, _mm_setzero_ps()));
+    }
+};
+#elif defined(LIBMATRIX_HAVE_NEON) && defined(__aarch64__)
+// 32-bit NEON has no vector divide or square root, so only AArch64 gets a
+// vector specialization.
+template<>
+struct Lanes<float>
+{
+    typedef float32x4_t Type;
+    static const unsigned int width = 4;
+    static Type load(const float* p) { return vld1q_f32(p); }
+    static void store(float* p, Type v) { vst1q_f32(p, v); }
+    static Type loadUnaligned(const float* p) { return vld1q_f32(p); }
+    static void storeUnaligned(float* p, Type v) { vst1q_f32(p, v); }
+    static Type splat(float v) { return vdupq_n_f32(v); }
+    static Type add(Type a, Type b) { return vaddq_f32(a, b); }
+    static Type sub(Type a, Type b) { return vsubq_f32(a, b); }
+    static Type mul(Type a, Type b) { return vmulq_f32(a, b); }
+    static Type div(Type a, Type b) { return vdivq_f32(a, b); }
+    static Type sqrt(Type a) { return vsqrtq_f32(a); }
+    static Type min(Type a, Type b) { return vminq_f32(a, b); }
+    static unsigned int negativeMask(Type a)
+    {
+        static const uint32_t bits[4] = { 1, 2, 4, 8 };
+        return vaddvq_u32(vandq_u32(vcltzq_f32(a), vld1q_u32(bits)));
+    }
+};
+#endif
+
+#if defined(LIBMATRIX_HAVE_AVX)
+template<>
+struct Lanes<double>
+{
+    typedef __m256d Type;
+    static const unsigned int width = 4;
+    static Type load(const double* p) { return _mm256_load_pd(p); }
+    static void store(double* p, Type v) { _mm256_store_pd(p, v); }
+    static Type loadUnaligned(const double* p) { return _mm256_loadu_pd(p); }
+    static void storeUnaligned(double* p, Type v) { _mm256_storeu_pd(p, v); }
+    static Type splat(double v) { return _mm256_set1_pd(v); }
+    static Type add(Type a, Type b) { return _mm256_add_pd(a, b); }
+    static Type sub(Type a, Type b) { return _mm256_sub_pd(a, b); }
+    static Type mul(Type a, Type b) { return _mm256_mul_pd(a, b); }
+    static Type div(Type a, Type b) { return _mm256_div_pd(a, b); }
+    static Type sqrt(Type a) { return _mm256_sqrt_pd(a); }
+    static Type min(Type a, Type b) { return _mm256_min_pd(a, b); }
+    static unsigned int negativeMask(Type a)
+    {
+        return _mm256_movemask_pd(_mm256_cmp_pd(a, _mm256_setzero_pd(), _CMP_LT_OQ));
+    }
+};
+#elif defined(LIBMATRIX_HAVE_SSE2)
+template<>
+struct Lanes<double>
+{
+    typedef __m128d Type;
+    static const unsigned int width = 2;
+    static Type load(const double* p) { return _mm_load_pd(p); }
+    static void store(double* p, Type v) { _mm_store_pd(p, v); }
+    static Type loadUnaligned(const double* p) { return _mm_loadu_pd(p); }
+    static void storeUnaligned(double* p, Type v) { _mm_storeu_pd(p, v); }
+    static Type splat(double v) { return _mm_set1_pd(v); }
+    static Type add(Type a, Type b) { return _mm_add_pd(a, b); }
+    static Type sub(Type a, Type b) { return _mm_sub_pd(a, b); }
+    static Type mul(Type a, Type b) { return _mm_mul_pd(a, b); }
+    static Type div(Type a, Type b) { return _mm_div_pd(a, b); }
+    static Type sqrt(Type a) { return _mm_sqrt_pd(a); }
+    static Type min(Type a, Type b) { return _mm_min_pd(a, b); }
+    static unsigned int negativeMask(Type a)
+    {
+        return _mm_movemask_pd(_mm_cmplt_pd(a, _mm_setzero_pd()));
+    }
+};
+#endif
+
+//
+// Kernels for arrays of N-element vectors (N is 3 or 4), operating directly
+// on the packed element storage of tvec3 and tvec4.  ScalarVecKernel is the
+// generic version, which works for any element type and computes exactly
+// what the member functions of the vector classes do; VecKernel<T, N> is
+// specialized below where a vector instruction set is available for T.
+// 'out' may be the same array as any input.
+//
+template<typename T, unsigned int N>
+struct ScalarVecKernel
+{
+    // Return the dot product of the vectors at 'a' and 'b'.
+    static T dot(const T* a, const T* b)
+    {
+        T d(a[0] * b[0]);
+        for (unsigned int j = 1; j < N; j++)
+        {
+            d += a[j] * b[j];
+        }
+        return d;
+    }
+
+    static void dotArray(T* out, const T* a, const T* b, unsigned int count)
+    {
+        for (unsigned int i = 0; i < count; i++, a += N, b += N)
+        {
+            out[i] = dot(a, b);
+        }
+    }
+
+    // The lengths are computed in (and written as) L.
+    template<typename L>
+    static void lengthArray(L* out, const T* in, unsigned int count)
+    {
+        for (unsigned int i = 0; i < count; i++, in += N)
+        {
+            out[i] = static_cast<L>(::sqrt(static_cast<L>(dot(in, in))));
+        }
+    }
+
+    // Each vector is copied first, so that the possibility of 'out' aliasing
+    // 'in' does not force the elements to be reloaded after every store.
+    static void normalizeArray(T* out, const T* in, unsigned int count)
+    {
+        for (unsigned int i = 0; i < count; i++, out += N, in += N)
+        {
+            T v[N];
+            for (unsigned int j = 0; j < N; j++)
+            {
+                v[j] = in[j];
+            }
+            T l(static_cast<T>(::sqrt(dot(v, v))));
+            for (unsigned int j = 0; j < N; j++)
+            {
+                out[j] = v[j] / l;
+            }
+        }
+    }
+
+    // Scale by the reciprocal square root of the squared length.  The
+    // vector specializations use the hardware estimate; this is precise.
+    static void normalizeArrayFast(T* out, const T* in, unsigned int count)
+    {
+        for (unsigned int i = 0; i < count; i++, out += N, in += N)
+        {
+            T v[N];
+            for (unsigned int j = 0; j < N; j++)
+            {
+                v[j] = in[j];
+            }
+            T r(static_cast<T>(1) / static_cast<T>(::sqrt(dot(v, v))));
+            for (unsigned int j = 0; j < N; j++)
+            {
+                out[j] = v[j] * r;
+            }
+        }
+    }
+
+    // Only for N == 3.
+    static void crossArray(T* out, const T* a, const T* b, unsigned int count)
+    {
+        for (unsigned int i = 0; i < count; i++, out += 3, a += 3, b += 3)
+        {
+            T x((a[1] * b[2]) - (a[2] * b[1]));
+            T y((a[2] * b[0]) - (a[0] * b[2]));
+            T z((a[0] * b[1]) - (a[1] * b[0]));
+            out[0] = x;
+            out[1] = y;
+            out[2] = z;
+        }
+    }
+};
+
+template<typename T, unsigned int N>
+struct VecKernel : public ScalarVecKernel<T, N>
+{
+};
+
+#if defined(LIBMATRIX_HAVE_SSE)
+//
+// The SSE kernels work on blocks of four vectors, transposed so that each
+// register holds one component of all four, and finish any remainder with
+// the scalar code.  Apart from the fast normalize, they perform the same
+// operations in the same order as the scalar code, so the results are the
+// same too.
+//
+
+// Transpose the four packed 3-element vectors at 'p' into x, y and z.
+inline void
+sseLoad3x4(const float* p, __m128& x, __m128& y, __m128& z)
+{
+    __m128 a(_mm_loadu_ps(p));      // x0 y0 z0 x1
+    __m128 b(_mm_loadu_ps(p + 4));  // y1 z1 x2 y2
+    __m128 c(_mm_loadu_ps(p + 8));  // z2 x3 y3 z3
+    x = _mm_shuffle_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(0, 0, 3, 0)),
+                       _mm_shuffle_ps(b, c, _MM_SHUFFLE(1, 1, 2, 2)), _MM_SHUFFLE(2, 0, 1, 0));
+    y = _mm_shuffle_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(0, 0, 0, 1)),
+                       _mm_shuffle_ps(b, c, _MM_SHUFFLE(2, 2, 3, 3)), _MM_SHUFFLE(2, 0, 2, 0));
+    z = _mm_shuffle_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(1, 1, 2, 2)),
+                       _mm_shuffle_ps(c, c, _MM_SHUFFLE(3, 3, 0, 0)), _MM_SHUFFLE(2, 0, 2, 0));
+}
+
+// The inverse of sseLoad3x4().
+inline void
+sseStore3x4(float* p, __m128 x, __m128 y, __m128 z)
+{
+    _mm_storeu_ps(p, _mm_shuffle_ps(_mm_shuffle_ps(x, y, _MM_SHUFFLE(0, 0, 1, 0)),
+                                    _mm_shuffle_ps(z, x, _MM_SHUFFLE(1, 1, 0, 0)),
+                                    _MM_SHUFFLE(2, 0, 2, 0)));
+    _mm_storeu_ps(p + 4, _mm_shuffle_ps(_mm_shuffle_ps(y, z, _MM_SHUFFLE(1, 1, 1, 1)),
+                                        _mm_shuffle_ps(x, y, _MM_SHUFFLE(2, 2, 2, 2)),
+                                        _MM_SHUFFLE(2, 0, 2, 0)));
+    _mm_storeu_ps(p + 8, _mm_shuffle_ps(_mm_shuffle_ps(z, x, _MM_SHUFFLE(3, 3, 2, 2)),
+                                        _mm_shuffle_ps(y, z, _MM_SHUFFLE(3, 3, 3, 3)),
+                                        _MM_SHUFFLE(2, 0, 2, 0)));
+}
+
+// Return 1/sqrt(d) from the hardware estimate and one Newton-Raphson step,
+// computed exactly as FastMath::rsqrt() does for a single float.
+inline __m128
+sseRsqrt(__m128 d)
+{
+    __m128 r(_mm_rsqrt_ps(d));
+    __m128 drr(_mm_mul_ps(_mm_mul_ps(_mm_mul_ps(_mm_set1_ps(0.5f), d), r), r));
+    return _mm_mul_ps(r, _mm_sub_ps(_mm_set1_ps(1.5f), drr));
+}
+
+template<>
+struct VecKernel<float, 3> : public ScalarVecKernel<float, 3>
+{
+    static void dotArray(float* out, const float* a, const float* b, unsigned int count)
+    {
+        unsigned int i = 0;
+        for (; i + 4 <= count; i += 4, a += 12, b += 12)
+        {
+            __m128 ax, ay, az, bx, by, bz;
+            sseLoad3x4(a, ax, ay, az);
+            sseLoad3x4(b, bx, by, bz);
+            __m128 d(_mm_add_ps(_mm_add_ps(_mm_mul_ps(ax, bx), _mm_mul_ps(ay, by)),
+                                _mm_mul_ps(az, bz)));
+            _mm_storeu_ps(out + i, d);
+        }
+        ScalarVecKernel<float, 3>::dotArray(out + i, a, b, count - i);
+    }
+
+    static void lengthArray(float* out, const float* in, unsigned int count)
+    {
+        unsigned int i = 0;
+        for (; i + 4 <= count; i += 4, in += 12)
+        {
+            _mm_storeu_ps(out + i, _mm_sqrt_ps(squaredLengths(in)));
+        }
+        ScalarVecKernel<float, 3>::lengthArray(out + i, in, count - i);
+    }
+
+    static void normalizeArray(float* out, const float* in, unsigned int count)
+    {
+        unsigned int i = 0;
+        for (; i + 4 <= count; i += 4, out += 12, in += 12)
+        {
+            __m128 x, y, z;
+            sseLoad3x4(in, x, y, z);
+            __m128 l(_mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)),
+                                            _mm_mul_ps(z, z))));
+            sseStore3x4(out, _mm_div_ps(x, l), _mm_div_ps(y, l), _mm_div_ps(z, l));
+        }
+        ScalarVecKernel<float, 3>::normalizeArray(out, in, count - i);
+    }
+
+    static void normalizeArrayFast(float* out, const float* in, unsigned int count)
+    {
+        unsigned int i = 0;
+        for (; i + 4 <= count; i += 4, out += 12, in += 12)
+        {
+            __m128 x, y, z;
+            sseLoad3x4(in, x, y, z);
+            __m128 r(sseRsqrt(_mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)),
+                                         _mm_mul_ps(z, z))));
+            sseStore3x4(out, _mm_mul_ps(x, r), _mm_mul_ps(y, r), _mm_mul_ps(z, r));
+        }
+        for (; i < count; i++, out += 3, in += 3)
+        {
+            float r(_mm_cvtss_f32(sseRsqrt(_mm_set_ss(dot(in, in)))));
+            out[0] = in[0] * r;
+            out[1] = in[1] * r;
+            out[2] = in[2] * r;
+        }
+    }
+
+    static void crossArray(float* out, const float* a, const float* b, unsigned int count)
+    {
+        unsigned int i = 0;
+        for (; i + 4 <= count; i += 4, out += 12, a += 12, b += 12)
+        {
+            __m128 ax, ay, az, bx, by, bz;
+            sseLoad3x4(a, ax, ay, az);
+            sseLoad3x4(b, bx, by, bz);
+            sseStore3x4(out,
+                        _mm_sub_ps(_mm_mul_ps(ay, bz), _mm_mul_ps(az, by)),
+                        _mm_sub_ps(_mm_mul_ps(az, bx), _mm_mul_ps(ax, bz)),
+                        _mm_sub_ps(_mm_mul_ps(ax, by), _mm_mul_ps(ay, bx)));
+        }
+        ScalarVecKernel<float, 3>::crossArray(out, a, b, count - i);
+    }
+
+private:
+    static __m128 squaredLengths(const float* in)
+    {
+        __m128 x, y, z;
+        sseLoad3x4(in, x, y, z);
+        return _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)), _mm_mul_ps(z, z));
+    }
+};
+
+template<>
+struct VecKernel<float, 4> : public ScalarVecKernel<float, 4>
+{
+    static void dotArray(float* out, const float* a, const float* b, unsigned int count)
+    {
+        unsigned int i = 0;
+        for (; i + 4 <= count; i += 4, a += 16, b += 16)
+        {
+            __m128 p0(_mm_mul_ps(_mm_loadu_ps(a), _mm_loadu_ps(b)));
+            __m128 p1(_mm_mul_ps(_mm_loadu_ps(a + 4), _mm_loadu_ps(b + 4)));
+            __m128 p2(_mm_mul_ps(_mm_loadu_ps(a + 8), _mm_loadu_ps(b + 8)));
+            __m128 p3(_mm_mul_ps(_mm_loadu_ps(a + 12), _mm_loadu_ps(b + 12)));
+            _mm_storeu_ps(out + i, sum(p0, p1, p2, p3));
+        }
+        ScalarVecKernel<float, 4>::dotArray(out + i, a, b, count - i);
+    }
+
+    static void lengthArray(float* out, const float* in, unsigned int count)
+    {
+        unsigned int i = 0;
+        for (; i + 4 <= count; i += 4, in += 16)
+        {
+            __m128 v0(_mm_loadu_ps(in));
+            __m128 v1(_mm_loadu_ps(in + 4));
+            __m128 v2(_mm_loadu_ps(in + 8));
+            __m128 v3(_mm_loadu_ps(in + 12));
+            _mm_storeu_ps(out + i, _mm_sqrt_ps(sum(_mm_mul_ps(v0, v0), _mm_mul_ps(v1, v1),
+                                                   _mm_mul_ps(v2, v2), _mm_mul_ps(v3, v3))));
+        }
+        ScalarVecKernel<float, 4>::lengthArray(out + i, in, count - i);
+    }
+
+    static void normalizeArray(float* out, const float* in, unsigned int count)
+    {
+        unsigned int i = 0;
+        for (; i + 4 <= count; i += 4, out += 16, in += 16)
+        {
+            __m128 v0(_mm_loadu_ps(in));
+            __m128 v1(_mm_loadu_ps(in + 4));
+            __m128 v2(_mm_loadu_ps(in + 8));
+            __m128 v3(_mm_loadu_ps(in + 12));
+            __m128 l(_mm_sqrt_ps(sum(_mm_mul_ps(v0, v0), _mm_mul_ps(v1, v1),
+                                     _mm_mul_ps(v2, v2), _mm_mul_ps(v3, v3))));
+            _mm_storeu_ps(out, _mm_div_ps(v0, _mm_shuffle_ps(l, l, _MM_SHUFFLE(0, 0, 0, 0))));
+            _mm_storeu_ps(out + 4, _mm_div_ps(v1, _mm_shuffle_ps(l, l, _MM_SHUFFLE(1, 1, 1, 1))));
+            _mm_storeu_ps(out + 8, _mm_div_ps(v2, _mm_shuffle_ps(l, l, _MM_SHUFFLE(2, 2, 2, 2))));
+            _mm_storeu_ps(out + 12, _mm_div_ps(v3, _mm_shuffle_ps(l, l, _MM_SHUFFLE(3, 3, 3, 3))));
+        }
+        ScalarVecKernel<float, 4>::normalizeArray(out, in, count - i);
+    }
+
+    static void normalizeArrayFast(float* out, const float* in, unsigned int count)
+    {
+        unsigned int i = 0;
+        for (; i + 4 <= count; i += 4, out += 16, in += 16)
+        {
+            __m128 v0(_mm_loadu_ps(in));
+            __m128 v1(_mm_loadu_ps(in + 4));
+            __m128 v2(_mm_loadu_ps(in + 8));
+            __m128 v3(_mm_loadu_ps(in + 12));
+            __m128 r(sseRsqrt(sum(_mm_mul_ps(v0, v0), _mm_mul_ps(v1, v1),
+                                  _mm_mul_ps(v2, v2), _mm_mul_ps(v3, v3))));
+            _mm_storeu_ps(out, _mm_mul_ps(v0, _mm_shuffle_ps(r, r, _MM_SHUFFLE(0, 0, 0, 0))));
+            _mm_storeu_ps(out + 4, _mm_mul_ps(v1, _mm_shuffle_ps(r, r, _MM_SHUFFLE(1, 1, 1, 1))));
+            _mm_storeu_ps(out + 8, _mm_mul_ps(v2, _mm_shuffle_ps(r, r, _MM_SHUFFLE(2, 2, 2, 2))));
+            _mm_storeu_ps(out + 12, _mm_mul_ps(v3, _mm_shuffle_ps(r, r, _MM_SHUFFLE(3, 3, 3, 3))));
+        }
+        for (; i < count; i++, out += 4, in += 4)
+        {
+            __m128 v(_mm_loadu_ps(in));
+            __m128 r(sseRsqrt(_mm_set1_ps(dot(in, in))));
+            _mm_storeu_ps(out, _mm_mul_ps(v, r));
+        }
+    }
+
+private:
+    // Return the sums of the elements of each of p0..p3, added up in the
+    // same order as ScalarVecKernel::dot().
+    static __m128 sum(__m128 p0, __m128 p1, __m128 p2, __m128 p3)
+    {
+        _MM_TRANSPOSE4_PS(p0, p1, p2, p3);
+        return _mm_add_ps(_mm_add_ps(_mm_add_ps(p0, p1), p2), p3);
+    }
+};
+#endif
+
+} // namespace LibMatrix
+
+#endif // SIMD_H_
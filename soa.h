@@ -0,0 +1,503 @@
+//
+// Copyright (c) 2013 Linaro Limited
+//
+// All rights reserved. This program and the accompanying materials
+// are made available under the terms of the MIT License which accompanies
+// this distribution, and is available at
+// http://www.opensource.org/licenses/mit-license.php
+//
+// Contributors:
+//     Jesse Barker - original implementation.
+//
+#ifndef SOA_H_
+#define SOA_H_
+
+#include <new>
+#include <stdlib.h>
+#include <string.h>
+#include "vec.h"
+#include "mat.h"
+#include "simd.h"
+
+namespace LibMatrix
+{
+// Storage shared by the structure-of-arrays containers.  Rather than an
+// array of vectors (x0 y0 z0 x1 y1 z1 ...), there is one array ("stream")
+// per component (x0 x1 ..., y0 y1 ..., z0 z1 ...), so that a kernel can
+// fill a whole vector register with the same component of consecutive
+// elements.  Every stream starts on a cache line boundary and is padded
+// out to a whole number of cache lines, so kernels may always work on full
+// registers; the padding is zeroed when allocated but otherwise unspecified.
+template<typename T, unsigned int Streams>
+class SoaStorage
+{
+public:
+    SoaStorage() :
+        data_(0),
+        size_(0),
+        capacity_(0) {}
+    explicit SoaStorage(unsigned int size) :
+        data_(0),
+        size_(0),
+        capacity_(0)
+    {
+        resize(size);
+    }
+    SoaStorage(const SoaStorage& other) :
+        data_(0),
+        size_(0),
+        capacity_(0)
+    {
+        *this = other;
+    }
+    ~SoaStorage()
+    {
+        free(data_);
+    }
+
+    // A direct assignment of 'rhs' to this.  Return a reference to this.
+    SoaStorage& operator=(const SoaStorage& rhs)
+    {
+        if (this != &rhs)
+        {
+            resize(rhs.size_);
+            if (capacity_)
+            {
+                memcpy(data_, rhs.data_, Streams * capacity_ * sizeof(T));
+            }
+        }
+        return *this;
+    }
+
+    // The number of elements in each stream.
+    unsigned int size() const { return size_; }
+
+    // The number of elements in each stream including the padding.
+    unsigned int capacity() const { return capacity_; }
+
+    // Change the number of elements.  Existing elements are kept (up to the
+    // new size); new ones are zero.
+    void resize(unsigned int size)
+    {
+        unsigned int capacity((size + padding - 1) & ~(padding - 1));
+        if (capacity != capacity_)
+        {
+            void* data(0);
+            if (capacity &&
+                posix_memalign(&data, alignment, Streams * capacity * sizeof(T)) != 0)
+            {
+                throw std::bad_alloc();
+            }
+            if (data)
+            {
+                memset(data, 0, Streams * capacity * sizeof(T));
+            }
+            T* newData(static_cast<T*>(data));
+            unsigned int keep(size < size_ ? size : size_);
+            for (unsigned int s = 0; s < Streams && keep; s++)
+            {
+                memcpy(newData + s * capacity, data_ + s * capacity_, keep * sizeof(T));
+            }
+            free(data_);
+            data_ = newData;
+            capacity_ = capacity;
+        }
+        else if (size > size_)
+        {
+            for (unsigned int s = 0; s < Streams; s++)
+            {
+                memset(data_ + s * capacity_ + size_, 0, (size - size_) * sizeof(T));
+            }
+        }
+        size_ = size;
+    }
+
+    // Access to the stream for one component.
+    T* stream(unsigned int index) { return data_ + index * capacity_; }
+    const T* stream(unsigned int index) const { return data_ + index * capacity_; }
+
+private:
+    // Streams are aligned to (and padded to a multiple of) a cache line,
+    // which also covers the widest vector register.
+    static const unsigned int alignment = 64;
+    static const unsigned int padding = 16;
+    T* data_;
+    unsigned int size_;
+    unsigned int capacity_;
+};
+
+// A structure-of-arrays container of 3-element vectors.
+template<typename T>
+class tvec3_soa : public SoaStorage<T, 3>
+{
+public:
+    tvec3_soa() {}
+    explicit tvec3_soa(unsigned int size) : SoaStorage<T, 3>(size) {}
+
+    // Access to the stream of each component.
+    T* x() { return this->stream(0); }
+    T* y() { return this->stream(1); }
+    T* z() { return this->stream(2); }
+    const T* x() const { return this->stream(0); }
+    const T* y() const { return this->stream(1); }
+    const T* z() const { return this->stream(2); }
+
+    // Get and set access members for individual vectors.
+    const tvec3<T> get(unsigned int i) const
+    {
+        return tvec3<T>(x()[i], y()[i], z()[i]);
+    }
+    void set(unsigned int i, const tvec3<T>& v)
+    {
+        x()[i] = v.x();
+        y()[i] = v.y();
+        z()[i] = v.z();
+    }
+
+    // Replace the contents of this with 'count' vectors from 'src'.
+    void load(const tvec3<T>* src, unsigned int count)
+    {
+        this->resize(count);
+        for (unsigned int i = 0; i < count; i++)
+        {
+            set(i, src[i]);
+        }
+    }
+
+    // Copy the contents of this out to the 'size()' vectors at 'dst'.
+    void store(tvec3<T>* dst) const
+    {
+        for (unsigned int i = 0; i < this->size(); i++)
+        {
+            dst[i] = get(i);
+        }
+    }
+};
+
+// A structure-of-arrays container of 4-element vectors.
+template<typename T>
+class tvec4_soa : public SoaStorage<T, 4>
+{
+public:
+    tvec4_soa() {}
+    explicit tvec4_soa(unsigned int size) : SoaStorage<T, 4>(size) {}
+
+    // Access to the stream of each component.
+    T* x() { return this->stream(0); }
+    T* y() { return this->stream(1); }
+    T* z() { return this->stream(2); }
+    T* w() { return this->stream(3); }
+    const T* x() const { return this->stream(0); }
+    const T* y() const { return this->stream(1); }
+    const T* z() const { return this->stream(2); }
+    const T* w() const { return this->stream(3); }
+
+    // Get and set access members for individual vectors.
+    const tvec4<T> get(unsigned int i) const
+    {
+        return tvec4<T>(x()[i], y()[i], z()[i], w()[i]);
+    }
+    void set(unsigned int i, const tvec4<T>& v)
+    {
+        x()[i] = v.x();
+        y()[i] = v.y();
+        z()[i] = v.z();
+        w()[i] = v.w();
+    }
+
+    // Replace the contents of this with 'count' vectors from 'src'.
+    void load(const tvec4<T>* src, unsigned int count)
+    {
+        this->resize(count);
+        for (unsigned int i = 0; i < count; i++)
+        {
+            set(i, src[i]);
+        }
+    }
+
+    // Copy the contents of this out to the 'size()' vectors at 'dst'.
+    void store(tvec4<T>* dst) const
+    {
+        for (unsigned int i = 0; i < this->size(); i++)
+        {
+            dst[i] = get(i);
+        }
+    }
+};
+
+// A structure-of-arrays container of 4x4 matrices, with one stream per
+// element.  Streams are numbered in the same column-major order as the
+// elements of tmat4.
+template<typename T>
+class tmat4_soa : public SoaStorage<T, 16>
+{
+public:
+    tmat4_soa() {}
+    explicit tmat4_soa(unsigned int size) : SoaStorage<T, 16>(size) {}
+
+    // Access to the stream of one element.
+    T* element(unsigned int row, unsigned int col) { return this->stream(col * 4 + row); }
+    const T* element(unsigned int row, unsigned int col) const { return this->stream(col * 4 + row); }
+
+    // Get and set access members for individual matrices.
+    const tmat4<T> get(unsigned int i) const
+    {
+        tmat4<T> m(uninitialized);
+        T* e(m.data());
+        for (unsigned int s = 0; s < 16; s++)
+        {
+            e[s] = this->stream(s)[i];
+        }
+        return m;
+    }
+    void set(unsigned int i, const tmat4<T>& m)
+    {
+        const T* e(m);
+        for (unsigned int s = 0; s < 16; s++)
+        {
+            this->stream(s)[i] = e[s];
+        }
+    }
+
+    // Replace the contents of this with 'count' matrices from 'src'.
+    void load(const tmat4<T>* src, unsigned int count)
+    {
+        this->resize(count);
+        for (unsigned int i = 0; i < count; i++)
+        {
+            set(i, src[i]);
+        }
+    }
+
+    // Copy the contents of this out to the 'size()' matrices at 'dst'.
+    void store(tmat4<T>* dst) const
+    {
+        for (unsigned int i = 0; i < this->size(); i++)
+        {
+            dst[i] = get(i);
+        }
+    }
+};
+
+//
+// Convenience typedefs.
+//
+typedef tvec3_soa<float> vec3_soa;
+typedef tvec4_soa<float> vec4_soa;
+typedef tmat4_soa<float> mat4_soa;
+
+typedef tvec3_soa<double> dvec3_soa;
+typedef tvec4_soa<double> dvec4_soa;
+typedef tmat4_soa<double> dmat4_soa;
+
+//
+// Kernels for the structure-of-arrays containers.  Each one works a full
+// vector register (see Lanes in simd.h) of consecutive elements at a time.
+// Where the output is another container, it is resized to match the input
+// and may be the same object as an input; binary operations require both
+// inputs to be the same size.
+//
+namespace Batch
+{
+
+// Transform every vector of 'in' by 'm' into 'out'.
+template<typename T>
+void
+transform(tvec4_soa<T>& out, const tmat4<T>& m, const tvec4_soa<T>& in)
+{
+    typedef Lanes<T> L;
+    typedef typename L::Type V;
+    out.resize(in.size());
+    V e[16];
+    for (unsigned int s = 0; s < 16; s++)
+    {
+        e[s] = L::splat(static_cast<const T*>(m)[s]);
+    }
+    for (unsigned int i = 0; i < in.size(); i += L::width)
+    {
+        V x(L::load(in.x() + i));
+        V y(L::load(in.y() + i));
+        V z(L::load(in.z() + i));
+        V w(L::load(in.w() + i));
+        for (unsigned int r = 0; r < 4; r++)
+        {
+            V v(L::add(L::add(L::add(L::mul(e[r], x), L::mul(e[4 + r], y)),
+                              L::mul(e[8 + r], z)), L::mul(e[12 + r], w)));
+            L::store(out.stream(r) + i, v);
+        }
+    }
+}
+
+// Transform every point (w = 1) of 'in' by the affine matrix 'm' into
+// 'out'.  The bottom row of 'm' is ignored.
+template<typename T>
+void
+transformPoints(tvec3_soa<T>& out, const tmat4<T>& m, const tvec3_soa<T>& in)
+{
+    typedef Lanes<T> L;
+    typedef typename L::Type V;
+    out.resize(in.size());
+    V e[16];
+    for (unsigned int s = 0; s < 16; s++)
+    {
+        e[s] = L::splat(static_cast<const T*>(m)[s]);
+    }
+    for (unsigned int i = 0; i < in.size(); i += L::width)
+    {
+        V x(L::load(in.x() + i));
+        V y(L::load(in.y() + i));
+        V z(L::load(in.z() + i));
+        for (unsigned int r = 0; r < 3; r++)
+        {
+            V v(L::add(L::add(L::add(L::mul(e[r], x), L::mul(e[4 + r], y)),
+                              L::mul(e[8 + r], z)), e[12 + r]));
+            L::store(out.stream(r) + i, v);
+        }
+    }
+}
+
+// Compute the dot product of each pair of vectors from 'a' and 'b' into the
+// 'a.size()' scalars at 'out'.
+template<typename T>
+void
+dot(T* out, const tvec3_soa<T>& a, const tvec3_soa<T>& b)
+{
+    typedef Lanes<T> L;
+    unsigned int i(0);
+    // 'out' is not padded, so the tail is done one element at a time.
+    for (; i + L::width <= a.size(); i += L::width)
+    {
+        typename L::Type v(L::add(L::add(L::mul(L::load(a.x() + i), L::load(b.x() + i)),
+                                         L::mul(L::load(a.y() + i), L::load(b.y() + i))),
+                                  L::mul(L::load(a.z() + i), L::load(b.z() + i))));
+        L::storeUnaligned(out + i, v);
+    }
+    for (; i < a.size(); i++)
+    {
+        out[i] = (a.x()[i] * b.x()[i]) + (a.y()[i] * b.y()[i]) + (a.z()[i] * b.z()[i]);
+    }
+}
+
+// Compute the dot product of each pair of vectors from 'a' and 'b' into the
+// 'a.size()' scalars at 'out'.
+template<typename T>
+void
+dot(T* out, const tvec4_soa<T>& a, const tvec4_soa<T>& b)
+{
+    typedef Lanes<T> L;
+    unsigned int i(0);
+    // 'out' is not padded, so the tail is done one element at a time.
+    for (; i + L::width <= a.size(); i += L::width)
+    {
+        typename L::Type v(L::add(L::add(L::add(L::mul(L::load(a.x() + i), L::load(b.x() + i)),
+                                                L::mul(L::load(a.y() + i), L::load(b.y() + i))),
+                                         L::mul(L::load(a.z() + i), L::load(b.z() + i))),
+                                  L::mul(L::load(a.w() + i), L::load(b.w() + i))));
+        L::storeUnaligned(out + i, v);
+    }
+    for (; i < a.size(); i++)
+    {
+        out[i] = (a.x()[i] * b.x()[i]) + (a.y()[i] * b.y()[i]) +
+                 (a.z()[i] * b.z()[i]) + (a.w()[i] * b.w()[i]);
+    }
+}
+
+// Compute the cross product of each pair of vectors from 'a' and 'b' into
+// 'out'.
+template<typename T>
+void
+cross(tvec3_soa<T>& out, const tvec3_soa<T>& a, const tvec3_soa<T>& b)
+{
+    typedef Lanes<T> L;
+    typedef typename L::Type V;
+    out.resize(a.size());
+    for (unsigned int i = 0; i < a.size(); i += L::width)
+    {
+        V ax(L::load(a.x() + i));
+        V ay(L::load(a.y() + i));
+        V az(L::load(a.z() + i));
+        V bx(L::load(b.x() + i));
+        V by(L::load(b.y() + i));
+        V bz(L::load(b.z() + i));
+        L::store(out.x() + i, L::sub(L::mul(ay, bz), L::mul(az, by)));
+        L::store(out.y() + i, L::sub(L::mul(az, bx), L::mul(ax, bz)));
+        L::store(out.z() + i, L::sub(L::mul(ax, by), L::mul(ay, bx)));
+    }
+}
+
+// Make every vector of 'v' a unit vector.
+template<typename T>
+void
+normalize(tvec3_soa<T>& v)
+{
+    typedef Lanes<T> L;
+    typedef typename L::Type V;
+    for (unsigned int i = 0; i < v.size(); i += L::width)
+    {
+        V x(L::load(v.x() + i));
+        V y(L::load(v.y() + i));
+        V z(L::load(v.z() + i));
+        V l(L::sqrt(L::add(L::add(L::mul(x, x), L::mul(y, y)), L::mul(z, z))));
+        L::store(v.x() + i, L::div(x, l));
+        L::store(v.y() + i, L::div(y, l));
+        L::store(v.z() + i, L::div(z, l));
+    }
+}
+
+// Make every vector of 'v' a unit vector.
+template<typename T>
+void
+normalize(tvec4_soa<T>& v)
+{
+    typedef Lanes<T> L;
+    typedef typename L::Type V;
+    for (unsigned int i = 0; i < v.size(); i += L::width)
+    {
+        V x(L::load(v.x() + i));
+        V y(L::load(v.y() + i));
+        V z(L::load(v.z() + i));
+        V w(L::load(v.w() + i));
+        V l(L::sqrt(L::add(L::add(L::add(L::mul(x, x), L::mul(y, y)),
+                                  L::mul(z, z)), L::mul(w, w))));
+        L::store(v.x() + i, L::div(x, l));
+        L::store(v.y() + i, L::div(y, l));
+        L::store(v.z() + i, L::div(z, l));
+        L::store(v.w() + i, L::div(w, l));
+    }
+}
+
+// Compute a[i] * b[i] into out[i] for every pair of matrices.
+template<typename T>
+void
+multiply(tmat4_soa<T>& out, const tmat4_soa<T>& a, const tmat4_soa<T>& b)
+{
+    typedef Lanes<T> L;
+    typedef typename L::Type V;
+    out.resize(a.size());
+    for (unsigned int i = 0; i < a.size(); i += L::width)
+    {
+        V av[16];
+        V bv[16];
+        for (unsigned int s = 0; s < 16; s++)
+        {
+            av[s] = L::load(a.stream(s) + i);
+            bv[s] = L::load(b.stream(s) + i);
+        }
+        for (unsigned int c = 0; c < 4; c++)
+        {
+            for (unsigned int r = 0; r < 4; r++)
+            {
+                V v(L::add(L::add(L::add(L::mul(av[r], bv[c * 4]),
+                                         L::mul(av[4 + r], bv[c * 4 + 1])),
+                                  L::mul(av[8 + r], bv[c * 4 + 2])),
+                           L::mul(av[12 + r], bv[c * 4 + 3])));
+                L::store(out.stream(c * 4 + r) + i, v);
+            }
+        }
+    }
+}
+
+} // namespace Batch
+} // namespace LibMatrix
+
+#endif // SOA_H_
@@ -12,8 +12,12 @@
 #ifndef STACK_H_
 #define STACK_H_
 
+#include <stdexcept>
+#include <stdint.h>
+#include <string.h>
 #include <vector>
 #include "mat.h"
+#include "quat.h"
 
 namespace LibMatrix
 {
@@ -22,15 +26,21 @@ namespace LibMatrix
 // state.  Default construction puts an identity matrix on the top of the 
 // stack.
 //
+// Every change to the top of the stack (operator*=, loadIdentity, pop and
+// anything done through top()) counts towards getVersion(), so that values
+// derived from the top can be cached until it changes.
+//
 template<typename T>
 class MatrixStack
 {
 public:
-    MatrixStack()
+    MatrixStack() :
+        version_(1)
     {
         theStack_.push_back(T());
     }
-    MatrixStack(const T& matrix)
+    MatrixStack(const T& matrix) :
+        version_(1)
     {
         theStack_.push_back(matrix);
     }
@@ -45,14 +55,15 @@ public:
     void pop()
     {
         theStack_.pop_back();
+        version_++;
     }
     void loadIdentity()
     {
-        theStack_.back().setIdentity();
+        top().setIdentity();
     }
     T& operator*=(const T& rhs)
     {
-        T& curMatrix = theStack_.back();
+        T& curMatrix = top();
         curMatrix *= rhs;
         return curMatrix;
     }
@@ -62,24 +73,208 @@ public:
         curMatrix.print();
     }
     unsigned int getDepth() const { return theStack_.size(); }
+    // A count that differs whenever the top of the stack may have changed.
+    uint64_t getVersion() const { return version_; }
+protected:
+    // Writable access to the top of the stack, which counts as a change.
+    T& top()
+    {
+        version_++;
+        return theStack_.back();
+    }
 private:
     std::vector<T> theStack_;
+    uint64_t version_;
 };
 
-class Stack4 : public MatrixStack<mat4> 
+//
+// A matrix stack with the same interface as MatrixStack, but with room for
+// at most 'Depth' matrices (including the bottom one) held inside the
+// object itself, so that pushing and popping never allocate.  push() past
+// the capacity throws std::overflow_error, and pop() of the bottom matrix
+// throws std::underflow_error, leaving the stack unchanged.  Changes are
+// counted by getVersion() as for MatrixStack.
+//
+template<typename T, unsigned int Depth>
+class FixedMatrixStack
 {
 public:
-    void translate(float x, float y, float z)
+    FixedMatrixStack() :
+        depth_(1),
+        version_(1)
+    {
+        (void) sizeof(CompileTimeCheck<(Depth > 0)>);
+    }
+    FixedMatrixStack(const T& matrix) :
+        depth_(1),
+        version_(1)
+    {
+        (void) sizeof(CompileTimeCheck<(Depth > 0)>);
+        theStack_[0] = matrix;
+    }
+    ~FixedMatrixStack() {}
+
+    const T& getCurrent() const { return theStack_[depth_ - 1]; }
+
+    void push()
+    {
+        if (depth_ == Depth)
+        {
+            throw std::overflow_error("Matrix stack overflow");
+        }
+        theStack_[depth_] = theStack_[depth_ - 1];
+        depth_++;
+    }
+    void pop()
+    {
+        if (depth_ == 1)
+        {
+            throw std::underflow_error("Matrix stack underflow");
+        }
+        depth_--;
+        version_++;
+    }
+    void loadIdentity()
+    {
+        top().setIdentity();
+    }
+    T& operator*=(const T& rhs)
+    {
+        T& curMatrix = top();
+        curMatrix *= rhs;
+        return curMatrix;
+    }
+    void print() const
+    {
+        getCurrent().print();
+    }
+    unsigned int getDepth() const { return depth_; }
+    static unsigned int getCapacity() { return Depth; }
+    uint64_t getVersion() const { return version_; }
+protected:
+    T& top()
+    {
+        version_++;
+        return theStack_[depth_ - 1];
+    }
+private:
+    T theStack_[Depth];
+    unsigned int depth_;
+    uint64_t version_;
+};
+
+//
+// The transforms of Stack4, on top of a stack of tmat4<T> ('Base', either
+// kind of stack above, or DoubleMatrixStack for DStack4).
+//
+// The translate, scale, rotate and compose members post-multiply the top of
+// the stack like the rest, but update it in place: they only compute the
+// columns that change, skipping the terms that are multiplied by 0 or 1.
+// Otherwise the sums are formed in the same order as by operator*=.
+//
+// The matrices derived from the top (its inverse, the normal matrix and
+// the product with a projection) are computed on first use and cached
+// until the top changes, so asking for them again for every draw costs
+// nothing.  They are single precision, computed from getCurrent().  As the
+// caches are filled in by const members, a stack must not be queried from
+// several threads at once.
+//
+template<typename Base, typename T = float>
+class TransformStack4 : public Base
+{
+public:
+    TransformStack4() :
+        inverseVersion_(0),
+        normalVersion_(0),
+        productVersion_(0) {}
+
+    // The inverse of the top of the stack (see mat4::inverse(), with
+    // InverseCheckAffine).  Throws std::runtime_error if it is singular.
+    const mat4& getInverse() const
+    {
+        if (inverseVersion_ != this->getVersion())
+        {
+            inverse_ = this->getCurrent();
+            inverse_.inverse(InverseCheckAffine);
+            inverseVersion_ = this->getVersion();
+        }
+        return inverse_;
+    }
+
+    // The inverse transpose of the upper 3x3 of the top of the stack, for
+    // transforming normals by a model-view matrix.  Throws
+    // std::runtime_error if it is singular.
+    const mat3& getNormalMatrix() const
+    {
+        if (normalVersion_ != this->getVersion())
+        {
+            // Computed in a local, as working on the member in place
+            // would go through memory.
+            const float* m(this->getCurrent());
+            mat3 normal(m[0], m[1], m[2], m[4], m[5], m[6], m[8], m[9], m[10]);
+            normal.inverse().transpose();
+            normal_ = normal;
+            normalVersion_ = this->getVersion();
+        }
+        return normal_;
+    }
+
+    // The product of the top of 'projection' and the top of this, i.e. the
+    // model-view-projection matrix when this is the model-view stack.  It is
+    // recomputed when either top has changed.
+    template<typename Stack>
+    const mat4& getProjectionProduct(const Stack& projection) const
+    {
+        if (productVersion_ != this->getVersion() || !sameElements(projection.getCurrent(), projection_))
+        {
+            projection_ = projection.getCurrent();
+            Mat4Kernel<float>::multiply(product_.data(), projection_, this->getCurrent());
+            productVersion_ = this->getVersion();
+        }
+        return product_;
+    }
+
+    // Only column 3 changes.
+    void translate(T x, T y, T z)
+    {
+        T* m(this->top().data());
+        for (unsigned int r = 0; r < 4; r++)
+        {
+            m[12 + r] = m[r] * x + m[4 + r] * y + m[8 + r] * z + m[12 + r];
+        }
+    }
+    // Only columns 0-2 change, each by a single scale factor.
+    void scale(T x, T y, T z)
+    {
+        T* m(this->top().data());
+        for (unsigned int r = 0; r < 4; r++)
+        {
+            m[r] *= x;
+            m[4 + r] *= y;
+            m[8 + r] *= z;
+        }
+    }
+    // Only columns 0-2 change.
+    void rotate(T angle, T x, T y, T z)
+    {
+        multiplyAffine(rotation(angle, tvec3<T>(x, y, z)), false);
+    }
+    void rotate(const tquat<T>& q)
+    {
+        multiplyAffine(q.toMat4(), false);
+    }
+    // Post-multiply by translate(translation) * rotation * scale(scale).
+    void compose(const tvec3<T>& translation, const tmat3<T>& rotation, const tvec3<T>& scale)
     {
-        *this *= Mat4::translate(x, y, z);
+        multiplyAffine(composition(translation, rotation, scale), true);
     }
-    void scale(float x, float y, float z)
+    void compose(const tvec3<T>& translation, T angle, const tvec3<T>& axis, const tvec3<T>& scale)
     {
-        *this *= Mat4::scale(x, y, z);
+        multiplyAffine(composition(translation, angle, axis, scale), true);
     }
-    void rotate(float angle, float x, float y, float z)
+    void compose(const tvec3<T>& translation, const tquat<T>& rotation, const tvec3<T>& scale)
     {
-        *this *= Mat4::rotate(angle, x, y, z);
+        multiplyAffine(composition(translation, rotation.toMat3(), scale), true);
     }
     void frustum(float left, float right, float bottom, float top, float near, float far)
     {
@@ -99,6 +294,213 @@ public:
     {
         *this *= Mat4::lookAt(eyeX, eyeY, eyeZ, centerX, centerY, centerZ, upX, upY, upZ);
     }
+private:
+    // Post-multiply the top of the stack by 'a', whose last row must be
+    // (0, 0, 0, 1).  If 'translates' is false, column 3 of 'a' must be
+    // (0, 0, 0, 1) too, and column 3 of the top is left alone.
+    void multiplyAffine(const tmat4<T>& a, bool translates)
+    {
+        T* m(this->top().data());
+        const T* rhs(a);
+        T c[12];
+        for (unsigned int col = 0; col < 12; col += 4)
+        {
+            for (unsigned int r = 0; r < 4; r++)
+            {
+                c[col + r] = m[r] * rhs[col] + m[4 + r] * rhs[col + 1] + m[8 + r] * rhs[col + 2];
+            }
+        }
+        if (translates)
+        {
+            for (unsigned int r = 0; r < 4; r++)
+            {
+                m[12 + r] = m[r] * rhs[12] + m[4 + r] * rhs[13] + m[8 + r] * rhs[14] + m[12 + r];
+            }
+        }
+        for (unsigned int i = 0; i < 12; i++)
+        {
+            m[i] = c[i];
+        }
+    }
+
+    // The matrices multiplied in by rotate() and compose().  In single
+    // precision they are those of the Mat4 functions, so that the results
+    // match operator*=; in double precision the rotation is computed
+    // through a dquat, as there are no double Mat4 functions.
+    static mat4 rotation(float angle, const vec3& axis)
+    {
+        return Mat4::rotate(angle, axis.x(), axis.y(), axis.z());
+    }
+    static dmat4 rotation(double angle, const dvec3& axis)
+    {
+        return dquat(angle, axis).toMat4();
+    }
+    static mat4 composition(const vec3& translation, const mat3& rotation, const vec3& scale)
+    {
+        return Mat4::compose(translation, rotation, scale);
+    }
+    static mat4 composition(const vec3& translation, float angle, const vec3& axis, const vec3& scale)
+    {
+        return Mat4::compose(translation, angle, axis, scale);
+    }
+    static dmat4 composition(const dvec3& translation, const dmat3& rotation, const dvec3& scale)
+    {
+        const double* r(rotation);
+        return dmat4(r[0] * scale.x(), r[1] * scale.x(), r[2] * scale.x(), 0,
+                     r[3] * scale.y(), r[4] * scale.y(), r[5] * scale.y(), 0,
+                     r[6] * scale.z(), r[7] * scale.z(), r[8] * scale.z(), 0,
+                     translation.x(), translation.y(), translation.z(), 1);
+    }
+    static dmat4 composition(const dvec3& translation, double angle, const dvec3& axis, const dvec3& scale)
+    {
+        return composition(translation, dquat(angle, axis).toMat3(), scale);
+    }
+
+    // Whether a and b hold exactly the same bits, so that a cached product
+    // is never reused for a projection that differs in any way.
+    static bool sameElements(const mat4& a, const mat4& b)
+    {
+        uint32_t e[16];
+        uint32_t f[16];
+        memcpy(e, static_cast<const float*>(a), sizeof(e));
+        memcpy(f, static_cast<const float*>(b), sizeof(f));
+        uint32_t diff(0);
+        for (unsigned int i = 0; i < 16; i++)
+        {
+            diff |= e[i] ^ f[i];
+        }
+        return diff == 0;
+    }
+
+    mutable mat4 inverse_;
+    mutable uint64_t inverseVersion_;
+    mutable mat3 normal_;
+    mutable uint64_t normalVersion_;
+    mutable mat4 projection_;
+    mutable mat4 product_;
+    mutable uint64_t productVersion_;
+};
+
+class Stack4 : public TransformStack4<MatrixStack<mat4> >
+{
+};
+
+// A Stack4 with room for 'Depth' matrices (see FixedMatrixStack).
+template<unsigned int Depth>
+class FixedStack4 : public TransformStack4<FixedMatrixStack<mat4, Depth> >
+{
+};
+
+//
+// The stack of dmat4 behind DStack4.  getCurrent() is the top rebased to
+// an origin and converted to float (see DStack4), and operator*= also takes
+// a mat4, which is multiplied in double precision.
+//
+class DoubleMatrixStack : public MatrixStack<dmat4>
+{
+public:
+    DoubleMatrixStack() :
+        origin_(0.0, 0.0, 0.0),
+        currentVersion_(0) {}
+
+    // The top of the stack, rebased to the origin and converted to float.
+    const mat4& getCurrent() const
+    {
+        if (currentVersion_ != getVersion())
+        {
+            const double* m(getCurrentDouble());
+            const double ox(origin_.x());
+            const double oy(origin_.y());
+            const double oz(origin_.z());
+            float* c(current_.data());
+            // translate(-origin) * top: each column loses origin times its w.
+            for (unsigned int col = 0; col < 16; col += 4)
+            {
+                const double w(m[col + 3]);
+                c[col] = static_cast<float>(m[col] - ox * w);
+                c[col + 1] = static_cast<float>(m[col + 1] - oy * w);
+                c[col + 2] = static_cast<float>(m[col + 2] - oz * w);
+                c[col + 3] = static_cast<float>(w);
+            }
+            currentVersion_ = getVersion();
+        }
+        return current_;
+    }
+    // The top of the stack as accumulated, before rebasing.
+    const dmat4& getCurrentDouble() const { return MatrixStack<dmat4>::getCurrent(); }
+
+    // As it changes getCurrent(), a new origin counts as a change of the
+    // top (see getVersion()).
+    void setOrigin(double x, double y, double z)
+    {
+        origin_ = dvec3(x, y, z);
+        top();
+    }
+    const dvec3& getOrigin() const { return origin_; }
+
+    using MatrixStack<dmat4>::operator*=;
+    dmat4& operator*=(const mat4& rhs)
+    {
+        return *this *= toDouble(rhs);
+    }
+
+private:
+    static dmat4 toDouble(const mat4& m)
+    {
+        dmat4 d(uninitialized);
+        const float* f(m);
+        double* e(d.data());
+        for (unsigned int i = 0; i < 16; i++)
+        {
+            e[i] = f[i];
+        }
+        return d;
+    }
+
+    dvec3 origin_;
+    mutable mat4 current_;
+    mutable uint64_t currentVersion_;
+};
+
+//
+// A Stack4 for large worlds, which accumulates its matrices in double
+// precision, so that long chains of transforms far from the origin do not
+// drift or jitter.  The top is converted to a mat4 only when it is read
+// with getCurrent() (e.g. for glUniformMatrix4fv()), and the conversion is
+// cached until the top changes.
+//
+// For camera-relative rendering, setOrigin() (e.g. to the position of the
+// camera, each frame) makes getCurrent() return translate(-origin) * top.
+// The subtraction is done in double precision before the conversion, so
+// the float matrix only has to hold offsets from the origin.  The view
+// matrix then leaves out the camera's own translation (e.g. lookAt() from
+// the origin, towards center - eye).
+//
+// It has all of the members of Stack4.  translate(), scale(), rotate() and
+// compose() take double arguments (and dquat, dvec3 and dmat3) and update
+// the top in place in double precision.  frustum(), ortho() and
+// perspective() are built in single precision by the Mat4 functions and
+// multiplied in double precision.  lookAt() does the same for the rotation,
+// and applies the translation by -eye in double precision.  getInverse(),
+// getNormalMatrix() and getProjectionProduct() are derived from
+// getCurrent(), i.e. they are rebased to the origin too.
+//
+class DStack4 : public TransformStack4<DoubleMatrixStack, double>
+{
+public:
+    // The rotation towards center - eye, then the translation by -eye.
+    void lookAt(double eyeX, double eyeY, double eyeZ,
+                double centerX, double centerY, double centerZ,
+                double upX, double upY, double upZ)
+    {
+        *this *= Mat4::lookAt(0.0f, 0.0f, 0.0f,
+                              static_cast<float>(centerX - eyeX),
+                              static_cast<float>(centerY - eyeY),
+                              static_cast<float>(centerZ - eyeZ),
+                              static_cast<float>(upX), static_cast<float>(upY),
+                              static_cast<float>(upZ));
+        translate(-eyeX, -eyeY, -eyeZ);
+    }
 };
 
 } // namespace LibMatrix
@@ -0,0 +1,161 @@
+//
+// Copyright (c) 2013 Linaro Limited
+//
+// All rights reserved. This program and the accompanying materials
+// are made available under the terms of the MIT License which accompanies
+// this distribution, and is available at
+// http://www.opensource.org/licenses/mit-license.php
+//
+// Contributors:
+//     Jesse Barker - original implementation.
+//
+#include <iostream>
+#include <math.h>
+#include "libmatrix_test.h"
+#include "access_test.h"
+#include "../mat.h"
+
+using LibMatrix::mat2;
+using LibMatrix::mat3;
+using LibMatrix::mat4;
+using LibMatrix::vec2;
+using LibMatrix::vec3;
+using LibMatrix::vec4;
+using std::cout;
+using std::endl;
+
+// Check every way of reading the elements of 'm' against operator[].
+template<typename M, typename V>
+static bool
+checkAccess(M& m, unsigned int n)
+{
+    for (unsigned int r = 0; r < n; r++)
+    {
+        for (unsigned int c = 0; c < n; c++)
+        {
+            m[r][c] = static_cast<float>(r * 10 + c);
+        }
+    }
+    const M& cm(m);
+    for (unsigned int r = 0; r < n; r++)
+    {
+        V row(cm.row(r));
+        for (unsigned int c = 0; c < n; c++)
+        {
+            V col(cm.column(c));
+            const float* rowData(row);
+            const float* colData(col);
+            if (cm(r, c) != cm[r][c] || &m(r, c) != &m[r][c] ||
+                rowData[c] != cm[r][c] || colData[r] != cm[r][c])
+            {
+                return false;
+            }
+        }
+    }
+
+    // Writing a column or a row back, transposed, gives the transpose.
+    M t(m);
+    for (unsigned int i = 0; i < n; i++)
+    {
+        t.setColumn(i, cm.row(i));
+    }
+    M u(m);
+    for (unsigned int i = 0; i < n; i++)
+    {
+        u.setRow(i, cm.column(i));
+    }
+    M expected(m);
+    expected.transpose();
+    return t == expected && u == expected;
+}
+
+void
+AccessTestElements::run(const Options& options)
+{
+    mat2 m2;
+    mat3 m3;
+    mat4 m4;
+    if (!checkAccess<mat2, vec2>(m2, 2) ||
+        !checkAccess<mat3, vec3>(m3, 3) ||
+        !checkAccess<mat4, vec4>(m4, 4))
+    {
+        if (options.beVerbose())
+        {
+            cout << "Element access does not match operator[]." << endl;
+        }
+        return;
+    }
+
+    m4.at<2, 3>() = 42.0f;
+    const mat4& cm4(m4);
+    if (m4[2][3] != 42.0f || cm4.at<0, 1>() != m4[0][1] ||
+        m3.at<2, 0>() != m3[2][0] || m2.at<1, 0>() != m2[1][0])
+    {
+        return;
+    }
+
+    pass_ = true;
+}
+
+void
+AccessTestGenerators::run(const Options& options)
+{
+    // A quarter turn about z takes x to y and y to -x.
+    mat4 r(LibMatrix::Mat4::rotate(90.0f, 0.0f, 0.0f, 2.0f));
+    mat4 expected(0, 1, 0, 0,
+                  -1, 0, 0, 0,
+                  0, 0, 1, 0,
+                  0, 0, 0, 1);
+    if (maxDifference(r, expected) > 1.0e-6f)
+    {
+        if (options.beVerbose())
+        {
+            cout << "Unexpected rotation:" << endl;
+            r.print();
+        }
+        return;
+    }
+
+    // The rotation part of a view is orthonormal, and the view takes the
+    // eye to the origin and the center onto the negative z axis.
+    mat4 view(LibMatrix::Mat4::lookAt(1.0f, 2.0f, 3.0f, 4.0f, -2.0f, 3.0f, 0.0f, 1.0f, 0.0f));
+    mat4 rotation(view);
+    rotation.setColumn(3, vec4(0.0f, 0.0f, 0.0f, 1.0f));
+    mat4 transposed(rotation);
+    transposed.transpose();
+    vec4 eye(view * vec4(1.0f, 2.0f, 3.0f, 1.0f));
+    vec4 center(view * vec4(4.0f, -2.0f, 3.0f, 1.0f));
+    if (maxDifference(rotation * transposed, mat4()) > 1.0e-6f ||
+        fabs(eye.x()) > 1.0e-6f || fabs(eye.y()) > 1.0e-6f || fabs(eye.z()) > 1.0e-6f ||
+        fabs(center.x()) > 1.0e-6f || fabs(center.y()) > 1.0e-6f ||
+        fabs(center.z() + 5.0f) > 1.0e-5f)
+    {
+        if (options.beVerbose())
+        {
+            cout << "Unexpected view:" << endl;
+            view.print();
+        }
+        return;
+    }
+
+    // The projections take the near and far planes to -1 and 1.
+    mat4 p(LibMatrix::Mat4::perspective(90.0f, 2.0f, 1.0f, 3.0f));
+    vec4 near(p * vec4(2.0f, 1.0f, -1.0f, 1.0f));
+    vec4 far(p * vec4(0.0f, 0.0f, -3.0f, 1.0f));
+    mat4 f(LibMatrix::Mat4::frustum(-2.0f, 2.0f, -1.0f, 1.0f, 1.0f, 3.0f));
+    if (maxDifference(p, f) > 1.0e-6f || fabs(near.x() / near.w() - 1.0f) > 1.0e-6f ||
+        fabs(near.y() / near.w() - 1.0f) > 1.0e-6f ||
+        fabs(near.z() / near.w() + 1.0f) > 1.0e-6f ||
+        fabs(far.z() / far.w() - 1.0f) > 1.0e-6f)
+    {
+        if (options.beVerbose())
+        {
+            cout << "Unexpected projection:" << endl;
+            p.print();
+            f.print();
+        }
+        return;
+    }
+
+    pass_ = true;
+}
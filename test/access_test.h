@@ -0,0 +1,32 @@
+//
+// Copyright (c) 2013 Linaro Limited
+//
+// All rights reserved. This program and the accompanying materials
+// are made available under the terms of the MIT License which accompanies
+// this distribution, and is available at
+// http://www.opensource.org/licenses/mit-license.php
+//
+// Contributors:
+//     Jesse Barker - original implementation.
+//
+#ifndef ACCESS_TEST_H_
+#define ACCESS_TEST_H_
+
+class MatrixTest;
+class Options;
+
+class AccessTestElements : public MatrixTest
+{
+public:
+    AccessTestElements() : MatrixTest("matrix element, row and column access") {}
+    virtual void run(const Options& options);
+};
+
+class AccessTestGenerators : public MatrixTest
+{
+public:
+    AccessTestGenerators() : MatrixTest("Mat4 generators") {}
+    virtual void run(const Options& options);
+};
+
+#endif // ACCESS_TEST_H_
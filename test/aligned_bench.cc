@@ -0,0 +1,123 @@
+//
+// Copyright (c) 2013 Linaro Limited
+//
+// All rights reserved. This program and the accompanying materials
+// are made available under the terms of the MIT License which accompanies
+// this distribution, and is available at
+// http://www.opensource.org/licenses/mit-license.php
+//
+// Contributors:
+//     Jesse Barker - original implementation.
+//
+#include <iostream>
+#include <sstream>
+#include <vector>
+#include "libmatrix_test.h"
+#include "libmatrix_bench.h"
+#include "aligned_bench.h"
+#include "../aligned.h"
+
+using LibMatrix::mat4;
+using LibMatrix::mat4_aligned;
+using LibMatrix::aligned_allocator;
+using std::vector;
+
+namespace
+{
+
+const unsigned int minItems(1 << 20);
+
+// The number of passes over 'count' matrices that makes up one timed run.
+unsigned int
+passes(unsigned int count)
+{
+    return (minItems + count - 1) / count;
+}
+
+// The pairwise batch multiply, repeated passes(count) times.
+template<typename M>
+class Multiply
+{
+public:
+    Multiply(M* out, const M* lhs, const M* rhs, unsigned int count) :
+        out_(out), lhs_(lhs), rhs_(rhs), count_(count) {}
+    void operator()()
+    {
+        for (unsigned int pass = 0; pass < passes(count_); pass++)
+        {
+            LibMatrix::Batch::multiply(out_, lhs_, rhs_, count_);
+        }
+    }
+private:
+    M* out_;
+    const M* lhs_;
+    const M* rhs_;
+    unsigned int count_;
+};
+
+template<typename M>
+uint64_t
+timeMultiply(M* out, const M* lhs, const M* rhs, unsigned int count)
+{
+    Multiply<M> op(out, lhs, rhs, count);
+    return MatrixBench::fastest(op);
+}
+
+template<typename M>
+void
+fill(M* m, unsigned int count)
+{
+    for (unsigned int i = 0; i < count; i++)
+    {
+        m[i] = LibMatrix::Mat4::rotate(static_cast<float>(i % 360), 0.0f, 1.0f, 0.0f);
+    }
+}
+
+// Three arrays of 'count' mat4s at the given offset (in floats) from a
+// cache line boundary.
+uint64_t
+timeOffset(unsigned int count, unsigned int offset)
+{
+    vector<mat4, aligned_allocator<mat4> > storage(3 * count + 1);
+    float* base(storage[0].data() + offset);
+    mat4* lhs(reinterpret_cast<mat4*>(base));
+    mat4* rhs(lhs + count);
+    mat4* out(rhs + count);
+    fill(lhs, count);
+    fill(rhs, count);
+    return timeMultiply(out, lhs, rhs, count);
+}
+
+} // namespace
+
+void
+AlignedBenchMultiply::run(const Options&)
+{
+    static const unsigned int sizes[] = { 1024, 262144 };
+    for (unsigned int s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++)
+    {
+        unsigned int count(sizes[s]);
+        unsigned int items(count * passes(count));
+        std::stringstream ss;
+        ss << count << " matrices, ";
+        std::string prefix(ss.str());
+
+        report(prefix + "64-byte aligned", timeOffset(count, 0), items);
+        report(prefix + "16-byte aligned", timeOffset(count, 4), items);
+        report(prefix + "4-byte aligned", timeOffset(count, 1), items);
+
+        vector<mat4> lhs(count);
+        vector<mat4> rhs(count);
+        vector<mat4> out(count);
+        fill(&lhs[0], count);
+        fill(&rhs[0], count);
+        report(prefix + "std::vector<mat4>", timeMultiply(&out[0], &lhs[0], &rhs[0], count), items);
+
+        vector<mat4_aligned, aligned_allocator<mat4_aligned> > alhs(count);
+        vector<mat4_aligned, aligned_allocator<mat4_aligned> > arhs(count);
+        vector<mat4_aligned, aligned_allocator<mat4_aligned> > aout(count);
+        fill(&alhs[0], count);
+        fill(&arhs[0], count);
+        report(prefix + "mat4_aligned", timeMultiply(&aout[0], &alhs[0], &arhs[0], count), items);
+    }
+}
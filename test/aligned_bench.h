@@ -0,0 +1,25 @@
+//
+// Copyright (c) 2013 Linaro Limited
+//
+// All rights reserved. This program and the accompanying materials
+// are made available under the terms of the MIT License which accompanies
+// this distribution, and is available at
+// http://www.opensource.org/licenses/mit-license.php
+//
+// Contributors:
+//     Jesse Barker - original implementation.
+//
+#ifndef ALIGNED_BENCH_H_
+#define ALIGNED_BENCH_H_
+
+class MatrixBench;
+class Options;
+
+class AlignedBenchMultiply : public MatrixBench
+{
+public:
+    AlignedBenchMultiply() : MatrixBench("Batch::multiply by storage alignment") {}
+    virtual void run(const Options& options);
+};
+
+#endif // ALIGNED_BENCH_H_
@@ -0,0 +1,155 @@
+//
+// Copyright (c) 2013 Linaro Limited
+//
+// All rights reserved. This program and the accompanying materials
+// are made available under the terms of the MIT License which accompanies
+// this distribution, and is available at
+// http://www.opensource.org/licenses/mit-license.php
+//
+// Contributors:
+//     Jesse Barker - original implementation.
+//
+#include <iostream>
+#include <vector>
+#include "libmatrix_test.h"
+#include "aligned_test.h"
+#include "../aligned.h"
+
+using LibMatrix::mat4;
+using LibMatrix::vec4;
+using LibMatrix::mat4_aligned;
+using LibMatrix::dmat4_aligned;
+using LibMatrix::vec4_aligned;
+using LibMatrix::dvec4_aligned;
+using LibMatrix::tvec4_aligned;
+using LibMatrix::aligned_allocator;
+using std::cout;
+using std::endl;
+using std::vector;
+
+static bool
+isAligned(const void* p, unsigned long alignment)
+{
+    return reinterpret_cast<unsigned long>(p) % alignment == 0;
+}
+
+void
+AlignedTestLayout::run(const Options& options)
+{
+    if (sizeof(mat4_aligned) != sizeof(mat4) ||
+        sizeof(dmat4_aligned) != sizeof(LibMatrix::dmat4) ||
+        sizeof(vec4_aligned) != sizeof(vec4) ||
+        sizeof(dvec4_aligned) != sizeof(LibMatrix::dvec4) ||
+        sizeof(tvec4_aligned<float, 64>) != 64)
+    {
+        if (options.beVerbose())
+        {
+            cout << "Unexpected size for an aligned type." << endl;
+        }
+        return;
+    }
+
+    // The raw data has to be the same as for the plain types, so it can go
+    // straight to glUniformMatrix4fv() and friends.
+    mat4 m(LibMatrix::Mat4::translate(1.0f, 2.0f, 3.0f));
+    mat4_aligned a(m);
+    const float* mData(m);
+    const float* aData(a);
+    for (unsigned int i = 0; i < 16; i++)
+    {
+        if (mData[i] != aData[i])
+        {
+            return;
+        }
+    }
+    if (aData != reinterpret_cast<const float*>(&a) || !isAligned(&a, 64))
+    {
+        return;
+    }
+
+    // Arithmetic goes through the base class and converts back.
+    a *= m;
+    m *= m;
+    a = a * LibMatrix::Mat4::scale(2.0f, 2.0f, 2.0f);
+    if (a != m * LibMatrix::Mat4::scale(2.0f, 2.0f, 2.0f))
+    {
+        return;
+    }
+
+    vector<mat4, aligned_allocator<mat4> > mats(13);
+    vector<mat4_aligned, aligned_allocator<mat4_aligned> > alignedMats(13);
+    vector<tvec4_aligned<float, 32>, aligned_allocator<tvec4_aligned<float, 32>, 32> > vecs(13);
+    for (unsigned int i = 0; i < 13; i++)
+    {
+        if (!isAligned(&mats[i], 64) || !isAligned(&alignedMats[i], 64) ||
+            !isAligned(&vecs[i], 32))
+        {
+            if (options.beVerbose())
+            {
+                cout << "Element " << i << " of an allocated array is misaligned." << endl;
+            }
+            return;
+        }
+    }
+    mats.push_back(m);
+    if (!isAligned(&mats[0], 64) || mats[13] != m)
+    {
+        return;
+    }
+
+    pass_ = true;
+}
+
+void
+AlignedTestBatch::run(const Options& options)
+{
+    static const unsigned int count(29);
+    mat4 m(LibMatrix::Mat4::perspective(60.0, 1.5, 1.0, 100.0));
+    m *= LibMatrix::Mat4::translate(0.5f, -1.0f, -10.0f);
+
+    vector<vec4> plain(count);
+    vector<tvec4_aligned<float, 32>, aligned_allocator<tvec4_aligned<float, 32>, 32> > padded(count);
+    vector<vec4_aligned, aligned_allocator<vec4_aligned, 16> > packed(count);
+    for (unsigned int i = 0; i < count; i++)
+    {
+        plain[i] = vec4(i * 0.5f, 1.0f - i, 0.25f * i, 1.0f);
+        padded[i] = plain[i];
+        packed[i] = plain[i];
+    }
+
+    vector<vec4> expected(count);
+    LibMatrix::Batch::transform(&expected[0], m, &plain[0], count, LibMatrix::Batch::DivideByW);
+    LibMatrix::Batch::transform(&packed[0], m, &packed[0], count, LibMatrix::Batch::DivideByW);
+    LibMatrix::ThreadPool pool(3);
+    LibMatrix::Batch::transform(pool, &padded[0], m, &padded[0], count, LibMatrix::Batch::DivideByW, 4);
+    for (unsigned int i = 0; i < count; i++)
+    {
+        if (padded[i].x() != expected[i].x() || padded[i].y() != expected[i].y() ||
+            padded[i].z() != expected[i].z() || padded[i].w() != expected[i].w() ||
+            packed[i].x() != expected[i].x() || packed[i].w() != expected[i].w())
+        {
+            if (options.beVerbose())
+            {
+                cout << "Aligned vector " << i << " was transformed incorrectly." << endl;
+            }
+            return;
+        }
+    }
+
+    // Aligned matrices go through the plain tmat4 batch functions.
+    vector<mat4_aligned, aligned_allocator<mat4_aligned> > mats(count);
+    for (unsigned int i = 0; i < count; i++)
+    {
+        mats[i] = LibMatrix::Mat4::rotate(10.0f * i, 0.0f, 0.0f, 1.0f);
+    }
+    LibMatrix::Batch::multiply(&mats[0], m, &mats[0], count);
+    for (unsigned int i = 0; i < count; i++)
+    {
+        if (mats[i] != m * LibMatrix::Mat4::rotate(10.0f * i, 0.0f, 0.0f, 1.0f))
+        {
+            return;
+        }
+    }
+
+    pass_ = true;
+}
@@ -0,0 +1,32 @@
+//
+// Copyright (c) 2013 Linaro Limited
+//
+// All rights reserved. This program and the accompanying materials
+// are made available under the terms of the MIT License which accompanies
+// this distribution, and is available at
+// http://www.opensource.org/licenses/mit-license.php
+//
+// Contributors:
+//     Jesse Barker - original implementation.
+//
+#ifndef ALIGNED_TEST_H_
+#define ALIGNED_TEST_H_
+
+class MatrixTest;
+class Options;
+
+class AlignedTestLayout : public MatrixTest
+{
+public:
+    AlignedTestLayout() : MatrixTest("aligned::layout") {}
+    virtual void run(const Options& options);
+};
+
+class AlignedTestBatch : public MatrixTest
+{
+public:
+    AlignedTestBatch() : MatrixTest("aligned::Batch") {}
+    virtual void run(const Options& options);
+};
+
+#endif // ALIGNED_TEST_H_
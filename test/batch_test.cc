@@ -0,0 +1,338 @@
+//
+// Copyright (c) 2013 Linaro Limited
+//
+// All rights reserved. This program and the accompanying materials
+// are made available under the terms of the MIT License which accompanies
+// this distribution, and is available at
+// http://www.opensource.org/licenses/mit-license.php
+//
+// Contributors:
+//     Jesse Barker - original implementation.
+//
+#include <iostream>
+#include <math.h>
+#include <vector>
+#include "libmatrix_test.h"
+#include "batch_test.h"
+#include "../batch.h"
+
+using LibMatrix::tmat4;
+using LibMatrix::tvec3;
+using LibMatrix::tvec4;
+using std::cout;
+using std::endl;
+using std::vector;
+
+// Fill 'count' matrices with distinct, small integral values so that the
+// batch results can be compared exactly against the member operators.
+template<typename T>
+static void
+fill(vector<tmat4<T> >& v, unsigned int count, unsigned int seed)
+{
+    v.resize(count);
+    for (unsigned int i = 0; i < count; i++)
+    {
+        for (unsigned int r = 0; r < 4; r++)
+        {
+            for (unsigned int c = 0; c < 4; c++)
+            {
+                seed = seed * 1103515245 + 12345;
+                v[i][r][c] = static_cast<T>(static_cast<int>((seed >> 16) % 9) - 4);
+            }
+        }
+    }
+}
+
+template<typename T>
+static bool
+checkBatch(const Options& options)
+{
+    // Not a multiple of the prefetch distance, to cover the tail.
+    static const unsigned int count(37);
+    vector<tmat4<T> > lhs;
+    vector<tmat4<T> > rhs;
+    fill(lhs, count, 1);
+    fill(rhs, count, 2);
+    vector<tmat4<T> > out(count);
+
+    // Pairwise.
+    LibMatrix::Batch::multiply(&out[0], &lhs[0], &rhs[0], count);
+    for (unsigned int i = 0; i < count; i++)
+    {
+        tmat4<T> expected(lhs[i]);
+        expected *= rhs[i];
+        if (out[i] != expected)
+        {
+            if (options.beVerbose())
+            {
+                cout << "Pairwise product " << i << " is wrong." << endl;
+            }
+            return false;
+        }
+    }
+
+    // One matrix on the left of all of the others.
+    LibMatrix::Batch::multiply(&out[0], lhs[5], &rhs[0], count);
+    for (unsigned int i = 0; i < count; i++)
+    {
+        tmat4<T> expected(lhs[5]);
+        expected *= rhs[i];
+        if (out[i] != expected)
+        {
+            if (options.beVerbose())
+            {
+                cout << "Left-hand product " << i << " is wrong." << endl;
+            }
+            return false;
+        }
+    }
+
+    // One matrix on the right of all of the others.
+    LibMatrix::Batch::multiply(&out[0], &lhs[0], rhs[7], count);
+    for (unsigned int i = 0; i < count; i++)
+    {
+        tmat4<T> expected(lhs[i]);
+        expected *= rhs[7];
+        if (out[i] != expected)
+        {
+            if (options.beVerbose())
+            {
+                cout << "Right-hand product " << i << " is wrong." << endl;
+            }
+            return false;
+        }
+    }
+
+    // In place, accumulating into the left-hand array.
+    vector<tmat4<T> > accum(lhs);
+    LibMatrix::Batch::multiply(&accum[0], &accum[0], &rhs[0], count);
+    for (unsigned int i = 0; i < count; i++)
+    {
+        tmat4<T> expected(lhs[i]);
+        expected *= rhs[i];
+        if (accum[i] != expected)
+        {
+            if (options.beVerbose())
+            {
+                cout << "In-place product " << i << " is wrong." << endl;
+            }
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void
+BatchTestMultiply::run(const Options& options)
+{
+    pass_ = checkBatch<float>(options);
+}
+
+void
+BatchTestMultiplyDouble::run(const Options& options)
+{
+    pass_ = checkBatch<double>(options);
+}
+
+// Vectors with small positive integral elements.  Together with a matrix
+// whose bottom row is non-negative with a 1 in the corner, every w is
+// positive, so the divided results can be compared exactly too.
+template<typename T>
+static void
+fill(vector<tvec4<T> >& v, unsigned int count, unsigned int seed)
+{
+    v.resize(count);
+    for (unsigned int i = 0; i < count; i++)
+    {
+        T e[4];
+        for (unsigned int j = 0; j < 4; j++)
+        {
+            seed = seed * 1103515245 + 12345;
+            e[j] = static_cast<T>((seed >> 16) % 9 + 1);
+        }
+        v[i] = tvec4<T>(e[0], e[1], e[2], e[3]);
+    }
+}
+
+template<typename T>
+static bool
+checkTransform(const Options& options)
+{
+    static const unsigned int count(37);
+    vector<tmat4<T> > mats;
+    fill(mats, 1, 3);
+    tmat4<T> m(mats[0]);
+    m[3][0] = 1;
+    m[3][1] = 0;
+    m[3][2] = 2;
+    m[3][3] = 1;
+    vector<tvec4<T> > in4;
+    fill(in4, count, 4);
+    vector<tvec3<T> > in3(count);
+    for (unsigned int i = 0; i < count; i++)
+    {
+        in3[i] = tvec3<T>(in4[i].x(), in4[i].y(), in4[i].z());
+    }
+
+    vector<tvec4<T> > out4(count);
+    vector<tvec4<T> > proj4(in4);
+    vector<tvec3<T> > points(count);
+    vector<tvec3<T> > proj3(in3);
+    vector<tvec3<T> > dirs(count);
+    LibMatrix::Batch::transform(&out4[0], m, &in4[0], count);
+    LibMatrix::Batch::transform(&proj4[0], m, &proj4[0], count, LibMatrix::Batch::DivideByW);
+    LibMatrix::Batch::transformPoints(&points[0], m, &in3[0], count);
+    LibMatrix::Batch::transformPoints(&proj3[0], m, &proj3[0], count, LibMatrix::Batch::DivideByW);
+    LibMatrix::Batch::transformVectors(&dirs[0], m, &in3[0], count);
+
+    for (unsigned int i = 0; i < count; i++)
+    {
+        tvec4<T> v(m * in4[i]);
+        tvec4<T> p(m * tvec4<T>(in3[i].x(), in3[i].y(), in3[i].z(), 1));
+        tvec4<T> d(m * tvec4<T>(in3[i].x(), in3[i].y(), in3[i].z(), 0));
+        T vw(v.w());
+        T pw(p.w());
+        if (out4[i].x() != v.x() || out4[i].y() != v.y() ||
+            out4[i].z() != v.z() || out4[i].w() != v.w() ||
+            proj4[i].x() != v.x() / vw || proj4[i].y() != v.y() / vw ||
+            proj4[i].z() != v.z() / vw || proj4[i].w() != 1 ||
+            points[i].x() != p.x() || points[i].y() != p.y() || points[i].z() != p.z() ||
+            proj3[i].x() != p.x() / pw || proj3[i].y() != p.y() / pw ||
+            proj3[i].z() != p.z() / pw ||
+            dirs[i].x() != d.x() || dirs[i].y() != d.y() || dirs[i].z() != d.z())
+        {
+            if (options.beVerbose())
+            {
+                cout << "Transformed vector " << i << " is wrong." << endl;
+            }
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void
+BatchTestTransform::run(const Options& options)
+{
+    pass_ = checkTransform<float>(options);
+}
+
+void
+BatchTestTransformDouble::run(const Options& options)
+{
+    pass_ = checkTransform<double>(options);
+}
+
+// Whether a and b differ by no more than 'tolerance' relative to b.
+template<typename T>
+static bool
+near(T a, T b, T tolerance)
+{
+    T diff(a > b ? a - b : b - a);
+    return diff <= tolerance * (b < 0 ? -b : b);
+}
+
+template<typename T>
+static bool
+checkVectors(const Options& options, T tolerance)
+{
+    // The length of a double vector is computed in double precision.
+    if (sizeof(tvec3<T>().length()) != sizeof(T) ||
+        tvec3<T>(1, 1, 1).length() != sqrt(static_cast<T>(3)))
+    {
+        if (options.beVerbose())
+        {
+            cout << "length() is not computed in the element type." << endl;
+        }
+        return false;
+    }
+
+    // Not a multiple of the SIMD block size, to cover the tail.
+    static const unsigned int count(37);
+    vector<tvec4<T> > a4;
+    vector<tvec4<T> > b4;
+    fill(a4, count, 5);
+    fill(b4, count, 6);
+    vector<tvec3<T> > a3(count);
+    vector<tvec3<T> > b3(count);
+    for (unsigned int i = 0; i < count; i++)
+    {
+        // Mix the signs up a little for the cross products.
+        a3[i] = tvec3<T>(a4[i].x(), -a4[i].y(), a4[i].z());
+        b3[i] = tvec3<T>(b4[i].w(), b4[i].x(), -b4[i].y());
+    }
+
+    vector<T> dot3(count);
+    vector<T> dot4(count);
+    vector<T> len3(count);
+    vector<T> len4(count);
+    vector<tvec3<T> > unit3(count);
+    vector<tvec4<T> > unit4(count);
+    vector<tvec3<T> > fast3(a3);
+    vector<tvec4<T> > fast4(a4);
+    vector<tvec3<T> > cross3(a3);
+    LibMatrix::Batch::dot(&dot3[0], &a3[0], &b3[0], count);
+    LibMatrix::Batch::dot(&dot4[0], &a4[0], &b4[0], count);
+    LibMatrix::Batch::length(&len3[0], &a3[0], count);
+    LibMatrix::Batch::length(&len4[0], &a4[0], count);
+    LibMatrix::Batch::normalize(&unit3[0], &a3[0], count);
+    LibMatrix::Batch::normalize(&unit4[0], &a4[0], count);
+    LibMatrix::Batch::normalize(&fast3[0], &fast3[0], count, LibMatrix::fast);
+    LibMatrix::Batch::normalize(&fast4[0], &fast4[0], count, LibMatrix::fast);
+    LibMatrix::Batch::cross(&cross3[0], &cross3[0], &b3[0], count);
+
+    for (unsigned int i = 0; i < count; i++)
+    {
+        tvec3<T> u3(a3[i]);
+        tvec4<T> u4(a4[i]);
+        u3.normalize();
+        u4.normalize();
+        tvec3<T> c(tvec3<T>::cross(a3[i], b3[i]));
+        bool good(near(dot3[i], tvec3<T>::dot(a3[i], b3[i]), tolerance) &&
+                  near(dot4[i], tvec4<T>::dot(a4[i], b4[i]), tolerance) &&
+                  near(len3[i], a3[i].length(), tolerance) &&
+                  near(len4[i], a4[i].length(), tolerance) &&
+                  near(fast3[i].length(), static_cast<T>(1), tolerance) &&
+                  near(fast4[i].length(), static_cast<T>(1), tolerance) &&
+                  near(cross3[i].x(), c.x(), tolerance) &&
+                  near(cross3[i].y(), c.y(), tolerance) &&
+                  near(cross3[i].z(), c.z(), tolerance));
+        const T* want3(u3);
+        const T* want4(u4);
+        const T* unit3i(unit3[i]);
+        const T* unit4i(unit4[i]);
+        const T* fast3i(fast3[i]);
+        const T* fast4i(fast4[i]);
+        for (unsigned int j = 0; j < 4; j++)
+        {
+            good = good && near(unit4i[j], want4[j], tolerance) && near(fast4i[j], want4[j], tolerance);
+            good = good && (j == 3 || (near(unit3i[j], want3[j], tolerance) &&
+                                       near(fast3i[j], want3[j], tolerance)));
+        }
+        if (!good)
+        {
+            if (options.beVerbose())
+            {
+                cout << "Vector " << i << " is wrong." << endl;
+            }
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void
+BatchTestVectors::run(const Options& options)
+{
+    // Allow for the fast reciprocal square root (see FastMath::rsqrt()).
+    pass_ = checkVectors<float>(options, 1.0e-6f);
+}
+
+void
+BatchTestVectorsDouble::run(const Options& options)
+{
+    pass_ = checkVectors<double>(options, 1.0e-14);
+}
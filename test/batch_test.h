@@ -0,0 +1,60 @@
+//
+// Copyright (c) 2013 Linaro Limited
+//
+// All rights reserved. This program and the accompanying materials
+// are made available under the terms of the MIT License which accompanies
+// this distribution, and is available at
+// http://www.opensource.org/licenses/mit-license.php
+//
+// Contributors:
+//     Jesse Barker - original implementation.
+//
+#ifndef BATCH_TEST_H_
+#define BATCH_TEST_H_
+
+class MatrixTest;
+class Options;
+
+class BatchTestMultiply : public MatrixTest
+{
+public:
+    BatchTestMultiply() : MatrixTest("Batch::multiply (mat4)") {}
+    virtual void run(const Options& options);
+};
+
+class BatchTestMultiplyDouble : public MatrixTest
+{
+public:
+    BatchTestMultiplyDouble() : MatrixTest("Batch::multiply (dmat4)") {}
+    virtual void run(const Options& options);
+};
+
+class BatchTestTransform : public MatrixTest
+{
+public:
+    BatchTestTransform() : MatrixTest("Batch::transform (vec3/vec4)") {}
+    virtual void run(const Options& options);
+};
+
+class BatchTestTransformDouble : public MatrixTest
+{
+public:
+    BatchTestTransformDouble() : MatrixTest("Batch::transform (dvec3/dvec4)") {}
+    virtual void run(const Options& options);
+};
+
+class BatchTestVectors : public MatrixTest
+{
+public:
+    BatchTestVectors() : MatrixTest("Batch::normalize/length/dot/cross (vec3/vec4)") {}
+    virtual void run(const Options& options);
+};
+
+class BatchTestVectorsDouble : public MatrixTest
+{
+public:
+    BatchTestVectorsDouble() : MatrixTest("Batch::normalize/length/dot/cross (dvec3/dvec4)") {}
+    virtual void run(const Options& options);
+};
+
+#endif // BATCH_TEST_H_
@@ -0,0 +1,128 @@
+//
+// Copyright (c) 2013 Linaro Limited
+//
+// All rights reserved. This program and the accompanying materials
+// are made available under the terms of the MIT License which accompanies
+// this distribution, and is available at
+// http://www.opensource.org/licenses/mit-license.php
+//
+// Contributors:
+//     Jesse Barker - original implementation.
+//
+#include <iostream>
+#include "libmatrix_test.h"
+#include "constexpr_test.h"
+#include "../mat.h"
+
+using LibMatrix::vec3;
+using LibMatrix::vec4;
+using LibMatrix::mat3;
+using LibMatrix::mat4;
+using std::cout;
+using std::endl;
+
+//
+// Before C++14 none of this is a constant expression, but the same code
+// still has to compile and give the same answers at run time, so the
+// checks are written once and used both ways.
+//
+#if __cplusplus >= 201402L
+#define CONSTEXPR_CHECK(expr) static_assert(expr, #expr)
+#define CONSTEXPR_VALUE constexpr
+#else
+#define CONSTEXPR_CHECK(expr) if (!(expr)) { failed = #expr; }
+#define CONSTEXPR_VALUE const
+#endif
+
+static LIBMATRIX_CONSTEXPR float
+trace(const mat4& m)
+{
+    return m[0][0] + m[1][1] + m[2][2] + m[3][3];
+}
+
+void
+ConstexprTestVector::run(const Options& options)
+{
+    const char* failed(0);
+
+    CONSTEXPR_VALUE vec3 a(1.0f, 2.0f, 3.0f);
+    CONSTEXPR_VALUE vec3 b(4.0f, 5.0f, 6.0f);
+    CONSTEXPR_CHECK(LibMatrix::vec3::dot(a, b) == 32.0f);
+    CONSTEXPR_VALUE vec3 c(LibMatrix::vec3::cross(a, b));
+    CONSTEXPR_CHECK(c.x() == -3.0f && c.y() == 6.0f && c.z() == -3.0f);
+    CONSTEXPR_VALUE vec4 d(2.0f * vec4(1.0f, 2.0f, 3.0f, 4.0f) - vec4(1.0f));
+    CONSTEXPR_CHECK(d.x() == 1.0f && d.y() == 3.0f && d.z() == 5.0f && d.w() == 7.0f);
+    CONSTEXPR_CHECK(LibMatrix::vec4::dot(d, d) == 84.0f);
+
+    if (failed)
+    {
+        if (options.beVerbose())
+        {
+            cout << "Failed: " << failed << endl;
+        }
+        return;
+    }
+
+    pass_ = true;
+}
+
+void
+ConstexprTestMatrix::run(const Options& options)
+{
+    const char* failed(0);
+
+    CONSTEXPR_VALUE mat4 identity;
+    CONSTEXPR_CHECK(trace(identity) == 4.0f);
+    CONSTEXPR_CHECK(identity == mat4().transpose());
+
+    CONSTEXPR_VALUE mat4 t(LibMatrix::Mat4::translate(1.0f, 2.0f, 3.0f));
+    CONSTEXPR_CHECK(t[0][3] == 1.0f && t[1][3] == 2.0f && t[2][3] == 3.0f);
+    CONSTEXPR_VALUE mat4 tt(mat4(t).transpose());
+    CONSTEXPR_CHECK(tt[3][0] == 1.0f && tt[3][1] == 2.0f && tt[3][2] == 3.0f);
+
+    CONSTEXPR_VALUE mat4 s(LibMatrix::Mat4::scale(2.0f, 4.0f, 8.0f));
+    CONSTEXPR_CHECK(trace(s) == 15.0f);
+
+    CONSTEXPR_VALUE mat4 o(LibMatrix::Mat4::ortho(-2.0f, 2.0f, -1.0f, 1.0f, 1.0f, 3.0f));
+    CONSTEXPR_CHECK(o[0][0] == 0.5f && o[1][1] == 1.0f && o[2][2] == -1.0f &&
+                    o[2][3] == 2.0f && o[3][3] == 1.0f);
+
+    CONSTEXPR_VALUE mat3 m3(1.0f, 2.0f, 3.0f,
+                            0.0f, 1.0f, 4.0f,
+                            5.0f, 6.0f, 0.0f);
+    CONSTEXPR_CHECK(m3.determinant() == 1.0f);
+
+    // The 4x4 product is only a constant expression where the compiler lets
+    // it step around the vector kernel.
+#if defined(LIBMATRIX_HAVE_CONSTANT_EVALUATED)
+    constexpr mat4 ts(t * s);
+    static_assert(ts[0][0] == 2.0f && ts[0][3] == 1.0f && ts[2][2] == 8.0f &&
+                  ts[2][3] == 3.0f, "t * s");
+#else
+    const mat4 ts(t * s);
+#endif
+
+    if (failed)
+    {
+        if (options.beVerbose())
+        {
+            cout << "Failed: " << failed << endl;
+        }
+        return;
+    }
+
+    // Whatever was computed at compile time has to match the run-time code
+    // exactly.
+    mat4 runtime(LibMatrix::Mat4::translate(1.0f, 2.0f, 3.0f));
+    runtime *= LibMatrix::Mat4::scale(2.0f, 4.0f, 8.0f);
+    if (runtime != ts)
+    {
+        if (options.beVerbose())
+        {
+            cout << "Compile time product differs from run time product." << endl;
+        }
+        return;
+    }
+
+    pass_ = true;
+}
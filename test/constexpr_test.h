@@ -0,0 +1,32 @@
+//
+// Copyright (c) 2013 Linaro Limited
+//
+// All rights reserved. This program and the accompanying materials
+// are made available under the terms of the MIT License which accompanies
+// this distribution, and is available at
+// http://www.opensource.org/licenses/mit-license.php
+//
+// Contributors:
+//     Jesse Barker - original implementation.
+//
+#ifndef CONSTEXPR_TEST_H_
+#define CONSTEXPR_TEST_H_
+
+class MatrixTest;
+class Options;
+
+class ConstexprTestVector : public MatrixTest
+{
+public:
+    ConstexprTestVector() : MatrixTest("constexpr::vector") {}
+    virtual void run(const Options& options);
+};
+
+class ConstexprTestMatrix : public MatrixTest
+{
+public:
+    ConstexprTestMatrix() : MatrixTest("constexpr::matrix") {}
+    virtual void run(const Options& options);
+};
+
+#endif // CONSTEXPR_TEST_H_
@@ -0,0 +1,136 @@
+//
+// Copyright (c) 2013 Linaro Limited
+//
+// All rights reserved. This program and the accompanying materials
+// are made available under the terms of the MIT License which accompanies
+// this distribution, and is available at
+// http://www.opensource.org/licenses/mit-license.php
+//
+// Contributors:
+//     Jesse Barker - original implementation.
+//
+#include <sstream>
+#include <vector>
+#include "libmatrix_test.h"
+#include "libmatrix_bench.h"
+#include "copy_bench.h"
+#include "../mat.h"
+
+using LibMatrix::mat4;
+using std::vector;
+
+namespace
+{
+
+const unsigned int minItems(1 << 20);
+
+unsigned int
+passes(unsigned int count)
+{
+    return (minItems + count - 1) / count;
+}
+
+// A mat4 with the user-provided copy constructor and assignment operator
+// that mat4 used to have, which make it non-trivially copyable.
+class CopyingMat4 : public mat4
+{
+public:
+    CopyingMat4() {}
+    CopyingMat4(const CopyingMat4& m) :
+        mat4()
+    {
+        copy(m);
+    }
+    CopyingMat4& operator=(const CopyingMat4& rhs)
+    {
+        if (this != &rhs)
+        {
+            copy(rhs);
+        }
+        return *this;
+    }
+private:
+    void copy(const mat4& m)
+    {
+        const float* in(m);
+        float* out(data());
+        for (unsigned int i = 0; i < 16; i++)
+        {
+            out[i] = in[i];
+        }
+    }
+};
+
+// Growing a vector to 'count' elements one push_back() at a time,
+// passes(count) times over.
+template<typename M>
+class Growth
+{
+public:
+    Growth(unsigned int count) :
+        count_(count) {}
+    void operator()()
+    {
+        for (unsigned int pass = 0; pass < passes(count_); pass++)
+        {
+            vector<M> v;
+            for (unsigned int i = 0; i < count_; i++)
+            {
+                v.push_back(m_);
+            }
+        }
+    }
+private:
+    M m_;
+    unsigned int count_;
+};
+
+// The same for assigning one vector of 'count' elements to another.
+template<typename M>
+class Copy
+{
+public:
+    Copy(unsigned int count) :
+        src_(count), dst_(count) {}
+    void operator()()
+    {
+        const unsigned int count(src_.size());
+        for (unsigned int pass = 0; pass < passes(count); pass++)
+        {
+            dst_ = src_;
+            src_[pass % count] = dst_[0];
+        }
+    }
+private:
+    vector<M> src_;
+    vector<M> dst_;
+};
+
+template<typename Op>
+uint64_t
+timeOp(unsigned int count)
+{
+    Op op(count);
+    return MatrixBench::fastest(op);
+}
+
+} // namespace
+
+void
+CopyBenchVector::run(const Options&)
+{
+    static const unsigned int sizes[] = { 1024, 65536 };
+    for (unsigned int s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++)
+    {
+        unsigned int count(sizes[s]);
+        unsigned int items(count * passes(count));
+        std::stringstream ss;
+        ss << count << " matrices, ";
+        std::string prefix(ss.str());
+
+        report(prefix + "push_back (mat4)", timeOp<Growth<mat4> >(count), items);
+        report(prefix + "push_back (non-trivial)", timeOp<Growth<CopyingMat4> >(count), items);
+        report(prefix + "assignment (mat4)", timeOp<Copy<mat4> >(count), items);
+        report(prefix + "assignment (non-trivial)", timeOp<Copy<CopyingMat4> >(count), items);
+    }
+}
@@ -0,0 +1,25 @@
+//
+// Copyright (c) 2013 Linaro Limited
+//
+// All rights reserved. This program and the accompanying materials
+// are made available under the terms of the MIT License which accompanies
+// this distribution, and is available at
+// http://www.opensource.org/licenses/mit-license.php
+//
+// Contributors:
+//     Jesse Barker - original implementation.
+//
+#ifndef COPY_BENCH_H_
+#define COPY_BENCH_H_
+
+class MatrixBench;
+class Options;
+
+class CopyBenchVector : public MatrixBench
+{
+public:
+    CopyBenchVector() : MatrixBench("std::vector<mat4> growth and copies") {}
+    virtual void run(const Options& options);
+};
+
+#endif // COPY_BENCH_H_
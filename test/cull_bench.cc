@@ -0,0 +1,176 @@
+//
+// Copyright (c) 2013 Linaro Limited
+//
+// All rights reserved. This program and the accompanying materials
+// are made available under the terms of the MIT License which accompanies
+// this distribution, and is available at
+// http://www.opensource.org/licenses/mit-license.php
+//
+// Contributors:
+//     Jesse Barker - original implementation.
+//
+#include <string>
+#include <vector>
+#include "libmatrix_test.h"
+#include "libmatrix_bench.h"
+#include "cull_bench.h"
+#include "../cull.h"
+
+using LibMatrix::frustum;
+using LibMatrix::vec3;
+using LibMatrix::vec4;
+using std::vector;
+
+namespace
+{
+
+const unsigned int count(100000);
+const unsigned int numPasses(16);
+
+// A scene of objects scattered around a camera at the origin, about a third
+// of them in view.
+struct CullWork
+{
+    CullWork() :
+        view(LibMatrix::Mat4::perspective(60.0f, 1.5f, 0.1f, 1000.0f) *
+             LibMatrix::Mat4::lookAt(0.0f, 0.0f, 0.0f, 0.3f, 0.1f, -1.0f, 0.0f, 1.0f, 0.0f)),
+        centers(count), radii(count), mins(count), maxs(count),
+        spheres(count), boxMin(count), boxMax(count),
+        visible((count + 31) / 32), flags(count), indices(count), pool(0)
+    {
+        unsigned int seed(1);
+        for (unsigned int i = 0; i < count; i++)
+        {
+            float v[4];
+            for (unsigned int j = 0; j < 4; j++)
+            {
+                seed = seed * 1103515245 + 12345;
+                v[j] = static_cast<float>((seed >> 8) % 20000) / 10.0f - 1000.0f;
+            }
+            centers[i] = vec3(v[0], v[1] / 4.0f, v[2]);
+            radii[i] = 1.0f + static_cast<float>(i % 16);
+            mins[i] = centers[i] - vec3(radii[i], radii[i], radii[i]);
+            maxs[i] = centers[i] + vec3(radii[i], radii[i], radii[i]);
+            spheres.set(i, vec4(centers[i].x(), centers[i].y(), centers[i].z(), radii[i]));
+            boxMin.set(i, mins[i]);
+            boxMax.set(i, maxs[i]);
+        }
+    }
+    frustum view;
+    vector<vec3> centers;
+    vector<float> radii;
+    vector<vec3> mins;
+    vector<vec3> maxs;
+    LibMatrix::vec4_soa spheres;
+    LibMatrix::vec3_soa boxMin;
+    LibMatrix::vec3_soa boxMax;
+    vector<uint32_t> visible;
+    vector<unsigned char> flags;
+    vector<unsigned int> indices;
+    LibMatrix::ThreadPool pool;
+};
+
+struct LoopSpheres
+{
+    static OUT_OF_LINE void run(CullWork& w)
+    {
+        for (unsigned int i = 0; i < count; i++)
+        {
+            w.flags[i] = w.view.intersects(w.centers[i], w.radii[i]);
+        }
+    }
+};
+
+struct BatchSpheres
+{
+    static OUT_OF_LINE void run(CullWork& w)
+    {
+        LibMatrix::Batch::cullSpheres(&w.visible[0], w.view, w.spheres);
+    }
+};
+
+struct ParallelSpheres
+{
+    static OUT_OF_LINE void run(CullWork& w)
+    {
+        LibMatrix::Batch::cullSpheres(w.pool, &w.visible[0], w.view, w.spheres);
+    }
+};
+
+struct BatchSpheresCompact
+{
+    static OUT_OF_LINE void run(CullWork& w)
+    {
+        LibMatrix::Batch::cullSpheres(&w.visible[0], w.view, w.spheres);
+        LibMatrix::Batch::compact(&w.indices[0], &w.visible[0], count);
+    }
+};
+
+struct LoopBoxes
+{
+    static OUT_OF_LINE void run(CullWork& w)
+    {
+        for (unsigned int i = 0; i < count; i++)
+        {
+            w.flags[i] = w.view.intersects(w.mins[i], w.maxs[i]);
+        }
+    }
+};
+
+struct BatchBoxes
+{
+    static OUT_OF_LINE void run(CullWork& w)
+    {
+        LibMatrix::Batch::cullBoxes(&w.visible[0], w.view, w.boxMin, w.boxMax);
+    }
+};
+
+struct ParallelBoxes
+{
+    static OUT_OF_LINE void run(CullWork& w)
+    {
+        LibMatrix::Batch::cullBoxes(w.pool, &w.visible[0], w.view, w.boxMin, w.boxMax);
+    }
+};
+
+// Runs Op numPasses times.
+template<typename Op>
+class Passes
+{
+public:
+    Passes(CullWork& w) :
+        w_(w) {}
+    void operator()()
+    {
+        for (unsigned int pass = 0; pass < numPasses; pass++)
+        {
+            Op::run(w_);
+        }
+    }
+private:
+    CullWork& w_;
+};
+
+template<typename Op>
+uint64_t
+timeOp(CullWork& w)
+{
+    Passes<Op> op(w);
+    return MatrixBench::fastest(op);
+}
+
+} // namespace
+
+void
+CullBench::run(const Options&)
+{
+    CullWork w;
+    unsigned int items(count * numPasses);
+    report("frustum::intersects (spheres)", timeOp<LoopSpheres>(w), items);
+    report("Batch::cullSpheres", timeOp<BatchSpheres>(w), items);
+    report("Batch::cullSpheres + compact", timeOp<BatchSpheresCompact>(w), items);
+    report("Batch::cullSpheres (threaded)", timeOp<ParallelSpheres>(w), items);
+    report("frustum::intersects (boxes)", timeOp<LoopBoxes>(w), items);
+    report("Batch::cullBoxes", timeOp<BatchBoxes>(w), items);
+    report("Batch::cullBoxes (threaded)", timeOp<ParallelBoxes>(w), items);
+}
@@ -0,0 +1,233 @@
+//
+// Copyright (c) 2013 Linaro Limited
+//
+// All rights reserved. This program and the accompanying materials
+// are made available under the terms of the MIT License which accompanies
+// this distribution, and is available at
+// http://www.opensource.org/licenses/mit-license.php
+//
+// Contributors:
+//     Jesse Barker - original implementation.
+//
+#include <iostream>
+#include <vector>
+#include <math.h>
+#include "libmatrix_test.h"
+#include "cull_test.h"
+#include "../cull.h"
+
+using LibMatrix::mat4;
+using LibMatrix::tmat4;
+using LibMatrix::tvec3;
+using LibMatrix::tvec3_soa;
+using LibMatrix::tvec4_soa;
+using LibMatrix::tfrustum;
+using LibMatrix::frustum;
+using LibMatrix::vec3;
+using std::cout;
+using std::endl;
+using std::vector;
+
+// A camera at (0, 0, 5) looking down -z with a 90 degree field of view,
+// so the side planes are at 45 degrees.
+static mat4
+viewProjection()
+{
+    return LibMatrix::Mat4::perspective(90.0f, 1.0f, 1.0f, 100.0f) *
+           LibMatrix::Mat4::lookAt(0.0f, 0.0f, 5.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f);
+}
+
+void
+CullTestPlanes::run(const Options& options)
+{
+    frustum f(viewProjection());
+    const float tolerance(1.0e-5f);
+    // Unit normals, all pointing into the volume, i.e. towards a point on
+    // the view axis in the middle of it.
+    const vec3 inside(0.0f, 0.0f, -45.0f);
+    for (unsigned int p = 0; p < frustum::NumPlanes; p++)
+    {
+        const LibMatrix::vec4& e(f.plane(p));
+        float l(sqrtf(e.x() * e.x() + e.y() * e.y() + e.z() * e.z()));
+        if (fabsf(l - 1.0f) > tolerance || frustum::distance(e, inside) <= 0.0f)
+        {
+            if (options.beVerbose())
+            {
+                cout << "Plane " << p << " is not a unit plane facing inwards." << endl;
+            }
+            return;
+        }
+    }
+
+    // The near and far planes are 1 and 100 in front of the camera (the far
+    // one less precisely, as the depth range is squeezed towards it), and a
+    // point 10 in front of it and 10 to the side is on the side planes.
+    if (fabsf(frustum::distance(f.plane(frustum::Near), vec3(0.0f, 0.0f, 4.0f))) > tolerance ||
+        fabsf(frustum::distance(f.plane(frustum::Far), vec3(3.0f, 2.0f, -95.0f))) > 1.0e-3f ||
+        fabsf(frustum::distance(f.plane(frustum::Left), vec3(-10.0f, 0.0f, -5.0f))) > tolerance ||
+        fabsf(frustum::distance(f.plane(frustum::Right), vec3(10.0f, 0.0f, -5.0f))) > tolerance ||
+        fabsf(frustum::distance(f.plane(frustum::Bottom), vec3(0.0f, -10.0f, -5.0f))) > tolerance ||
+        fabsf(frustum::distance(f.plane(frustum::Top), vec3(0.0f, 10.0f, -5.0f))) > tolerance)
+    {
+        if (options.beVerbose())
+        {
+            cout << "The planes are in the wrong places." << endl;
+        }
+        return;
+    }
+
+    // A sphere just behind the camera, one straddling the near plane, and
+    // boxes either side of the right plane.
+    if (f.intersects(vec3(0.0f, 0.0f, 5.5f), 0.4f) ||
+        !f.intersects(vec3(0.0f, 0.0f, 5.5f), 2.0f) ||
+        f.intersects(vec3(12.0f, -1.0f, -6.0f), vec3(13.0f, 1.0f, -4.0f)) ||
+        !f.intersects(vec3(9.0f, -1.0f, -6.0f), vec3(12.0f, 1.0f, -4.0f)))
+    {
+        if (options.beVerbose())
+        {
+            cout << "A sphere or box was culled wrongly." << endl;
+        }
+        return;
+    }
+
+    pass_ = true;
+}
+
+// Return the smallest margin, computed in double precision, by which the
+// sphere or box is inside any one plane of 'f'.  Objects whose margin is
+// too close to zero are skipped when comparing the batch results with the
+// member functions, as contraction into fused multiply-adds may change
+// which side of zero either one lands on.
+template<typename T>
+static double
+margin(const tfrustum<T>& f, const tvec3<T>& c, const tvec3<T>& e)
+{
+    double m(0.0);
+    for (unsigned int p = 0; p < tfrustum<T>::NumPlanes; p++)
+    {
+        const T* n(f.plane(p));
+        double d(static_cast<double>(n[0]) * c.x() + static_cast<double>(n[1]) * c.y() +
+                 static_cast<double>(n[2]) * c.z() + n[3] +
+                 fabs(n[0]) * e.x() + fabs(n[1]) * e.y() + fabs(n[2]) * e.z());
+        m = p ? fmin(m, d) : d;
+    }
+    return m;
+}
+
+template<typename T>
+static bool
+checkBatch(const Options& options)
+{
+    tmat4<T> m;
+    const mat4 vp(viewProjection());
+    const float* src(vp);
+    for (unsigned int e = 0; e < 16; e++)
+    {
+        m.data()[e] = src[e];
+    }
+    tfrustum<T> f(m);
+
+    // Not a multiple of 32, to cover the partly used last word of the mask.
+    static const unsigned int count(3001);
+    tvec4_soa<T> spheres(count);
+    tvec3_soa<T> min(count);
+    tvec3_soa<T> max(count);
+    unsigned int seed(7);
+    for (unsigned int i = 0; i < count; i++)
+    {
+        T v[7];
+        for (unsigned int j = 0; j < 7; j++)
+        {
+            seed = seed * 1103515245 + 12345;
+            v[j] = static_cast<T>((seed >> 8) % 20000) / 100 - 100;
+        }
+        T r(static_cast<T>(fabs(v[3]) / 20));
+        spheres.set(i, LibMatrix::tvec4<T>(v[0], v[1], v[2], r));
+        min.set(i, tvec3<T>(v[0], v[1], v[2]));
+        max.set(i, tvec3<T>(v[0] + fabs(v[4]) / 10, v[1] + fabs(v[5]) / 10, v[2] + fabs(v[6]) / 10));
+    }
+
+    const unsigned int words((count + 31) / 32);
+    vector<uint32_t> sphereMask(words, ~0u);
+    vector<uint32_t> boxMask(words, ~0u);
+    LibMatrix::Batch::cullSpheres(&sphereMask[0], f, spheres);
+    LibMatrix::Batch::cullBoxes(&boxMask[0], f, min, max);
+    if ((sphereMask[words - 1] >> (count % 32)) || (boxMask[words - 1] >> (count % 32)))
+    {
+        if (options.beVerbose())
+        {
+            cout << "Bits past the end of the mask are set." << endl;
+        }
+        return false;
+    }
+
+    // Grains that are not multiples of 32, including 0 and one too large
+    // to round up.
+    LibMatrix::ThreadPool pool(3);
+    const unsigned int grains[] = { 100, 0, 1, 33, 0xffffffffu };
+    for (unsigned int g = 0; g < sizeof(grains) / sizeof(grains[0]); g++)
+    {
+        vector<uint32_t> sphereMaskMT(words, ~0u);
+        vector<uint32_t> boxMaskMT(words, ~0u);
+        LibMatrix::Batch::cullSpheres(pool, &sphereMaskMT[0], f, spheres, grains[g]);
+        LibMatrix::Batch::cullBoxes(pool, &boxMaskMT[0], f, min, max, grains[g]);
+        if (sphereMask != sphereMaskMT || boxMask != boxMaskMT)
+        {
+            if (options.beVerbose())
+            {
+                cout << "The parallel masks with a grain of " << grains[g]
+                     << " differ from the serial ones." << endl;
+            }
+            return false;
+        }
+    }
+
+    vector<unsigned int> indices(count);
+    unsigned int numVisible(LibMatrix::Batch::compact(&indices[0], &boxMask[0], count));
+    unsigned int next(0);
+    unsigned int numSpheres(0);
+    for (unsigned int i = 0; i < count; i++)
+    {
+        const tvec3<T> c(spheres.x()[i], spheres.y()[i], spheres.z()[i]);
+        const T r(spheres.w()[i]);
+        const tvec3<T> lo(min.get(i));
+        const tvec3<T> hi(max.get(i));
+        bool sphereVisible((sphereMask[i / 32] >> (i % 32)) & 1);
+        bool boxVisible((boxMask[i / 32] >> (i % 32)) & 1);
+        numSpheres += sphereVisible;
+        const T half(static_cast<T>(0.5));
+        double sphereMargin(margin(f, c, tvec3<T>(0, 0, 0)) + r);
+        double boxMargin(margin(f, (lo + hi) * half, (hi - lo) * half));
+        if ((fabs(sphereMargin) > 1.0e-3 && sphereVisible != f.intersects(c, r)) ||
+            (fabs(boxMargin) > 1.0e-3 && boxVisible != f.intersects(lo, hi)) ||
+            (boxVisible && (next >= numVisible || indices[next++] != i)))
+        {
+            if (options.beVerbose())
+            {
+                cout << "Object " << i << " was culled wrongly." << endl;
+            }
+            return false;
+        }
+    }
+    if (next != numVisible)
+    {
+        if (options.beVerbose())
+        {
+            cout << "compact() returned too many indices." << endl;
+        }
+        return false;
+    }
+
+    if (options.beVerbose())
+    {
+        cout << numSpheres << " spheres and " << numVisible << " boxes of " << count
+             << " are visible." << endl;
+    }
+    return true;
+}
+
+void
+CullTestBatch::run(const Options& options)
+{
+    pass_ = checkBatch<float>(options) && checkBatch<double>(options);
+}
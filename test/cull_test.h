@@ -0,0 +1,32 @@
+//
+// Copyright (c) 2013 Linaro Limited
+//
+// All rights reserved. This program and the accompanying materials
+// are made available under the terms of the MIT License which accompanies
+// this distribution, and is available at
+// http://www.opensource.org/licenses/mit-license.php
+//
+// Contributors:
+//     Jesse Barker - original implementation.
+//
+#ifndef CULL_TEST_H_
+#define CULL_TEST_H_
+
+class MatrixTest;
+class Options;
+
+class CullTestPlanes : public MatrixTest
+{
+public:
+    CullTestPlanes() : MatrixTest("Frustum plane extraction") {}
+    virtual void run(const Options& options);
+};
+
+class CullTestBatch : public MatrixTest
+{
+public:
+    CullTestBatch() : MatrixTest("Batch::cullSpheres/cullBoxes") {}
+    virtual void run(const Options& options);
+};
+
+#endif // CULL_TEST_H_
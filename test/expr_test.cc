@@ -0,0 +1,192 @@
+//
+// Copyright (c) 2013 Linaro Limited
+//
+// All rights reserved. This program and the accompanying materials
+// are made available under the terms of the MIT License which accompanies
+// this distribution, and is available at
+// http://www.opensource.org/licenses/mit-license.php
+//
+// Contributors:
+//     Jesse Barker - original implementation.
+//
+#include <iostream>
+#include "libmatrix_test.h"
+#include "expr_test.h"
+#include "../expr.h"
+
+using LibMatrix::vec2;
+using LibMatrix::vec3;
+using LibMatrix::vec4;
+using LibMatrix::mat3;
+using LibMatrix::mat4;
+using LibMatrix::dmat4;
+using LibMatrix::lazy;
+using LibMatrix::assign;
+using std::cout;
+using std::endl;
+
+// Small integral values, so that the lazy and the eager results can be
+// compared exactly.
+template<typename M>
+static M
+pattern(unsigned int seed)
+{
+    M m;
+    for (unsigned int r = 0; r < 4; r++)
+    {
+        for (unsigned int c = 0; c < 4; c++)
+        {
+            seed = seed * 1103515245 + 12345;
+            m[r][c] = static_cast<int>((seed >> 16) % 9) - 4;
+        }
+    }
+    return m;
+}
+
+// The vectors have no comparison operators, so compare the elements.
+template<typename T, typename V>
+static bool
+same(const V& a, const V& b, unsigned int size)
+{
+    const T* pa(a);
+    const T* pb(b);
+    for (unsigned int i = 0; i < size; i++)
+    {
+        if (pa[i] != pb[i])
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+void
+ExprTestVector::run(const Options& options)
+{
+    const vec3 a(1.0f, 2.0f, 3.0f);
+    const vec3 b(-2.0f, 0.5f, 4.0f);
+    const vec3 c(3.0f, 3.0f, -1.0f);
+    const vec3 d(0.25f, -8.0f, 2.0f);
+    const vec3 e(7.0f, 1.0f, 0.0f);
+
+    vec3 r(lazy(a) * b + lazy(c) * d - e);
+    if (!same<float>(r, a * b + c * d - e, 3))
+    {
+        if (options.beVerbose())
+        {
+            cout << "a * b + c * d - e differs from the eager result." << endl;
+        }
+        return;
+    }
+
+    // Scalars on either side, division, negation, and plain operands on
+    // the left.
+    r = 2.0f * lazy(a) - b / lazy(d) + -lazy(c) * 0.5f + e / 4.0f;
+    if (!same<float>(r, 2.0f * a - b / d + c * -0.5f + e / 4.0f, 3))
+    {
+        if (options.beVerbose())
+        {
+            cout << "Scalar and quotient expression differs from the eager result." << endl;
+        }
+        return;
+    }
+
+    // In-place evaluation that reads the destination.
+    vec4 v(1.0f, 2.0f, 3.0f, 4.0f);
+    const vec4 w(0.5f, 0.5f, 2.0f, -1.0f);
+    vec4 expected(v * w + v);
+    assign(v, lazy(v) * w + v);
+    if (!same<float>(v, expected, 4))
+    {
+        if (options.beVerbose())
+        {
+            cout << "assign() differs from the eager result." << endl;
+        }
+        return;
+    }
+
+    vec2 p(lazy(vec2(1.0f, 2.0f)) + vec2(3.0f, 4.0f));
+    if (!same<float>(p, vec2(4.0f, 6.0f), 2))
+    {
+        return;
+    }
+
+    pass_ = true;
+}
+
+template<typename M, typename V>
+static bool
+checkMatrix(const Options& options)
+{
+    const M a(pattern<M>(1));
+    const M b(pattern<M>(2));
+    const M c(pattern<M>(3));
+    const M d(pattern<M>(4));
+    const M e(pattern<M>(5));
+
+    M r(lazy(a) * b + lazy(c) * d - e);
+    if (r != a * b + c * d - e)
+    {
+        if (options.beVerbose())
+        {
+            cout << "a * b + c * d - e differs from the eager result." << endl;
+        }
+        return false;
+    }
+
+    r = 3.0 * lazy(a) - b * 2.0 + a * (lazy(b) - c);
+    if (r != a * 3.0 - b * 2.0 + a * (b - c))
+    {
+        if (options.beVerbose())
+        {
+            cout << "Scalar and nested expression differs from the eager result." << endl;
+        }
+        return false;
+    }
+
+    // The product reads other elements of the destination.
+    M m(a);
+    assign(m, lazy(m) * b + c);
+    if (m != a * b + c)
+    {
+        if (options.beVerbose())
+        {
+            cout << "assign() of a product differs from the eager result." << endl;
+        }
+        return false;
+    }
+
+    const V v(1.0, -2.0, 3.0, 0.5);
+    V u(lazy(a) * v + lazy(v) * b);
+    if (!same<typename LibMatrix::Expr::Traits<V>::Element>(u, V(a * v + v * b), 4))
+    {
+        if (options.beVerbose())
+        {
+            cout << "Matrix-vector products differ from the eager result." << endl;
+        }
+        return false;
+    }
+
+    return true;
+}
+
+void
+ExprTestMatrix::run(const Options& options)
+{
+    if (!checkMatrix<mat4, vec4>(options) ||
+        !checkMatrix<dmat4, LibMatrix::dvec4>(options))
+    {
+        return;
+    }
+
+    const mat3 a(1.0f, 2.0f, 3.0f,
+                 0.0f, 1.0f, 4.0f,
+                 5.0f, 6.0f, 0.0f);
+    mat3 r(lazy(a) * a - a);
+    if (r != a * a - a)
+    {
+        return;
+    }
+
+    pass_ = true;
+}
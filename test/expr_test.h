@@ -0,0 +1,32 @@
+//
+// Copyright (c) 2013 Linaro Limited
+//
+// All rights reserved. This program and the accompanying materials
+// are made available under the terms of the MIT License which accompanies
+// this distribution, and is available at
+// http://www.opensource.org/licenses/mit-license.php
+//
+// Contributors:
+//     Jesse Barker - original implementation.
+//
+#ifndef EXPR_TEST_H_
+#define EXPR_TEST_H_
+
+class MatrixTest;
+class Options;
+
+class ExprTestVector : public MatrixTest
+{
+public:
+    ExprTestVector() : MatrixTest("lazy (vector)") {}
+    virtual void run(const Options& options);
+};
+
+class ExprTestMatrix : public MatrixTest
+{
+public:
+    ExprTestMatrix() : MatrixTest("lazy (matrix)") {}
+    virtual void run(const Options& options);
+};
+
+#endif // EXPR_TEST_H_
@@ -0,0 +1,192 @@
+//
+// Copyright (c) 2013 Linaro Limited
+//
+// All rights reserved. This program and the accompanying materials
+// are made available under the terms of the MIT License which accompanies
+// this distribution, and is available at
+// http://www.opensource.org/licenses/mit-license.php
+//
+// Contributors:
+//     Jesse Barker - original implementation.
+//
+#include <string>
+#include <vector>
+#include <math.h>
+#include "libmatrix_test.h"
+#include "libmatrix_bench.h"
+#include "fastmath_bench.h"
+#include "../fastmath.h"
+#include "../mat.h"
+
+using LibMatrix::mat4;
+using LibMatrix::vec3;
+using std::vector;
+
+namespace
+{
+
+const unsigned int count(1024);
+const unsigned int numPasses(2048);
+
+// Inputs and outputs for the operations being timed.
+struct Work
+{
+    Work() :
+        angles(count), vectors(count), sines(count), cosines(count), matrices(count),
+        normalized(count)
+    {
+        for (unsigned int i = 0; i < count; i++)
+        {
+            angles[i] = static_cast<float>(i % 360) + 0.5f;
+            vectors[i] = vec3(1.0f + i, 2.0f, -static_cast<float>(i % 17));
+        }
+    }
+    vector<float> angles;
+    vector<vec3> vectors;
+    vector<float> sines;
+    vector<float> cosines;
+    vector<mat4> matrices;
+    vector<vec3> normalized;
+};
+
+struct PreciseSinCos
+{
+    static OUT_OF_LINE void run(Work& w, float offset)
+    {
+        for (unsigned int i = 0; i < count; i++)
+        {
+            double radians((w.angles[i] + offset) * M_PI / 180.0);
+            w.sines[i] = sin(radians);
+            w.cosines[i] = cos(radians);
+        }
+    }
+};
+
+struct FastSinCos
+{
+    static OUT_OF_LINE void run(Work& w, float offset)
+    {
+        for (unsigned int i = 0; i < count; i++)
+        {
+            LibMatrix::FastMath::sincos((w.angles[i] + offset) * static_cast<float>(M_PI / 180.0),
+                                        w.sines[i], w.cosines[i]);
+        }
+    }
+};
+
+struct PreciseRotate
+{
+    static OUT_OF_LINE void run(Work& w, float offset)
+    {
+        for (unsigned int i = 0; i < count; i++)
+        {
+            const vec3& v(w.vectors[i]);
+            w.matrices[i] = LibMatrix::Mat4::rotate(w.angles[i] + offset, v.x(), v.y(), v.z());
+        }
+    }
+};
+
+struct FastRotate
+{
+    static OUT_OF_LINE void run(Work& w, float offset)
+    {
+        for (unsigned int i = 0; i < count; i++)
+        {
+            const vec3& v(w.vectors[i]);
+            w.matrices[i] = LibMatrix::Mat4::rotate(w.angles[i] + offset, v.x(), v.y(), v.z(),
+                                                    LibMatrix::fast);
+        }
+    }
+};
+
+struct PrecisePerspective
+{
+    static OUT_OF_LINE void run(Work& w, float offset)
+    {
+        for (unsigned int i = 0; i < count; i++)
+        {
+            w.matrices[i] = LibMatrix::Mat4::perspective(w.angles[i] / 2 + offset, 1.5f, 0.1f, 100.0f);
+        }
+    }
+};
+
+struct FastPerspective
+{
+    static OUT_OF_LINE void run(Work& w, float offset)
+    {
+        for (unsigned int i = 0; i < count; i++)
+        {
+            w.matrices[i] = LibMatrix::Mat4::perspective(w.angles[i] / 2 + offset, 1.5f, 0.1f, 100.0f,
+                                                         LibMatrix::fast);
+        }
+    }
+};
+
+struct PreciseNormalize
+{
+    static OUT_OF_LINE void run(Work& w, float offset)
+    {
+        for (unsigned int i = 0; i < count; i++)
+        {
+            vec3 v(w.vectors[i] + offset);
+            v.normalize();
+            w.normalized[i] = v;
+        }
+    }
+};
+
+struct FastNormalize
+{
+    static OUT_OF_LINE void run(Work& w, float offset)
+    {
+        for (unsigned int i = 0; i < count; i++)
+        {
+            vec3 v(w.vectors[i] + offset);
+            v.normalize(LibMatrix::fast);
+            w.normalized[i] = v;
+        }
+    }
+};
+
+// Runs Op numPasses times, with offsets that change from pass to pass.
+template<typename Op>
+class Passes
+{
+public:
+    Passes(Work& w) :
+        w_(w) {}
+    void operator()()
+    {
+        for (unsigned int pass = 0; pass < numPasses; pass++)
+        {
+            Op::run(w_, static_cast<float>(pass & 7));
+        }
+    }
+private:
+    Work& w_;
+};
+
+template<typename Op>
+uint64_t
+timeOp(Work& w)
+{
+    Passes<Op> op(w);
+    return MatrixBench::fastest(op);
+}
+
+} // namespace
+
+void
+FastMathBench::run(const Options&)
+{
+    Work w;
+    unsigned int items(count * numPasses);
+    report("sin + cos (double)", timeOp<PreciseSinCos>(w), items);
+    report("FastMath::sincos", timeOp<FastSinCos>(w), items);
+    report("Mat4::rotate", timeOp<PreciseRotate>(w), items);
+    report("Mat4::rotate (fast)", timeOp<FastRotate>(w), items);
+    report("Mat4::perspective", timeOp<PrecisePerspective>(w), items);
+    report("Mat4::perspective (fast)", timeOp<FastPerspective>(w), items);
+    report("vec3::normalize", timeOp<PreciseNormalize>(w), items);
+    report("vec3::normalize (fast)", timeOp<FastNormalize>(w), items);
+}
@@ -0,0 +1,25 @@
+//
+// Copyright (c) 2013 Linaro Limited
+//
+// All rights reserved. This program and the accompanying materials
+// are made available under the terms of the MIT License which accompanies
+// this distribution, and is available at
+// http://www.opensource.org/licenses/mit-license.php
+//
+// Contributors:
+//     Jesse Barker - original implementation.
+//
+#ifndef FASTMATH_BENCH_H_
+#define FASTMATH_BENCH_H_
+
+class MatrixBench;
+class Options;
+
+class FastMathBench : public MatrixBench
+{
+public:
+    FastMathBench() : MatrixBench("Precise vs fast math") {}
+    virtual void run(const Options& options);
+};
+
+#endif // FASTMATH_BENCH_H_
@@ -0,0 +1,168 @@
+//
+// Copyright (c) 2013 Linaro Limited
+//
+// All rights reserved. This program and the accompanying materials
+// are made available under the terms of the MIT License which accompanies
+// this distribution, and is available at
+// http://www.opensource.org/licenses/mit-license.php
+//
+// Contributors:
+//     Jesse Barker - original implementation.
+//
+#include <iostream>
+#include <math.h>
+#include <string.h>
+#include "libmatrix_test.h"
+#include "fastmath_test.h"
+#include "../fastmath.h"
+#include "../mat.h"
+
+using LibMatrix::mat4;
+using LibMatrix::vec3;
+using LibMatrix::dvec3;
+using std::cout;
+using std::endl;
+
+void
+FastMathTestKernels::run(const Options& options)
+{
+    // Sweep the documented ranges against the double precision library.
+    static const int numSamples(1 << 20);
+    double sinError(0.0);
+    double cosError(0.0);
+    double tanError(0.0);
+    for (int i = -numSamples; i <= numSamples; i++)
+    {
+        float x(i * (8192.0f / numSamples));
+        float s;
+        float c;
+        LibMatrix::FastMath::sincos(x, s, c);
+        sinError = fmax(sinError, fabs(s - sin(static_cast<double>(x))));
+        cosError = fmax(cosError, fabs(c - cos(static_cast<double>(x))));
+
+        float a(i * (1.5707f / numSamples));
+        if (a != 0.0f)
+        {
+            double t(tan(static_cast<double>(a)));
+            tanError = fmax(tanError, fabs((LibMatrix::FastMath::tan(a) - t) / t));
+        }
+    }
+
+    // Every 4099th float from the smallest normal to the largest.
+    double rsqrtError(0.0);
+    for (unsigned int bits = 0x00800000u; bits < 0x7f800000u; bits += 4099)
+    {
+        float x;
+        memcpy(&x, &bits, sizeof(x));
+        double r(1.0 / sqrt(static_cast<double>(x)));
+        rsqrtError = fmax(rsqrtError, fabs((LibMatrix::FastMath::rsqrt(x) - r) / r));
+    }
+
+    if (options.beVerbose())
+    {
+        cout << "Largest errors: sin " << sinError
+             << ", cos " << cosError
+             << ", tan (relative) " << tanError
+             << ", rsqrt (relative) " << rsqrtError << endl;
+    }
+    if (sinError > 1.0e-7 || cosError > 1.0e-7 || tanError > 2.0e-7 || rsqrtError > 3.0e-7)
+    {
+        return;
+    }
+
+    // Arguments beyond the range of the three-part reduction are clamped,
+    // and NaN and infinity give NaN, rather than overflowing the octant.
+    const float huge[] = { 3.0e9f, -1.0e20f, 3.4e38f };
+    for (unsigned int i = 0; i < sizeof(huge) / sizeof(huge[0]); i++)
+    {
+        float s;
+        float c;
+        float clampedS;
+        float clampedC;
+        LibMatrix::FastMath::sincos(huge[i], s, c);
+        LibMatrix::FastMath::sincos(huge[i] < 0.0f ? -131072.0f : 131072.0f, clampedS, clampedC);
+        // Not bit for bit, as the compiler may fold the clamped call without
+        // contracting to fused multiply-adds as the other does.
+        if (fabs(s - clampedS) > 1.0e-5f || fabs(c - clampedC) > 1.0e-5f ||
+            fabs(s * s + c * c - 1.0f) > 1.0e-5f)
+        {
+            if (options.beVerbose())
+            {
+                cout << "The sincos of " << huge[i] << " is " << s << ", " << c << endl;
+            }
+            return;
+        }
+    }
+    const float invalid[] = { NAN, INFINITY, -INFINITY };
+    for (unsigned int i = 0; i < sizeof(invalid) / sizeof(invalid[0]); i++)
+    {
+        float s;
+        float c;
+        LibMatrix::FastMath::sincos(invalid[i], s, c);
+        if (!isnan(s) || !isnan(c) || !isnan(LibMatrix::FastMath::tan(invalid[i])))
+        {
+            if (options.beVerbose())
+            {
+                cout << "The sincos or tan of " << invalid[i] << " is not NaN" << endl;
+            }
+            return;
+        }
+    }
+
+    pass_ = true;
+}
+
+void
+FastMathTestTransforms::run(const Options& options)
+{
+    float rotateError(0.0f);
+    for (int angle = -720; angle <= 720; angle += 15)
+    {
+        mat4 precise(LibMatrix::Mat4::rotate(angle, 1.0f, -2.0f, 0.5f));
+        mat4 fast(LibMatrix::Mat4::rotate(angle, 1.0f, -2.0f, 0.5f, LibMatrix::fast));
+        rotateError = fmax(rotateError, maxDifference(precise, fast));
+    }
+    // Angles accumulated far beyond the range of FastMath::sincos() are
+    // wrapped, rather than clamped.
+    const float huge[] = { 1.0e6f + 30.0f, -3.0e9f, 1.0e20f };
+    for (unsigned int i = 0; i < sizeof(huge) / sizeof(huge[0]); i++)
+    {
+        mat4 precise(LibMatrix::Mat4::rotate(fmodf(huge[i], 360.0f), 1.0f, -2.0f, 0.5f));
+        mat4 fast(LibMatrix::Mat4::rotate(huge[i], 1.0f, -2.0f, 0.5f, LibMatrix::fast));
+        rotateError = fmax(rotateError, maxDifference(precise, fast));
+    }
+
+    // The elements of a projection are large for narrow fields of view, so
+    // compare them relative to the precise ones.
+    float perspectiveError(0.0f);
+    for (int fovy = 1; fovy < 180; fovy += 7)
+    {
+        mat4 precise(LibMatrix::Mat4::perspective(fovy, 1.5f, 0.1f, 100.0f));
+        mat4 fast(LibMatrix::Mat4::perspective(fovy, 1.5f, 0.1f, 100.0f, LibMatrix::fast));
+        perspectiveError = fmax(perspectiveError, fabs(fast(1, 1) / precise(1, 1) - 1.0f));
+        perspectiveError = fmax(perspectiveError, fabs(fast(0, 0) / precise(0, 0) - 1.0f));
+        perspectiveError = fmax(perspectiveError, fabs(fast(2, 2) - precise(2, 2)));
+    }
+
+    vec3 v(3.0f, -4.0f, 12.0f);
+    v.normalize(LibMatrix::fast);
+    float normalizeError(fabs(v.x() - 3.0f / 13.0f));
+    normalizeError = fmax(normalizeError, fabs(v.y() + 4.0f / 13.0f));
+    normalizeError = fmax(normalizeError, fabs(v.z() - 12.0f / 13.0f));
+    dvec3 d(3.0, -4.0, 12.0);
+    d.normalize(LibMatrix::fast);
+    normalizeError = fmax(normalizeError, fabs(d.z() - 12.0 / 13.0));
+
+    if (options.beVerbose())
+    {
+        cout << "Largest differences from the precise versions: rotate " << rotateError
+             << ", perspective (relative) " << perspectiveError
+             << ", normalize " << normalizeError << endl;
+    }
+    if (rotateError > 2.0e-6f || perspectiveError > 1.0e-6f || normalizeError > 1.0e-6f)
+    {
+        return;
+    }
+
+    pass_ = true;
+}
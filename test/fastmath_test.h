@@ -0,0 +1,32 @@
+//
+// Copyright (c) 2013 Linaro Limited
+//
+// All rights reserved. This program and the accompanying materials
+// are made available under the terms of the MIT License which accompanies
+// this distribution, and is available at
+// http://www.opensource.org/licenses/mit-license.php
+//
+// Contributors:
+//     Jesse Barker - original implementation.
+//
+#ifndef FASTMATH_TEST_H_
+#define FASTMATH_TEST_H_
+
+class MatrixTest;
+class Options;
+
+class FastMathTestKernels : public MatrixTest
+{
+public:
+    FastMathTestKernels() : MatrixTest("FastMath error bounds") {}
+    virtual void run(const Options& options);
+};
+
+class FastMathTestTransforms : public MatrixTest
+{
+public:
+    FastMathTestTransforms() : MatrixTest("Fast rotate/perspective/normalize") {}
+    virtual void run(const Options& options);
+};
+
+#endif // FASTMATH_TEST_H_
@@ -0,0 +1,243 @@
+//
+// Copyright (c) 2013 Linaro Limited
+//
+// All rights reserved. This program and the accompanying materials
+// are made available under the terms of the MIT License which accompanies
+// this distribution, and is available at
+// http://www.opensource.org/licenses/mit-license.php
+//
+// Contributors:
+//     Jesse Barker - original implementation.
+//
+#include <math.h>
+#include <string>
+#include "libmatrix_test.h"
+#include "libmatrix_bench.h"
+#include "generator_bench.h"
+#include "../mat.h"
+
+using LibMatrix::mat3;
+using LibMatrix::mat4;
+using LibMatrix::vec3;
+
+namespace
+{
+
+const unsigned int numItems(1 << 20);
+
+//
+// The generators as they were, writing an identity matrix element by
+// element through operator[].  Those that are not inline in mat.h are kept
+// out of line here too, so that the comparison is fair.
+//
+
+namespace Proxy
+{
+
+mat4
+translate(float x, float y, float z)
+{
+    mat4 t;
+    t[0][3] = x;
+    t[1][3] = y;
+    t[2][3] = z;
+    return t;
+}
+
+mat4
+scale(float x, float y, float z)
+{
+    mat4 s;
+    s[0][0] = x;
+    s[1][1] = y;
+    s[2][2] = z;
+    return s;
+}
+
+OUT_OF_LINE mat4
+rotate(float angle, float x, float y, float z)
+{
+    vec3 u(x, y, z);
+    u.normalize();
+    mat3 uuT = outer(u, u);
+    mat3 s;
+    s[0][0] = 0;
+    s[0][1] = -u.z();
+    s[0][2] = u.y();
+    s[1][0] = u.z();
+    s[1][1] = 0;
+    s[1][2] = -u.x();
+    s[2][0] = -u.y();
+    s[2][1] = u.x();
+    s[2][2] = 0;
+    mat3 i;
+    i -= uuT;
+    float angleRadians(angle * M_PI / 180.0);
+    i *= cos(angleRadians);
+    s *= sin(angleRadians);
+    i += s;
+    mat3 m = uuT + i;
+    mat4 r;
+    r[0][0] = m[0][0];
+    r[0][1] = m[0][1];
+    r[0][2] = m[0][2];
+    r[1][0] = m[1][0];
+    r[1][1] = m[1][1];
+    r[1][2] = m[1][2];
+    r[2][0] = m[2][0];
+    r[2][1] = m[2][1];
+    r[2][2] = m[2][2];
+    return r;
+}
+
+mat4
+frustum(float left, float right, float bottom, float top, float near, float far)
+{
+    float twiceNear(2 * near);
+    float width(right - left);
+    float height(top - bottom);
+    float depth(far - near);
+    mat4 f;
+    f[0][0] = twiceNear / width;
+    f[0][2] = (right + left) / width;
+    f[1][1] = twiceNear / height;
+    f[1][2] = (top + bottom) / height;
+    f[2][2] = -(far + near) / depth;
+    f[2][3] = -(twiceNear * far) / depth;
+    f[3][2] = -1;
+    f[3][3] = 0;
+    return f;
+}
+
+mat4
+ortho(float left, float right, float bottom, float top, float near, float far)
+{
+    float width(right - left);
+    float height(top - bottom);
+    float depth(far - near);
+    mat4 o;
+    o[0][0] = 2 / width;
+    o[0][3] = (right + left) / width;
+    o[1][1] = 2 / height;
+    o[1][3] = (top + bottom) / height;
+    o[2][2] = -2 / depth;
+    o[2][3] = (far + near) / depth;
+    return o;
+}
+
+OUT_OF_LINE mat4
+perspective(float fovy, float aspect, float zNear, float zFar)
+{
+    float fovyRadians(fovy * M_PI / 180.0);
+    float f = 1/tan(fovyRadians / 2);
+    float depth(zNear - zFar);
+    mat4 p;
+    p[0][0] = f / aspect;
+    p[1][1] = f;
+    p[2][2] = (zFar + zNear) / depth;
+    p[2][3] = (2 * zFar * zNear) / depth;
+    p[3][2] = -1;
+    p[3][3] = 0;
+    return p;
+}
+
+OUT_OF_LINE mat4
+lookAt(float eyeX, float eyeY, float eyeZ,
+       float centerX, float centerY, float centerZ,
+       float upX, float upY, float upZ)
+{
+    vec3 f(centerX - eyeX, centerY - eyeY, centerZ - eyeZ);
+    f.normalize();
+    vec3 up(upX, upY, upZ);
+    vec3 s = vec3::cross(f, up);
+    vec3 u = vec3::cross(s, f);
+    s.normalize();
+    u.normalize();
+    mat4 la;
+    la[0][0] = s.x();
+    la[0][1] = s.y();
+    la[0][2] = s.z();
+    la[1][0] = u.x();
+    la[1][1] = u.y();
+    la[1][2] = u.z();
+    la[2][0] = -f.x();
+    la[2][1] = -f.y();
+    la[2][2] = -f.z();
+    la *= translate(-eyeX, -eyeY, -eyeZ);
+    return la;
+}
+
+} // namespace Proxy
+
+// The generators all take a handful of floats; each adapter feeds one of
+// them from a single varying parameter so that nothing is hoisted out of
+// the timing loop.
+struct TranslateDirect { static mat4 make(float t) { return LibMatrix::Mat4::translate(t, 2.0f, 3.0f); } };
+struct TranslateProxy { static mat4 make(float t) { return Proxy::translate(t, 2.0f, 3.0f); } };
+struct ScaleDirect { static mat4 make(float t) { return LibMatrix::Mat4::scale(t, 2.0f, 3.0f); } };
+struct ScaleProxy { static mat4 make(float t) { return Proxy::scale(t, 2.0f, 3.0f); } };
+struct RotateDirect { static mat4 make(float t) { return LibMatrix::Mat4::rotate(t, 1.0f, 2.0f, 3.0f); } };
+struct RotateProxy { static mat4 make(float t) { return Proxy::rotate(t, 1.0f, 2.0f, 3.0f); } };
+struct FrustumDirect { static mat4 make(float t) { return LibMatrix::Mat4::frustum(-t, t, -1.0f, 1.0f, 1.0f, 100.0f); } };
+struct FrustumProxy { static mat4 make(float t) { return Proxy::frustum(-t, t, -1.0f, 1.0f, 1.0f, 100.0f); } };
+struct OrthoDirect { static mat4 make(float t) { return LibMatrix::Mat4::ortho(-t, t, -1.0f, 1.0f, 1.0f, 100.0f); } };
+struct OrthoProxy { static mat4 make(float t) { return Proxy::ortho(-t, t, -1.0f, 1.0f, 1.0f, 100.0f); } };
+struct PerspectiveDirect { static mat4 make(float t) { return LibMatrix::Mat4::perspective(t, 1.5f, 1.0f, 100.0f); } };
+struct PerspectiveProxy { static mat4 make(float t) { return Proxy::perspective(t, 1.5f, 1.0f, 100.0f); } };
+struct LookAtDirect { static mat4 make(float t) { return LibMatrix::Mat4::lookAt(t, 2.0f, 3.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f); } };
+struct LookAtProxy { static mat4 make(float t) { return Proxy::lookAt(t, 2.0f, 3.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f); } };
+
+// Generates numItems matrices, summing them so that the work cannot be
+// dropped.
+template<typename Generator>
+class Generate
+{
+public:
+    Generate(float& sink) :
+        sink_(sink) {}
+    void operator()()
+    {
+        mat4 sum;
+        for (unsigned int i = 0; i < numItems; i++)
+        {
+            sum += Generator::make(static_cast<float>(i & 63) + 1.0f);
+        }
+        sink_ += sum(0, 0) + sum(3, 2);
+    }
+private:
+    float& sink_;
+};
+
+template<typename Generator>
+uint64_t
+timeGenerator(float& sink)
+{
+    Generate<Generator> op(sink);
+    return MatrixBench::fastest(op);
+}
+
+} // namespace
+
+void
+GeneratorBench::run(const Options&)
+{
+    float sink(0.0f);
+    report("translate (operator[])", timeGenerator<TranslateProxy>(sink), numItems);
+    report("translate (direct)", timeGenerator<TranslateDirect>(sink), numItems);
+    report("scale (operator[])", timeGenerator<ScaleProxy>(sink), numItems);
+    report("scale (direct)", timeGenerator<ScaleDirect>(sink), numItems);
+    report("rotate (operator[])", timeGenerator<RotateProxy>(sink), numItems);
+    report("rotate (direct)", timeGenerator<RotateDirect>(sink), numItems);
+    report("frustum (operator[])", timeGenerator<FrustumProxy>(sink), numItems);
+    report("frustum (direct)", timeGenerator<FrustumDirect>(sink), numItems);
+    report("ortho (operator[])", timeGenerator<OrthoProxy>(sink), numItems);
+    report("ortho (direct)", timeGenerator<OrthoDirect>(sink), numItems);
+    report("perspective (operator[])", timeGenerator<PerspectiveProxy>(sink), numItems);
+    report("perspective (direct)", timeGenerator<PerspectiveDirect>(sink), numItems);
+    report("lookAt (operator[])", timeGenerator<LookAtProxy>(sink), numItems);
+    report("lookAt (direct)", timeGenerator<LookAtDirect>(sink), numItems);
+    if (sink == 0.0f)
+    {
+        report("(unused)", 0, 0);
+    }
+}
@@ -0,0 +1,186 @@
+//
+// Copyright (c) 2013 Linaro Limited
+//
+// All rights reserved. This program and the accompanying materials
+// are made available under the terms of the MIT License which accompanies
+// this distribution, and is available at
+// http://www.opensource.org/licenses/mit-license.php
+//
+// Contributors:
+//     Jesse Barker - original implementation.
+//
+#include <string>
+#include <vector>
+#include "libmatrix_test.h"
+#include "libmatrix_bench.h"
+#include "hierarchy_bench.h"
+#include "../hierarchy.h"
+#include "../stack.h"
+#include "../thread-pool.h"
+
+using LibMatrix::mat4;
+using LibMatrix::vec3;
+using LibMatrix::Stack4;
+using LibMatrix::TransformHierarchy;
+using std::vector;
+
+namespace
+{
+
+const unsigned int count(100000);
+const unsigned int numPasses(16);
+// The number of nodes whose local transform changes in each pass (1%).
+const unsigned int churn(count / 100);
+
+// A single tree, added breadth first with between one and seven children
+// per node, and the nodes to change in each pass, picked at random.
+struct HierarchyWork
+{
+    HierarchyWork() :
+        childBegin(count), childEnd(count), worlds(count), changed(churn * numPasses),
+        moved(LibMatrix::Mat4::translate(0.0f, 0.5f, 0.0f)), pool(0)
+    {
+        hierarchy.reserve(count);
+        hierarchy.add(TransformHierarchy::noParent, local(0));
+        for (unsigned int parent = 0; parent < count; parent++)
+        {
+            childBegin[parent] = hierarchy.size();
+            for (unsigned int c = 0; c <= parent % 7 && hierarchy.size() < count; c++)
+            {
+                hierarchy.add(parent, local(hierarchy.size()));
+            }
+            childEnd[parent] = hierarchy.size();
+        }
+        unsigned int seed(1);
+        for (unsigned int i = 0; i < changed.size(); i++)
+        {
+            seed = seed * 1103515245 + 12345;
+            changed[i] = (seed >> 8) % count;
+        }
+        hierarchy.update();
+    }
+    static mat4 local(unsigned int node)
+    {
+        float f(static_cast<float>(node % 64));
+        return LibMatrix::Mat4::compose(vec3(f, 1.0f, -2.0f), f * 5.0f, vec3(0.0f, 1.0f, 0.0f),
+                                        vec3(1.0f, 1.0f, 1.0f));
+    }
+    TransformHierarchy hierarchy;
+    // The children of node i are [childBegin[i], childEnd[i]).
+    vector<unsigned int> childBegin;
+    vector<unsigned int> childEnd;
+    // The world transforms from walking the tree with Stack4.
+    vector<mat4> worlds;
+    vector<unsigned int> changed;
+    mat4 moved;
+    LibMatrix::ThreadPool pool;
+};
+
+// Walk the whole tree depth first with Stack4, as for a scene rebuilt
+// every frame.
+void
+walk(HierarchyWork& w, Stack4& stack, unsigned int node)
+{
+    stack.push();
+    stack *= w.hierarchy.getLocal(node);
+    w.worlds[node] = stack.getCurrent();
+    for (unsigned int c = w.childBegin[node]; c < w.childEnd[node]; c++)
+    {
+        walk(w, stack, c);
+    }
+    stack.pop();
+}
+
+struct WalkStack
+{
+    static OUT_OF_LINE void run(HierarchyWork& w, unsigned int)
+    {
+        Stack4 stack;
+        walk(w, stack, 0);
+    }
+};
+
+// Changing the root, so that every world transform is recomputed.
+struct UpdateAll
+{
+    static OUT_OF_LINE void run(HierarchyWork& w, unsigned int)
+    {
+        w.hierarchy.setLocal(0, w.hierarchy.getLocal(0));
+        w.hierarchy.update();
+    }
+};
+
+struct UpdateChurn
+{
+    static OUT_OF_LINE void run(HierarchyWork& w, unsigned int pass)
+    {
+        const unsigned int* changed(&w.changed[pass * churn]);
+        for (unsigned int i = 0; i < churn; i++)
+        {
+            w.hierarchy.setLocal(changed[i], w.moved * w.hierarchy.getLocal(changed[i]));
+        }
+        w.hierarchy.update();
+    }
+};
+
+struct ParallelUpdateAll
+{
+    static OUT_OF_LINE void run(HierarchyWork& w, unsigned int)
+    {
+        w.hierarchy.setLocal(0, w.hierarchy.getLocal(0));
+        w.hierarchy.update(w.pool);
+    }
+};
+
+struct ParallelUpdateChurn
+{
+    static OUT_OF_LINE void run(HierarchyWork& w, unsigned int pass)
+    {
+        const unsigned int* changed(&w.changed[pass * churn]);
+        for (unsigned int i = 0; i < churn; i++)
+        {
+            w.hierarchy.setLocal(changed[i], w.moved * w.hierarchy.getLocal(changed[i]));
+        }
+        w.hierarchy.update(w.pool);
+    }
+};
+
+// Runs Op for each of the numPasses passes.
+template<typename Op>
+class Passes
+{
+public:
+    Passes(HierarchyWork& w) :
+        w_(w) {}
+    void operator()()
+    {
+        for (unsigned int pass = 0; pass < numPasses; pass++)
+        {
+            Op::run(w_, pass);
+        }
+    }
+private:
+    HierarchyWork& w_;
+};
+
+template<typename Op>
+uint64_t
+timeOp(HierarchyWork& w)
+{
+    Passes<Op> op(w);
+    return MatrixBench::fastest(op);
+}
+
+} // namespace
+
+void
+HierarchyBench::run(const Options&)
+{
+    HierarchyWork w;
+    unsigned int items(count * numPasses);
+    report("Stack4, walking every node", timeOp<WalkStack>(w), items);
+    report("update(), every node dirty", timeOp<UpdateAll>(w), items);
+    report("update(), 1% of nodes changed", timeOp<UpdateChurn>(w), items);
+    report("update(pool), every node dirty", timeOp<ParallelUpdateAll>(w), items);
+    report("update(pool), 1% of nodes changed", timeOp<ParallelUpdateChurn>(w), items);
+}
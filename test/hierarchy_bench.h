@@ -0,0 +1,25 @@
+//
+// Copyright (c) 2013 Linaro Limited
+//
+// All rights reserved. This program and the accompanying materials
+// are made available under the terms of the MIT License which accompanies
+// this distribution, and is available at
+// http://www.opensource.org/licenses/mit-license.php
+//
+// Contributors:
+//     Jesse Barker - original implementation.
+//
+#ifndef HIERARCHY_BENCH_H_
+#define HIERARCHY_BENCH_H_
+
+class MatrixBench;
+class Options;
+
+class HierarchyBench : public MatrixBench
+{
+public:
+    HierarchyBench() : MatrixBench("TransformHierarchy world transforms (100k nodes)") {}
+    virtual void run(const Options& options);
+};
+
+#endif // HIERARCHY_BENCH_H_
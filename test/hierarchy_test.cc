@@ -0,0 +1,246 @@
+//
+// Copyright (c) 2013 Linaro Limited
+//
+// All rights reserved. This program and the accompanying materials
+// are made available under the terms of the MIT License which accompanies
+// this distribution, and is available at
+// http://www.opensource.org/licenses/mit-license.php
+//
+// Contributors:
+//     Jesse Barker - original implementation.
+//
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+#include <string.h>
+#include "libmatrix_test.h"
+#include "hierarchy_test.h"
+#include "../hierarchy.h"
+#include "../stack.h"
+#include "../thread-pool.h"
+
+using LibMatrix::mat4;
+using LibMatrix::vec3;
+using LibMatrix::Stack4;
+using LibMatrix::TransformHierarchy;
+using LibMatrix::ThreadPool;
+using std::cout;
+using std::endl;
+
+// A local transform that differs from node to node.
+static mat4
+localFor(unsigned int node, float phase)
+{
+    float f(static_cast<float>(node));
+    return LibMatrix::Mat4::compose(vec3(f * 0.5f + phase, 1.0f - f * 0.25f, 2.0f),
+                                    f * 7.0f + phase, vec3(0.3f, 1.0f, -0.2f),
+                                    vec3(1.0f + f * 0.01f, 1.0f, 0.9f));
+}
+
+static bool
+sameBits(const mat4& a, const mat4& b)
+{
+    return memcmp(static_cast<const float*>(a), static_cast<const float*>(b), 16 * sizeof(float)) == 0;
+}
+
+// Check each world transform against walking down from its root with
+// Stack4, bit for bit.
+static bool
+matchesStack(const TransformHierarchy& hierarchy, const Options& options)
+{
+    for (unsigned int node = 0; node < hierarchy.size(); node++)
+    {
+        std::vector<unsigned int> path;
+        for (unsigned int n = node; n != TransformHierarchy::noParent; n = hierarchy.getParent(n))
+        {
+            path.push_back(n);
+        }
+        Stack4 stack;
+        for (unsigned int i = path.size(); i > 0; i--)
+        {
+            stack *= hierarchy.getLocal(path[i - 1]);
+        }
+        const mat4& world(hierarchy.getWorld(node));
+        const mat4& expected(stack.getCurrent());
+        if (!sameBits(world, expected))
+        {
+            if (options.beVerbose())
+            {
+                cout << "The world transform of node " << node << " is:" << endl;
+                world.print();
+                cout << "rather than:" << endl;
+                expected.print();
+            }
+            return false;
+        }
+    }
+    return true;
+}
+
+void
+HierarchyTestUpdate::run(const Options& options)
+{
+    // Two trees, added breadth first with between one and four children
+    // per node, and a few nodes added depth first at the end.
+    TransformHierarchy hierarchy;
+    hierarchy.add(TransformHierarchy::noParent, localFor(0, 0.0f));
+    for (unsigned int parent = 0; hierarchy.size() < 100; parent++)
+    {
+        for (unsigned int c = 0; c <= parent % 4; c++)
+        {
+            hierarchy.add(parent, localFor(hierarchy.size(), 0.0f));
+        }
+    }
+    unsigned int secondRoot(hierarchy.add(TransformHierarchy::noParent, localFor(100, 0.0f)));
+    unsigned int n(secondRoot);
+    for (unsigned int i = 0; i < 8; i++)
+    {
+        n = hierarchy.add(n, localFor(hierarchy.size(), 0.0f));
+    }
+    hierarchy.update();
+    if (!matchesStack(hierarchy, options))
+    {
+        return;
+    }
+
+    // Change an inner node, a leaf, a root and a node in the middle of a
+    // run of siblings; only they and their descendants get recomputed.
+    const unsigned int changed[] = { 5, 97, secondRoot, 30 };
+    for (unsigned int i = 0; i < sizeof(changed) / sizeof(changed[0]); i++)
+    {
+        hierarchy.setLocal(changed[i], localFor(changed[i], 1.5f));
+    }
+    hierarchy.setLocal(12, vec3(1.0f, 2.0f, 3.0f), 45.0f, vec3(0.0f, 0.0f, 1.0f),
+                       vec3(2.0f, 2.0f, 2.0f));
+    if (!hierarchy.isDirty(5) || !hierarchy.isDirty(12) || hierarchy.isDirty(6))
+    {
+        if (options.beVerbose())
+        {
+            cout << "setLocal() did not mark the right nodes dirty." << endl;
+        }
+        return;
+    }
+    mat4 untouched(hierarchy.getWorld(2));
+    hierarchy.update();
+    if (!matchesStack(hierarchy, options) || !sameBits(hierarchy.getWorld(2), untouched))
+    {
+        return;
+    }
+    for (unsigned int node = 0; node < hierarchy.size(); node++)
+    {
+        if (hierarchy.isDirty(node))
+        {
+            if (options.beVerbose())
+            {
+                cout << "Node " << node << " is still dirty after update()." << endl;
+            }
+            return;
+        }
+    }
+
+    // Nodes can be added after an update.
+    hierarchy.add(40, localFor(200, 0.0f));
+    hierarchy.update();
+    if (!matchesStack(hierarchy, options))
+    {
+        return;
+    }
+
+    bool threw(false);
+    try
+    {
+        hierarchy.add(hierarchy.size(), mat4());
+    }
+    catch (const std::invalid_argument&)
+    {
+        threw = true;
+    }
+    if (!threw)
+    {
+        if (options.beVerbose())
+        {
+            cout << "A node was added below a parent that does not exist." << endl;
+        }
+        return;
+    }
+
+    pass_ = true;
+}
+
+void
+HierarchyTestParallel::run(const Options& options)
+{
+    // Three trees, added level by level.
+    TransformHierarchy parallel;
+    for (unsigned int root = 0; root < 3; root++)
+    {
+        parallel.add(TransformHierarchy::noParent, localFor(root, 0.0f));
+    }
+    for (unsigned int parent = 0; parallel.size() < 20000; parent++)
+    {
+        for (unsigned int c = 0; c < parent % 5; c++)
+        {
+            parallel.add(parent, localFor(parallel.size(), 0.0f));
+        }
+    }
+    if (!parallel.isLevelOrdered())
+    {
+        if (options.beVerbose())
+        {
+            cout << "A hierarchy added level by level is not level ordered." << endl;
+        }
+        return;
+    }
+
+    // A small grain, so that the larger levels are split into many chunks
+    // and sibling runs are cut at chunk boundaries.
+    ThreadPool pool(4);
+    TransformHierarchy serial(parallel);
+    bool good(true);
+    for (unsigned int pass = 0; pass < 3 && good; pass++)
+    {
+        parallel.update(pool, 64);
+        serial.update();
+        for (unsigned int node = 0; node < parallel.size() && good; node++)
+        {
+            good = sameBits(parallel.getWorld(node), serial.getWorld(node)) &&
+                   !parallel.isDirty(node);
+        }
+        good = good && matchesStack(parallel, options);
+
+        // Change some nodes at random for the next pass.
+        unsigned int seed(pass + 1);
+        for (unsigned int i = 0; i < 100; i++)
+        {
+            seed = seed * 1103515245 + 12345;
+            unsigned int node((seed >> 8) % parallel.size());
+            parallel.setLocal(node, localFor(node, 2.0f + pass));
+            serial.setLocal(node, localFor(node, 2.0f + pass));
+        }
+    }
+    if (!good)
+    {
+        if (options.beVerbose())
+        {
+            cout << "The parallel update differs from the serial one." << endl;
+        }
+        return;
+    }
+
+    // A hierarchy that is not level ordered is still updated correctly.
+    TransformHierarchy mixed;
+    unsigned int n(mixed.add(TransformHierarchy::noParent, localFor(0, 0.0f)));
+    for (unsigned int i = 1; i < 6; i++)
+    {
+        n = mixed.add(n, localFor(i, 0.0f));
+    }
+    mixed.add(TransformHierarchy::noParent, localFor(6, 0.0f));
+    mixed.add(2, localFor(7, 0.0f));
+    mixed.update(pool, 1);
+    if (mixed.isLevelOrdered() || !matchesStack(mixed, options))
+    {
+        return;
+    }
+
+    pass_ = true;
+}
@@ -0,0 +1,32 @@
+//
+// Copyright (c) 2013 Linaro Limited
+//
+// All rights reserved. This program and the accompanying materials
+// are made available under the terms of the MIT License which accompanies
+// this distribution, and is available at
+// http://www.opensource.org/licenses/mit-license.php
+//
+// Contributors:
+//     Jesse Barker - original implementation.
+//
+#ifndef HIERARCHY_TEST_H_
+#define HIERARCHY_TEST_H_
+
+class MatrixTest;
+class Options;
+
+class HierarchyTestUpdate : public MatrixTest
+{
+public:
+    HierarchyTestUpdate() : MatrixTest("TransformHierarchy::update") {}
+    virtual void run(const Options& options);
+};
+
+class HierarchyTestParallel : public MatrixTest
+{
+public:
+    HierarchyTestParallel() : MatrixTest("TransformHierarchy::update (threaded)") {}
+    virtual void run(const Options& options);
+};
+
+#endif // HIERARCHY_TEST_H_
@@ -0,0 +1,156 @@
+//
+// Copyright (c) 2013 Linaro Limited
+//
+// All rights reserved. This program and the accompanying materials
+// are made available under the terms of the MIT License which accompanies
+// this distribution, and is available at
+// http://www.opensource.org/licenses/mit-license.php
+//
+// Contributors:
+//     Jesse Barker - original implementation.
+//
+#include <new>
+#include <sstream>
+#include <vector>
+#include "libmatrix_test.h"
+#include "libmatrix_bench.h"
+#include "init_bench.h"
+#include "../mat.h"
+
+using LibMatrix::mat4;
+using std::vector;
+
+namespace
+{
+
+const unsigned int minItems(1 << 22);
+
+unsigned int
+passes(unsigned int count)
+{
+    return (minItems + count - 1) / count;
+}
+
+// Resizing a std::vector<mat4> from empty, which sets every element to
+// the identity.
+class Resize
+{
+public:
+    Resize(unsigned int count) :
+        count_(count)
+    {
+        v_.reserve(count);
+    }
+    void operator()()
+    {
+        for (unsigned int pass = 0; pass < passes(count_); pass++)
+        {
+            v_.resize(count_);
+            v_.clear();
+        }
+    }
+private:
+    vector<mat4> v_;
+    unsigned int count_;
+};
+
+// Constructing the same number of matrices in place, uninitialized, as for
+// an output buffer that is about to be filled by a batch operation.
+class Uninitialized
+{
+public:
+    Uninitialized(unsigned int count) :
+        storage_(count * sizeof(mat4)), count_(count) {}
+    void operator()()
+    {
+        mat4* m(reinterpret_cast<mat4*>(&storage_[0]));
+        for (unsigned int pass = 0; pass < passes(count_); pass++)
+        {
+            for (unsigned int i = 0; i < count_; i++)
+            {
+                new (static_cast<void*>(m + i)) mat4(LibMatrix::uninitialized);
+            }
+        }
+    }
+private:
+    vector<char> storage_;
+    unsigned int count_;
+};
+
+template<typename Op>
+uint64_t
+timeOp(unsigned int count)
+{
+    Op op(count);
+    return MatrixBench::fastest(op);
+}
+
+// c[i] = a[i] * b[i] for 'count' matrices, with either the operator or the
+// copy-then-multiply-in-place that it used to be.
+template<bool copyFirst>
+class Multiply
+{
+public:
+    Multiply(mat4* c, const mat4* a, const mat4* b, unsigned int count) :
+        c_(c), a_(a), b_(b), count_(count) {}
+    void operator()()
+    {
+        for (unsigned int pass = 0; pass < passes(count_); pass++)
+        {
+            for (unsigned int i = 0; i < count_; i++)
+            {
+                c_[i] = copyFirst ? mat4(a_[i]) *= b_[i] : a_[i] * b_[i];
+            }
+        }
+    }
+private:
+    mat4* c_;
+    const mat4* a_;
+    const mat4* b_;
+    unsigned int count_;
+};
+
+template<bool copyFirst>
+uint64_t
+timeMultiply(mat4* c, const mat4* a, const mat4* b, unsigned int count)
+{
+    Multiply<copyFirst> op(c, a, b, count);
+    return MatrixBench::fastest(op);
+}
+
+} // namespace
+
+void
+InitBenchConstruct::run(const Options&)
+{
+    static const unsigned int sizes[] = { 1024, 1048576 };
+    for (unsigned int s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++)
+    {
+        unsigned int count(sizes[s]);
+        unsigned int items(count * passes(count));
+        std::stringstream ss;
+        ss << count << " matrices, ";
+        std::string prefix(ss.str());
+
+        report(prefix + "vector::resize (identity)", timeOp<Resize>(count), items);
+        report(prefix + "uninitialized", timeOp<Uninitialized>(count), items);
+    }
+}
+
+void
+InitBenchMultiply::run(const Options&)
+{
+    static const unsigned int count(1024);
+    unsigned int items(count * passes(count));
+    vector<mat4> a(count);
+    vector<mat4> b(count);
+    vector<mat4> c(count);
+    for (unsigned int i = 0; i < count; i++)
+    {
+        a[i] = LibMatrix::Mat4::rotate(static_cast<float>(i % 360), 0.0f, 1.0f, 0.0f);
+        b[i] = LibMatrix::Mat4::translate(1.0f, static_cast<float>(i), 3.0f);
+    }
+
+    report("copy, then *=", timeMultiply<true>(&c[0], &a[0], &b[0], count), items);
+    report("operator*", timeMultiply<false>(&c[0], &a[0], &b[0], count), items);
+}
@@ -0,0 +1,32 @@
+//
+// Copyright (c) 2013 Linaro Limited
+//
+// All rights reserved. This program and the accompanying materials
+// are made available under the terms of the MIT License which accompanies
+// this distribution, and is available at
+// http://www.opensource.org/licenses/mit-license.php
+//
+// Contributors:
+//     Jesse Barker - original implementation.
+//
+#ifndef INIT_BENCH_H_
+#define INIT_BENCH_H_
+
+class MatrixBench;
+class Options;
+
+class InitBenchConstruct : public MatrixBench
+{
+public:
+    InitBenchConstruct() : MatrixBench("mat4 construction (identity vs. uninitialized)") {}
+    virtual void run(const Options& options);
+};
+
+class InitBenchMultiply : public MatrixBench
+{
+public:
+    InitBenchMultiply() : MatrixBench("mat4::operator*") {}
+    virtual void run(const Options& options);
+};
+
+#endif // INIT_BENCH_H_
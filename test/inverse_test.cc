@@ -10,9 +10,13 @@
 //     Jesse Barker - original implementation.
 //
 #include <iostream>
+#include <vector>
+#include <stdexcept>
+#include <stdint.h>
 #include "libmatrix_test.h"
 #include "inverse_test.h"
 #include "../mat.h"
+#include "../util.h"
 
 using LibMatrix::mat2;
 using LibMatrix::mat3;
@@ -170,3 +174,350 @@ MatrixTest4x4Inverse::run(const Options& options)
     }
 }
 
+// The original tmat4::inverse(), which builds a 3x3 minor for every cofactor
+// and divides each one by the determinant.  Kept here as the reference for
+// the shared sub-determinant version.
+static bool
+minorsInverse(mat4& m)
+{
+    const float* e(m);
+    mat3 minor0(e[5], e[6], e[7], e[9], e[10], e[11], e[13], e[14], e[15]);
+    mat3 minor4(e[1], e[2], e[3], e[9], e[10], e[11], e[13], e[14], e[15]);
+    mat3 minor8(e[1], e[2], e[3], e[5], e[6], e[7], e[13], e[14], e[15]);
+    mat3 minor12(e[1], e[2], e[3], e[5], e[6], e[7], e[9], e[10], e[11]);
+    float d((e[0] * minor0.determinant()) - (e[4] * minor4.determinant()) +
+            (e[8] * minor8.determinant()) - (e[12] * minor12.determinant()));
+    if (d == 0.0f)
+    {
+        return false;
+    }
+    mat3 minors[16] = {
+        mat3(e[5], e[6], e[7], e[9], e[10], e[11], e[13], e[14], e[15]),
+        mat3(e[1], e[2], e[3], e[13], e[14], e[15], e[9], e[10], e[11]),
+        mat3(e[1], e[2], e[3], e[5], e[6], e[7], e[13], e[14], e[15]),
+        mat3(e[1], e[2], e[3], e[9], e[10], e[11], e[5], e[6], e[7]),
+        mat3(e[4], e[6], e[7], e[12], e[14], e[15], e[8], e[10], e[11]),
+        mat3(e[0], e[2], e[3], e[8], e[10], e[11], e[12], e[14], e[15]),
+        mat3(e[0], e[2], e[3], e[12], e[14], e[15], e[4], e[6], e[7]),
+        mat3(e[0], e[2], e[3], e[4], e[6], e[7], e[8], e[10], e[11]),
+        mat3(e[4], e[5], e[7], e[8], e[9], e[11], e[12], e[13], e[15]),
+        mat3(e[0], e[1], e[3], e[12], e[13], e[15], e[8], e[9], e[11]),
+        mat3(e[0], e[1], e[3], e[4], e[5], e[7], e[12], e[13], e[15]),
+        mat3(e[0], e[1], e[3], e[8], e[9], e[11], e[4], e[5], e[7]),
+        mat3(e[4], e[5], e[6], e[12], e[13], e[14], e[8], e[9], e[10]),
+        mat3(e[0], e[1], e[2], e[8], e[9], e[10], e[12], e[13], e[14]),
+        mat3(e[0], e[1], e[2], e[12], e[13], e[14], e[4], e[5], e[6]),
+        mat3(e[0], e[1], e[2], e[4], e[5], e[6], e[8], e[9], e[10])
+    };
+    for (unsigned int i = 0; i < 16; i++)
+    {
+        m[i % 4][i / 4] = minors[i].determinant() / d;
+    }
+    return true;
+}
+
+// Largest deviation of a * b from the identity.
+static float
+identityError(const mat4& a, const mat4& b)
+{
+    mat4 p(a);
+    p *= b;
+    float error(0.0f);
+    for (unsigned int r = 0; r < 4; r++)
+    {
+        for (unsigned int c = 0; c < 4; c++)
+        {
+            float expected(r == c ? 1.0f : 0.0f);
+            float diff(fabs(p[r][c] - expected));
+            if (diff > error)
+            {
+                error = diff;
+            }
+        }
+    }
+    return error;
+}
+
+void
+MatrixTest4x4InverseCompare::run(const Options& options)
+{
+    // A fixed pseudo-random sequence of diagonally dominant (and therefore
+    // well conditioned) matrices, so the run is reproducible.
+    static const unsigned int numMatrices(4096);
+    std::vector<mat4> input(numMatrices);
+    unsigned int seed(12345);
+    for (unsigned int i = 0; i < numMatrices; i++)
+    {
+        for (unsigned int r = 0; r < 4; r++)
+        {
+            for (unsigned int c = 0; c < 4; c++)
+            {
+                seed = seed * 1103515245 + 12345;
+                float v(static_cast<float>((seed >> 16) & 0x7fff) / 16384.0f - 1.0f);
+                input[i][r][c] = (r == c) ? v + 4.0f : v;
+            }
+        }
+    }
+
+    std::vector<mat4> minors(input);
+    std::vector<mat4> shared(input);
+
+    uint64_t start(Util::get_timestamp_us());
+    for (unsigned int i = 0; i < numMatrices; i++)
+    {
+        if (!minorsInverse(minors[i]))
+        {
+            return;
+        }
+    }
+    uint64_t minorsTime(Util::get_timestamp_us() - start);
+
+    start = Util::get_timestamp_us();
+    for (unsigned int i = 0; i < numMatrices; i++)
+    {
+        shared[i].inverse();
+    }
+    uint64_t sharedTime(Util::get_timestamp_us() - start);
+
+    float minorsError(0.0f);
+    float sharedError(0.0f);
+    for (unsigned int i = 0; i < numMatrices; i++)
+    {
+        float error(identityError(input[i], minors[i]));
+        if (error > minorsError)
+        {
+            minorsError = error;
+        }
+        error = identityError(input[i], shared[i]);
+        if (error > sharedError)
+        {
+            sharedError = error;
+        }
+    }
+
+    if (options.beVerbose())
+    {
+        cout << "Inverted " << numMatrices << " matrices:" << std::scientific << endl;
+        cout << "    3x3 minors: " << minorsTime << "us, max error " << minorsError << endl;
+        cout << "    shared 2x2: " << sharedTime << "us, max error " << sharedError << endl;
+    }
+
+    // The shared sub-determinant version has to be at least about as
+    // precise as the one it replaces.
+    pass_ = sharedError <= 2.0f * minorsError + 1.0e-6f;
+}
+
+void
+MatrixTest4x4InverseAffine::run(const Options& options)
+{
+    mat4 m(LibMatrix::Mat4::translate(1.0, -2.0, 3.0));
+    m *= LibMatrix::Mat4::rotate(30.0, 1.0, 2.0, 3.0);
+    m *= LibMatrix::Mat4::scale(2.0, 0.5, 4.0);
+
+    if (!m.isAffine())
+    {
+        return;
+    }
+
+    mat4 affine(m);
+    affine.inverseAffine();
+    mat4 general(m);
+    general.inverse();
+
+    if (options.beVerbose())
+    {
+        cout << "Affine inverse of translate * rotate * scale: " << endl << endl;
+        affine.print();
+        cout << endl << "General inverse (should match): " << endl << endl;
+        general.print();
+    }
+
+    if (maxDifference(affine, general) > 1.0e-5f ||
+        identityError(m, affine) > 1.0e-5f)
+    {
+        return;
+    }
+
+    // The checked mode has to take the affine path for affine input.  Its
+    // results are not compared exactly with those of the direct calls, as
+    // the compiler may contract the inlined copies into fused multiply-adds
+    // differently.  Instead, the input is one that only the affine path can
+    // invert: with a translation this large, the 4x4 cofactors overflow,
+    // and every element of the general inverse comes out NaN...
+    mat4 far(LibMatrix::Mat4::translate(1.0e37, -2.0e37, 3.0e37));
+    far *= LibMatrix::Mat4::rotate(30.0, 1.0, 2.0, 3.0);
+    far *= LibMatrix::Mat4::scale(200.0, 50.0, 400.0);
+    mat4 farGeneral(far);
+    farGeneral.inverse();
+    if (!isnan(farGeneral[0][0]))
+    {
+        return;
+    }
+    mat4 farAffine(far);
+    farAffine.inverseAffine();
+    mat4 farChecked(far);
+    farChecked.inverse(LibMatrix::InverseCheckAffine);
+    for (unsigned int r = 0; r < 4; r++)
+    {
+        for (unsigned int c = 0; c < 4; c++)
+        {
+            float expected(farAffine[r][c]);
+            if (!(fabs(farChecked[r][c] - expected) <= 1.0e-5f * (fabs(expected) + 1.0f)))
+            {
+                if (options.beVerbose())
+                {
+                    cout << "InverseCheckAffine did not take the affine path." << endl;
+                }
+                return;
+            }
+        }
+    }
+
+    // ...and the general one for anything else, where the affine inverse
+    // would leave the bottom row alone.
+    mat4 p(LibMatrix::Mat4::perspective(60.0, 1.5, 1.0, 100.0));
+    if (p.isAffine())
+    {
+        return;
+    }
+    mat4 pChecked(p);
+    pChecked.inverse(LibMatrix::InverseCheckAffine);
+    mat4 pGeneral(p);
+    pGeneral.inverse();
+    if (maxDifference(pChecked, pGeneral) > 1.0e-5f)
+    {
+        return;
+    }
+
+    // A singular upper 3x3 must still be caught.
+    mat4 flat(LibMatrix::Mat4::scale(1.0, 0.0, 1.0));
+    try
+    {
+        flat.inverseAffine();
+        return;
+    }
+    catch (const std::runtime_error&)
+    {
+    }
+
+    pass_ = true;
+}
+
+void
+MatrixTest4x4InverseRigid::run(const Options& options)
+{
+    mat4 m(LibMatrix::Mat4::translate(4.0, 5.0, 6.0));
+    m *= LibMatrix::Mat4::rotate(75.0, 0.0, 1.0, 1.0);
+
+    mat4 rigid(m);
+    rigid.inverseRigid();
+    mat4 general(m);
+    general.inverse();
+
+    if (options.beVerbose())
+    {
+        cout << "Rigid inverse of translate * rotate: " << endl << endl;
+        rigid.print();
+        cout << endl << "General inverse (should match): " << endl << endl;
+        general.print();
+    }
+
+    if (maxDifference(rigid, general) > 1.0e-5f ||
+        identityError(m, rigid) > 1.0e-5f)
+    {
+        return;
+    }
+
+    // A viewing transform is rigid, too.
+    mat4 view(LibMatrix::Mat4::lookAt(1.0, 2.0, 3.0, 0.0, 0.0, 0.0, 0.0, 1.0, 0.0));
+    mat4 viewRigid(view);
+    viewRigid.inverseRigid();
+    mat4 viewGeneral(view);
+    viewGeneral.inverse();
+    if (maxDifference(viewRigid, viewGeneral) > 1.0e-5f)
+    {
+        return;
+    }
+
+    pass_ = true;
+}
+
+void
+MatrixTestTryInverse::run(const Options& options)
+{
+    // Invertible matrices give the same answer as inverse().
+    mat2 m2;
+    m2[0][1] = -2.5;
+    mat2 i2(m2);
+    i2.inverse();
+    mat2 t2;
+    if (!m2.tryInverse(0.0f, t2) || t2 != i2)
+    {
+        return;
+    }
+
+    mat3 m3;
+    m3[1][2] = -2.5;
+    mat3 i3(m3);
+    i3.inverse();
+    mat3 t3;
+    if (!m3.tryInverse(0.0f, t3) || t3 != i3)
+    {
+        return;
+    }
+
+    mat4 m4;
+    m4[2][3] = -2.5;
+    mat4 i4(m4);
+    i4.inverse();
+    mat4 t4;
+    if (!m4.tryInverse(0.0f, t4) || t4 != i4)
+    {
+        return;
+    }
+
+    // Singular matrices are rejected without touching the output.
+    mat2 s2(1.0f, 2.0f, 2.0f, 4.0f);
+    mat3 s3(1.0f, 2.0f, 3.0f, 2.0f, 4.0f, 6.0f, 0.0f, 0.0f, 1.0f);
+    mat4 s4(LibMatrix::Mat4::scale(1.0f, 0.0f, 1.0f));
+    if (s2.tryInverse(0.0f, t2) || t2 != i2 ||
+        s3.tryInverse(0.0f, t3) || t3 != i3 ||
+        s4.tryInverse(0.0f, t4) || t4 != i4)
+    {
+        return;
+    }
+
+    // A nearly singular matrix passes an exact test, but not one with an
+    // epsilon.
+    mat4 n4(LibMatrix::Mat4::scale(1.0f, 1.0e-7f, 1.0f));
+    if (!n4.tryInverse(0.0f, t4) || n4.tryInverse(1.0e-6f, t4))
+    {
+        return;
+    }
+
+    // A singular matrix in the middle of a batch does not stop the rest.
+    std::vector<mat4> batch(8, LibMatrix::Mat4::translate(1.0f, 2.0f, 3.0f));
+    batch[3] = s4;
+    std::vector<mat4> inverses(batch.size());
+    unsigned int failures(0);
+    for (unsigned int i = 0; i < batch.size(); i++)
+    {
+        if (!batch[i].tryInverse(1.0e-6f, inverses[i]))
+        {
+            failures++;
+            continue;
+        }
+        if (identityError(batch[i], inverses[i]) > 1.0e-6f)
+        {
+            return;
+        }
+    }
+
+    if (options.beVerbose())
+    {
+        cout << "Batch of " << batch.size() << " matrices had " << failures
+             << " singular input(s) (should be 1)." << endl;
+    }
+
+    pass_ = (failures == 1);
+}
@@ -36,4 +36,32 @@ public:
     virtual void run(const Options& options);
 };
 
+class MatrixTest4x4InverseCompare : public MatrixTest
+{
+public:
+    MatrixTest4x4InverseCompare() : MatrixTest("mat4::inverse (vs. minors)") {}
+    virtual void run(const Options& options);
+};
+
+class MatrixTest4x4InverseAffine : public MatrixTest
+{
+public:
+    MatrixTest4x4InverseAffine() : MatrixTest("mat4::inverseAffine") {}
+    virtual void run(const Options& options);
+};
+
+class MatrixTest4x4InverseRigid : public MatrixTest
+{
+public:
+    MatrixTest4x4InverseRigid() : MatrixTest("mat4::inverseRigid") {}
+    virtual void run(const Options& options);
+};
+
+class MatrixTestTryInverse : public MatrixTest
+{
+public:
+    MatrixTestTryInverse() : MatrixTest("mat::tryInverse") {}
+    virtual void run(const Options& options);
+};
+
 #endif // INVERSE_TEST_H_
@@ -0,0 +1,79 @@
+//
+// Copyright (c) 2013 Linaro Limited
+//
+// All rights reserved. This program and the accompanying materials
+// are made available under the terms of the MIT License which accompanies
+// this distribution, and is available at
+// http://www.opensource.org/licenses/mit-license.php
+//
+// Contributors:
+//     Jesse Barker - original implementation.
+//
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include "libmatrix_test.h"
+#include "libmatrix_bench.h"
+#include "aligned_bench.h"
+#include "copy_bench.h"
+#include "init_bench.h"
+#include "generator_bench.h"
+#include "stack_bench.h"
+#include "hierarchy_bench.h"
+#include "quat_bench.h"
+#include "fastmath_bench.h"
+#include "vector_bench.h"
+#include "cull_bench.h"
+
+using std::cout;
+using std::endl;
+
+void
+MatrixBench::report(const std::string& label, uint64_t elapsed, unsigned int count) const
+{
+    double ns(count ? (elapsed * 1000.0) / count : 0.0);
+    cout << "    " << std::left << std::setw(40) << label << std::right
+         << std::setw(10) << std::fixed << std::setprecision(2) << ns
+         << " ns/item" << endl;
+}
+
+int
+main(int argc, char** argv)
+{
+    Options benchOptions("matrix_bench");
+    benchOptions.parseArgs(argc, argv);
+    if (benchOptions.showHelp())
+    {
+        benchOptions.printUsage();
+        return 0;
+    }
+
+    using std::vector;
+    vector<MatrixBench*> benchVec;
+    benchVec.push_back(new AlignedBenchMultiply());
+    benchVec.push_back(new CopyBenchVector());
+    benchVec.push_back(new InitBenchConstruct());
+    benchVec.push_back(new InitBenchMultiply());
+    benchVec.push_back(new GeneratorBench());
+    benchVec.push_back(new StackBenchModel());
+    benchVec.push_back(new StackBenchDerived());
+    benchVec.push_back(new HierarchyBench());
+    benchVec.push_back(new QuatBench());
+    benchVec.push_back(new QuatBenchSkinning());
+    benchVec.push_back(new FastMathBench());
+    benchVec.push_back(new VectorBench());
+    benchVec.push_back(new CullBench());
+
+    for (vector<MatrixBench*>::iterator benchIt = benchVec.begin();
+         benchIt != benchVec.end();
+         benchIt++)
+    {
+        MatrixBench* curBench = *benchIt;
+        cout << curBench->name() << ":" << endl;
+        curBench->run(benchOptions);
+        delete curBench;
+    }
+
+    return 0;
+}
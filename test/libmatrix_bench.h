@@ -0,0 +1,78 @@
+//
+// Copyright (c) 2013 Linaro Limited
+//
+// All rights reserved. This program and the accompanying materials
+// are made available under the terms of the MIT License which accompanies
+// this distribution, and is available at
+// http://www.opensource.org/licenses/mit-license.php
+//
+// Contributors:
+//     Jesse Barker - original implementation.
+//
+#ifndef LIBMATRIX_BENCH_H_
+#define LIBMATRIX_BENCH_H_
+
+#include <string>
+#include <stdint.h>
+#include "../util.h"
+
+class Options;
+
+// For the ops of a benchmark.  Each pass over the data is then a separate
+// call, so that the compiler cannot drop the passes whose results are
+// overwritten by the next, or share the work between them.  GCC's noipa
+// also keeps it from using what it learns about the callee at the call
+// sites (such as which elements of a result are read), which noinline
+// alone does not.
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 8
+#define OUT_OF_LINE __attribute__((noipa))
+#elif defined(__GNUC__)
+#define OUT_OF_LINE __attribute__((noinline))
+#else
+#define OUT_OF_LINE
+#endif
+
+// A micro-benchmark.  Unlike the tests, these always print their results,
+// and are only run by "make bench".
+class MatrixBench
+{
+    std::string name_;
+protected:
+    MatrixBench();
+    // Print the time per item of a run over 'count' items that took
+    // 'elapsed' microseconds.
+    void report(const std::string& label, uint64_t elapsed, unsigned int count) const;
+public:
+    MatrixBench(const std::string& name) :
+        name_(name) {}
+
+    // The number of times fastest() runs a benchmark.
+    static const unsigned int numReps = 8;
+
+    // Call op() numReps times and return the time taken by the fastest
+    // call, in microseconds.  The slower calls are the ones disturbed by
+    // the rest of the system.  Static, so that the helpers of each
+    // benchmark can use it too.
+    template<typename Op>
+    static uint64_t fastest(Op& op)
+    {
+        uint64_t best(0);
+        for (unsigned int rep = 0; rep < numReps; rep++)
+        {
+            uint64_t start(Util::get_timestamp_us());
+            op();
+            uint64_t elapsed(Util::get_timestamp_us() - start);
+            if (rep == 0 || elapsed < best)
+            {
+                best = elapsed;
+            }
+        }
+        return best;
+    }
+
+    virtual ~MatrixBench() {}
+    const std::string& name() const { return name_; }
+    virtual void run(const Options& options) = 0;
+};
+
+#endif // LIBMATRIX_BENCH_H_
@@ -16,7 +16,20 @@
 #include "libmatrix_test.h"
 #include "inverse_test.h"
 #include "transpose_test.h"
+#include "access_test.h"
+#include "stack_test.h"
+#include "hierarchy_test.h"
+#include "quat_test.h"
+#include "fastmath_test.h"
+#include "multiply_test.h"
+#include "batch_test.h"
+#include "cull_test.h"
+#include "soa_test.h"
+#include "thread_pool_test.h"
+#include "aligned_test.h"
+#include "expr_test.h"
 #include "const_vec_test.h"
+#include "constexpr_test.h"
 #include "shader_source_test.h"
 #include "util_split_test.h"
 
@@ -40,9 +53,51 @@ main(int argc, char** argv)
     testVec.push_back(new MatrixTest2x2Inverse());
     testVec.push_back(new MatrixTest3x3Inverse());
     testVec.push_back(new MatrixTest4x4Inverse());
+    testVec.push_back(new MatrixTest4x4InverseCompare());
+    testVec.push_back(new MatrixTest4x4InverseAffine());
+    testVec.push_back(new MatrixTest4x4InverseRigid());
+    testVec.push_back(new MatrixTestTryInverse());
     testVec.push_back(new MatrixTest2x2Transpose());
     testVec.push_back(new MatrixTest3x3Transpose());
     testVec.push_back(new MatrixTest4x4Transpose());
+    testVec.push_back(new AccessTestElements());
+    testVec.push_back(new AccessTestGenerators());
+    testVec.push_back(new StackTestCompose());
+    testVec.push_back(new StackTestInPlace());
+    testVec.push_back(new StackTestFixed());
+    testVec.push_back(new StackTestCache());
+    testVec.push_back(new StackTestDouble());
+    testVec.push_back(new HierarchyTestUpdate());
+    testVec.push_back(new HierarchyTestParallel());
+    testVec.push_back(new QuatTestConvert());
+    testVec.push_back(new QuatTestMultiply());
+    testVec.push_back(new QuatTestInterpolate());
+    testVec.push_back(new QuatTestDual());
+    testVec.push_back(new QuatTestBlend());
+    testVec.push_back(new FastMathTestKernels());
+    testVec.push_back(new FastMathTestTransforms());
+    testVec.push_back(new MatrixTest4x4Multiply());
+    testVec.push_back(new MatrixTest4x4MultiplyDouble());
+    testVec.push_back(new MatrixTest4x4MultiplyInt());
+    testVec.push_back(new BatchTestMultiply());
+    testVec.push_back(new BatchTestMultiplyDouble());
+    testVec.push_back(new BatchTestTransform());
+    testVec.push_back(new BatchTestTransformDouble());
+    testVec.push_back(new BatchTestVectors());
+    testVec.push_back(new BatchTestVectorsDouble());
+    testVec.push_back(new CullTestPlanes());
+    testVec.push_back(new CullTestBatch());
+    testVec.push_back(new SoaTestConvert());
+    testVec.push_back(new SoaTestVector());
+    testVec.push_back(new SoaTestMatrix());
+    testVec.push_back(new ThreadPoolTestParallelFor());
+    testVec.push_back(new ThreadPoolTestBatch());
+    testVec.push_back(new AlignedTestLayout());
+    testVec.push_back(new AlignedTestBatch());
+    testVec.push_back(new ExprTestVector());
+    testVec.push_back(new ExprTestMatrix());
+    testVec.push_back(new ConstexprTestVector());
+    testVec.push_back(new ConstexprTestMatrix());
     testVec.push_back(new ShaderSourceBasic());
     testVec.push_back(new UtilSplitTestNormal());
     testVec.push_back(new UtilSplitTestQuoted());
@@ -12,6 +12,9 @@
 #ifndef LIBMATRIX_TEST_H_
 #define LIBMATRIX_TEST_H_
 
+#include <math.h>
+#include "../mat.h"
+
 class Options
 {
     Options();
@@ -48,4 +51,23 @@ public:
     const bool passed() const { return pass_; }
 };
 
+// Largest element-wise difference between a and b.
+inline float
+maxDifference(const LibMatrix::mat4& a, const LibMatrix::mat4& b)
+{
+    float diff(0.0f);
+    for (unsigned int r = 0; r < 4; r++)
+    {
+        for (unsigned int c = 0; c < 4; c++)
+        {
+            float d(fabs(a[r][c] - b[r][c]));
+            if (d > diff)
+            {
+                diff = d;
+            }
+        }
+    }
+    return diff;
+}
+
 #endif // LIBMATRIX_TEST_H_
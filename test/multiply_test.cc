@@ -0,0 +1,119 @@
+//
+// Copyright (c) 2013 Linaro Limited
+//
+// All rights reserved. This program and the accompanying materials
+// are made available under the terms of the MIT License which accompanies
+// this distribution, and is available at
+// http://www.opensource.org/licenses/mit-license.php
+//
+// Contributors:
+//     Jesse Barker - original implementation.
+//
+#include <iostream>
+#include "libmatrix_test.h"
+#include "multiply_test.h"
+#include "../mat.h"
+
+using LibMatrix::mat4;
+using LibMatrix::dmat4;
+using LibMatrix::imat4;
+using std::cout;
+using std::endl;
+
+// Fill a matrix with distinct, non-trivial values so that every element of
+// a product depends on a different set of inputs.
+template<typename T>
+static void
+fill(LibMatrix::tmat4<T>& m, int seed)
+{
+    for (unsigned int c = 0; c < 4; c++)
+    {
+        for (unsigned int r = 0; r < 4; r++)
+        {
+            m[r][c] = static_cast<T>(((seed + 3 * c + 7 * r) % 11) - 5);
+        }
+    }
+}
+
+// Straightforward row-times-column product, used as the reference for the
+// (possibly vectorized) member operators.
+template<typename T>
+static LibMatrix::tmat4<T>
+reference(const LibMatrix::tmat4<T>& a, const LibMatrix::tmat4<T>& b)
+{
+    LibMatrix::tmat4<T> p;
+    for (unsigned int r = 0; r < 4; r++)
+    {
+        for (unsigned int c = 0; c < 4; c++)
+        {
+            T sum(0);
+            for (unsigned int k = 0; k < 4; k++)
+            {
+                sum += a[r][k] * b[k][c];
+            }
+            p[r][c] = sum;
+        }
+    }
+    return p;
+}
+
+template<typename T>
+static bool
+checkMultiply(const Options& options)
+{
+    LibMatrix::tmat4<T> a;
+    LibMatrix::tmat4<T> b;
+    fill(a, 1);
+    fill(b, 4);
+    LibMatrix::tmat4<T> expected(reference(a, b));
+
+    LibMatrix::tmat4<T> product(a);
+    product *= b;
+
+    if (options.beVerbose())
+    {
+        cout << "Product: " << endl << endl;
+        product.print();
+        cout << endl << "Expected: " << endl << endl;
+        expected.print();
+    }
+
+    if (product != expected)
+    {
+        return false;
+    }
+
+    // The operands may alias the result.
+    LibMatrix::tmat4<T> square(a);
+    square *= square;
+    if (square != reference(a, a))
+    {
+        return false;
+    }
+
+    // Identity is neutral on both sides.
+    LibMatrix::tmat4<T> ident;
+    LibMatrix::tmat4<T> left(ident);
+    left *= a;
+    LibMatrix::tmat4<T> right(a);
+    right *= ident;
+    return left == a && right == a;
+}
+
+void
+MatrixTest4x4Multiply::run(const Options& options)
+{
+    pass_ = checkMultiply<float>(options);
+}
+
+void
+MatrixTest4x4MultiplyDouble::run(const Options& options)
+{
+    pass_ = checkMultiply<double>(options);
+}
+
+void
+MatrixTest4x4MultiplyInt::run(const Options& options)
+{
+    pass_ = checkMultiply<int>(options);
+}
@@ -0,0 +1,39 @@
+//
+// Copyright (c) 2013 Linaro Limited
+//
+// All rights reserved. This program and the accompanying materials
+// are made available under the terms of the MIT License which accompanies
+// this distribution, and is available at
+// http://www.opensource.org/licenses/mit-license.php
+//
+// Contributors:
+//     Jesse Barker - original implementation.
+//
+#ifndef MULTIPLY_TEST_H_
+#define MULTIPLY_TEST_H_
+
+class MatrixTest;
+class Options;
+
+class MatrixTest4x4Multiply : public MatrixTest
+{
+public:
+    MatrixTest4x4Multiply() : MatrixTest("mat4::multiply") {}
+    virtual void run(const Options& options);
+};
+
+class MatrixTest4x4MultiplyDouble : public MatrixTest
+{
+public:
+    MatrixTest4x4MultiplyDouble() : MatrixTest("dmat4::multiply") {}
+    virtual void run(const Options& options);
+};
+
+class MatrixTest4x4MultiplyInt : public MatrixTest
+{
+public:
+    MatrixTest4x4MultiplyInt() : MatrixTest("imat4::multiply") {}
+    virtual void run(const Options& options);
+};
+
+#endif // MULTIPLY_TEST_H_
@@ -0,0 +1,262 @@
+//
+// Copyright (c) 2013 Linaro Limited
+//
+// All rights reserved. This program and the accompanying materials
+// are made available under the terms of the MIT License which accompanies
+// this distribution, and is available at
+// http://www.opensource.org/licenses/mit-license.php
+//
+// Contributors:
+//     Jesse Barker - original implementation.
+//
+#include <string>
+#include <vector>
+#include "libmatrix_test.h"
+#include "libmatrix_bench.h"
+#include "quat_bench.h"
+#include "../batch.h"
+#include "../quat.h"
+
+using LibMatrix::mat4;
+using LibMatrix::quat;
+using LibMatrix::dualquat;
+using LibMatrix::vec3;
+using std::vector;
+
+namespace
+{
+
+const unsigned int count(1024);
+const unsigned int numPasses(4096);
+
+// The rotations being worked on, as both matrices and quaternions.
+struct Rotations
+{
+    Rotations() :
+        angles(count), axes(count), matA(count), matB(count), matOut(count),
+        quatA(count), quatB(count), quatOut(count)
+    {
+        for (unsigned int i = 0; i < count; i++)
+        {
+            angles[i] = static_cast<float>(i % 360);
+            axes[i] = vec3(1.0f, static_cast<float>(i % 7), 2.0f);
+            quatA[i] = quat(angles[i], axes[i]);
+            quatB[i] = quat(-angles[i] / 2, vec3(0.0f, 1.0f, 0.0f));
+            matA[i] = quatA[i].toMat4();
+            matB[i] = quatB[i].toMat4();
+        }
+    }
+    vector<float> angles;
+    vector<vec3> axes;
+    vector<mat4> matA;
+    vector<mat4> matB;
+    vector<mat4> matOut;
+    vector<quat> quatA;
+    vector<quat> quatB;
+    vector<quat> quatOut;
+};
+
+struct ComposeMatrices
+{
+    static OUT_OF_LINE void run(Rotations& r)
+    {
+        LibMatrix::Batch::multiply(&r.matOut[0], &r.matA[0], &r.matB[0], count);
+    }
+};
+
+struct ComposeQuaternions
+{
+    static OUT_OF_LINE void run(Rotations& r)
+    {
+        LibMatrix::Batch::multiply(&r.quatOut[0], &r.quatA[0], &r.quatB[0], count);
+    }
+};
+
+struct BuildMatrices
+{
+    static OUT_OF_LINE void run(Rotations& r)
+    {
+        for (unsigned int i = 0; i < count; i++)
+        {
+            const vec3& axis(r.axes[i]);
+            r.matOut[i] = LibMatrix::Mat4::rotate(r.angles[i], axis.x(), axis.y(), axis.z());
+        }
+    }
+};
+
+struct BuildQuaternions
+{
+    static OUT_OF_LINE void run(Rotations& r)
+    {
+        for (unsigned int i = 0; i < count; i++)
+        {
+            r.quatOut[i] = quat(r.angles[i], r.axes[i]);
+        }
+    }
+};
+
+struct ConvertQuaternions
+{
+    static OUT_OF_LINE void run(Rotations& r)
+    {
+        LibMatrix::Batch::toMat4(&r.matOut[0], &r.quatA[0], count);
+    }
+};
+
+struct Slerp
+{
+    static OUT_OF_LINE void run(Rotations& r)
+    {
+        LibMatrix::Batch::slerp(&r.quatOut[0], &r.quatA[0], &r.quatB[0], 0.3f, count);
+    }
+};
+
+struct Nlerp
+{
+    static OUT_OF_LINE void run(Rotations& r)
+    {
+        LibMatrix::Batch::nlerp(&r.quatOut[0], &r.quatA[0], &r.quatB[0], 0.3f, count);
+    }
+};
+
+// Runs Op on 'w', 'passes' times.
+template<typename Op, typename Work>
+class Passes
+{
+public:
+    Passes(Work& w, unsigned int passes) :
+        w_(w), passes_(passes) {}
+    void operator()()
+    {
+        for (unsigned int pass = 0; pass < passes_; pass++)
+        {
+            Op::run(w_);
+        }
+    }
+private:
+    Work& w_;
+    unsigned int passes_;
+};
+
+template<typename Op>
+uint64_t
+timeOp(Rotations& r)
+{
+    Passes<Op, Rotations> op(r, numPasses);
+    return MatrixBench::fastest(op);
+}
+
+} // namespace
+
+void
+QuatBench::run(const Options&)
+{
+    Rotations r;
+    unsigned int items(count * numPasses);
+    report("compose, Batch::multiply (mat4)", timeOp<ComposeMatrices>(r), items);
+    report("compose, Batch::multiply (quat)", timeOp<ComposeQuaternions>(r), items);
+    report("from angle and axis, Mat4::rotate", timeOp<BuildMatrices>(r), items);
+    report("from angle and axis, quat", timeOp<BuildQuaternions>(r), items);
+    report("quat to mat4, Batch::toMat4", timeOp<ConvertQuaternions>(r), items);
+    report("interpolate, Batch::slerp", timeOp<Slerp>(r), items);
+    report("interpolate, Batch::nlerp", timeOp<Nlerp>(r), items);
+}
+
+namespace
+{
+
+const unsigned int numBones(64);
+const unsigned int numInfluences(4);
+const unsigned int numVertices(4096);
+
+// A bone palette as both matrices and dual quaternions, and the bones and
+// weights for each vertex.
+struct Skin
+{
+    Skin() :
+        matPalette(numBones), dqPalette(numBones),
+        bones(numVertices * numInfluences), weights(numVertices * numInfluences),
+        matOut(numVertices), dqOut(numVertices)
+    {
+        for (unsigned int i = 0; i < numBones; i++)
+        {
+            vec3 t(static_cast<float>(i), 1.0f, -2.0f);
+            quat r(static_cast<float>(i * 5), vec3(1.0f, static_cast<float>(i % 3), 0.5f));
+            dqPalette[i] = dualquat(r, t);
+            matPalette[i] = dqPalette[i].toMat4();
+        }
+        for (unsigned int v = 0; v < numVertices; v++)
+        {
+            for (unsigned int k = 0; k < numInfluences; k++)
+            {
+                bones[v * numInfluences + k] = (v * 7 + k * 13) % numBones;
+                weights[v * numInfluences + k] = k == 0 ? 0.4f : 0.2f;
+            }
+        }
+    }
+    vector<mat4> matPalette;
+    vector<dualquat> dqPalette;
+    vector<unsigned int> bones;
+    vector<float> weights;
+    vector<mat4> matOut;
+    vector<dualquat> dqOut;
+};
+
+// Linear blend skinning, summing the weighted bone matrices.
+struct BlendMatrices
+{
+    static OUT_OF_LINE void run(Skin& s)
+    {
+        for (unsigned int v = 0; v < numVertices; v++)
+        {
+            const unsigned int* b(&s.bones[v * numInfluences]);
+            const float* w(&s.weights[v * numInfluences]);
+            mat4 m(s.matPalette[b[0]] * w[0]);
+            for (unsigned int k = 1; k < numInfluences; k++)
+            {
+                m += s.matPalette[b[k]] * w[k];
+            }
+            s.matOut[v] = m;
+        }
+    }
+};
+
+struct BlendDualQuaternions
+{
+    static OUT_OF_LINE void run(Skin& s)
+    {
+        LibMatrix::Batch::blend(&s.dqOut[0], &s.dqPalette[0], &s.bones[0], &s.weights[0],
+                                numInfluences, numVertices);
+    }
+};
+
+// The same, followed by conversion to matrices for a shader that takes
+// a matrix per vertex.
+struct BlendDualQuaternionsToMatrices
+{
+    static OUT_OF_LINE void run(Skin& s)
+    {
+        BlendDualQuaternions::run(s);
+        LibMatrix::Batch::toMat4(&s.matOut[0], &s.dqOut[0], numVertices);
+    }
+};
+
+template<typename Op>
+uint64_t
+timeSkin(Skin& s)
+{
+    Passes<Op, Skin> op(s, numPasses / 4);
+    return MatrixBench::fastest(op);
+}
+
+} // namespace
+
+void
+QuatBenchSkinning::run(const Options&)
+{
+    Skin s;
+    unsigned int items(numVertices * (numPasses / 4));
+    report("mat4 linear blend", timeSkin<BlendMatrices>(s), items);
+    report("Batch::blend (dualquat)", timeSkin<BlendDualQuaternions>(s), items);
+    report("Batch::blend, then Batch::toMat4", timeSkin<BlendDualQuaternionsToMatrices>(s), items);
+}
@@ -0,0 +1,32 @@
+//
+// Copyright (c) 2013 Linaro Limited
+//
+// All rights reserved. This program and the accompanying materials
+// are made available under the terms of the MIT License which accompanies
+// this distribution, and is available at
+// http://www.opensource.org/licenses/mit-license.php
+//
+// Contributors:
+//     Jesse Barker - original implementation.
+//
+#ifndef QUAT_BENCH_H_
+#define QUAT_BENCH_H_
+
+class MatrixBench;
+class Options;
+
+class QuatBench : public MatrixBench
+{
+public:
+    QuatBench() : MatrixBench("tquat vs mat4 rotations") {}
+    virtual void run(const Options& options);
+};
+
+class QuatBenchSkinning : public MatrixBench
+{
+public:
+    QuatBenchSkinning() : MatrixBench("Skinning blends, 4 bones per vertex") {}
+    virtual void run(const Options& options);
+};
+
+#endif // QUAT_BENCH_H_
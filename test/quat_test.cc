@@ -0,0 +1,323 @@
+//
+// Copyright (c) 2013 Linaro Limited
+//
+// All rights reserved. This program and the accompanying materials
+// are made available under the terms of the MIT License which accompanies
+// this distribution, and is available at
+// http://www.opensource.org/licenses/mit-license.php
+//
+// Contributors:
+//     Jesse Barker - original implementation.
+//
+#include <iostream>
+#include <math.h>
+#include "libmatrix_test.h"
+#include "quat_test.h"
+#include "../quat.h"
+#include "../stack.h"
+
+using LibMatrix::mat3;
+using LibMatrix::mat4;
+using LibMatrix::vec3;
+using LibMatrix::quat;
+using LibMatrix::dualquat;
+using LibMatrix::Stack4;
+using std::cout;
+using std::endl;
+
+// q and -q are the same rotation.
+static float
+maxDifference(const quat& a, const quat& b)
+{
+    float sign(quat::dot(a, b) < 0 ? -1.0f : 1.0f);
+    float diff(0.0f);
+    for (unsigned int i = 0; i < 4; i++)
+    {
+        float d(fabs(a[i] - b[i] * sign));
+        if (d > diff)
+        {
+            diff = d;
+        }
+    }
+    return diff;
+}
+
+static float
+maxDifference(const vec3& a, const vec3& b)
+{
+    vec3 d(a - b);
+    return fmax(fabs(d.x()), fmax(fabs(d.y()), fabs(d.z())));
+}
+
+void
+QuatTestConvert::run(const Options& options)
+{
+    // Include angles near 180 degrees, where the trace of the matrix is
+    // negative, about each axis in turn.
+    static const float angles[] = { 0.0f, 30.0f, 90.0f, 179.0f, 180.0f, -135.0f };
+    static const vec3 axes[] = { vec3(1.0f, 0.0f, 0.0f), vec3(0.0f, 1.0f, 0.0f),
+                                 vec3(0.0f, 0.0f, 1.0f), vec3(1.0f, 2.0f, -3.0f) };
+    float matrixError(0.0f);
+    float roundTripError(0.0f);
+    for (unsigned int a = 0; a < sizeof(angles) / sizeof(angles[0]); a++)
+    {
+        for (unsigned int i = 0; i < sizeof(axes) / sizeof(axes[0]); i++)
+        {
+            const vec3& axis(axes[i]);
+            quat q(angles[a], axis);
+            mat4 expected(LibMatrix::Mat4::rotate(angles[a], axis.x(), axis.y(), axis.z()));
+            matrixError = fmax(matrixError, maxDifference(q.toMat4(), expected));
+            matrixError = fmax(matrixError, maxDifference(LibMatrix::Mat4::rotate(q), expected));
+            roundTripError = fmax(roundTripError, maxDifference(quat(expected), q));
+            roundTripError = fmax(roundTripError, maxDifference(quat(q.toMat3()), q));
+        }
+    }
+
+    if (options.beVerbose())
+    {
+        cout << "Largest errors: to matrix " << matrixError
+             << ", from matrix " << roundTripError << endl;
+    }
+    if (matrixError > 1.0e-6f || roundTripError > 1.0e-6f)
+    {
+        return;
+    }
+
+    pass_ = true;
+}
+
+void
+QuatTestMultiply::run(const Options& options)
+{
+    const quat a(40.0f, vec3(0.0f, 1.0f, 1.0f));
+    const quat b(-70.0f, vec3(1.0f, 0.5f, 0.0f));
+    mat4 expected(a.toMat4() * b.toMat4());
+    float productError(maxDifference((a * b).toMat4(), expected));
+
+    const vec3 v(1.0f, -2.0f, 0.5f);
+    vec3 rotated(a * v);
+    LibMatrix::vec4 expectedRotated(a.toMat4() * LibMatrix::vec4(v.x(), v.y(), v.z(), 0.0f));
+    float rotateError(maxDifference(rotated, vec3(expectedRotated.x(), expectedRotated.y(),
+                                                  expectedRotated.z())));
+    float inverseError(maxDifference(a * a.conjugate(), quat()));
+
+    // The batch product must match the single one exactly.
+    quat lhs[3] = { a, b, a * b };
+    quat rhs[3] = { b, a, b };
+    quat out[3];
+    LibMatrix::Batch::multiply(out, lhs, rhs, 3);
+    bool batchMatches(true);
+    for (unsigned int i = 0; i < 3; i++)
+    {
+        quat single(lhs[i] * rhs[i]);
+        for (unsigned int j = 0; j < 4; j++)
+        {
+            batchMatches = batchMatches && out[i][j] == single[j];
+        }
+    }
+
+    // Stack4 takes quaternions directly.
+    Stack4 stack;
+    stack *= LibMatrix::Mat4::perspective(60.0f, 1.5f, 1.0f, 100.0f);
+    mat4 stackExpected(stack.getCurrent());
+    stack.rotate(a);
+    stackExpected *= LibMatrix::Mat4::rotate(40.0f, 0.0f, 1.0f, 1.0f);
+    const vec3 t(1.0f, 2.0f, 3.0f);
+    const vec3 s(2.0f, 2.0f, 0.5f);
+    stack.compose(t, b, s);
+    stackExpected *= LibMatrix::Mat4::compose(t, -70.0f, vec3(1.0f, 0.5f, 0.0f), s);
+    float stackError(maxDifference(stack.getCurrent(), stackExpected));
+
+    if (options.beVerbose())
+    {
+        cout << "Largest errors: product " << productError
+             << ", rotate " << rotateError
+             << ", inverse " << inverseError
+             << ", Stack4 " << stackError << endl;
+        if (!batchMatches)
+        {
+            cout << "Batch::multiply() differs from operator*." << endl;
+        }
+    }
+    if (productError > 1.0e-6f || rotateError > 1.0e-5f || inverseError > 1.0e-6f ||
+        stackError > 1.0e-5f || !batchMatches)
+    {
+        return;
+    }
+
+    pass_ = true;
+}
+
+void
+QuatTestInterpolate::run(const Options& options)
+{
+    const vec3 axis(1.0f, 1.0f, 1.0f);
+    const quat a(10.0f, axis);
+    const quat b(130.0f, axis);
+
+    // About a common axis, slerp moves at a constant angular rate.
+    float slerpError(0.0f);
+    for (unsigned int i = 0; i <= 4; i++)
+    {
+        float t(i / 4.0f);
+        slerpError = fmax(slerpError, maxDifference(LibMatrix::slerp(a, b, t),
+                                                    quat(10.0f + 120.0f * t, axis)));
+    }
+
+    // Both go the short way around, so -b gives the same results.
+    const quat minusB(-b.x(), -b.y(), -b.z(), -b.w());
+    float shortArcError(maxDifference(LibMatrix::slerp(a, minusB, 0.5f), quat(70.0f, axis)));
+    shortArcError = fmax(shortArcError, maxDifference(LibMatrix::nlerp(a, minusB, 0.5f),
+                                                      LibMatrix::nlerp(a, b, 0.5f)));
+
+    // nlerp agrees at the midpoint and yields unit quaternions.
+    float nlerpError(maxDifference(LibMatrix::nlerp(a, b, 0.5f), quat(70.0f, axis)));
+    nlerpError = fmax(nlerpError, fabs(LibMatrix::nlerp(a, b, 0.3f).length() - 1.0f));
+
+    // Nearly equal rotations must not produce NaNs.
+    quat nearA(10.001f, axis);
+    quat nearMid(LibMatrix::slerp(a, nearA, 0.5f));
+    bool nearOk(maxDifference(nearMid, a) < 1.0e-5f);
+
+    quat as[2] = { a, b };
+    quat bs[2] = { b, a };
+    quat out[2];
+    LibMatrix::Batch::slerp(out, as, bs, 0.25f, 2);
+    float batchError(fmax(maxDifference(out[0], LibMatrix::slerp(a, b, 0.25f)),
+                          maxDifference(out[1], LibMatrix::slerp(b, a, 0.25f))));
+    quat scaled[2] = { quat(0.0f, 0.0f, 2.0f, 0.0f), quat(1.0f, 1.0f, 1.0f, 1.0f) };
+    LibMatrix::Batch::normalize(scaled, scaled, 2);
+    batchError = fmax(batchError, maxDifference(scaled[0], quat(0.0f, 0.0f, 1.0f, 0.0f)));
+    batchError = fmax(batchError, maxDifference(scaled[1], quat(0.5f, 0.5f, 0.5f, 0.5f)));
+
+    if (options.beVerbose())
+    {
+        cout << "Largest errors: slerp " << slerpError
+             << ", short arc " << shortArcError
+             << ", nlerp " << nlerpError
+             << ", batch " << batchError << endl;
+        if (!nearOk)
+        {
+            cout << "slerp() of nearly equal rotations gives:" << endl;
+            nearMid.print();
+        }
+    }
+    if (slerpError > 1.0e-6f || shortArcError > 1.0e-6f || nlerpError > 1.0e-6f ||
+        batchError > 1.0e-6f || !nearOk)
+    {
+        return;
+    }
+
+    pass_ = true;
+}
+
+// The transform of translate(t) * rotate(angle, axis).
+static mat4
+rigid(const vec3& t, float angle, const vec3& axis)
+{
+    mat4 m(LibMatrix::Mat4::translate(t.x(), t.y(), t.z()));
+    m *= LibMatrix::Mat4::rotate(angle, axis.x(), axis.y(), axis.z());
+    return m;
+}
+
+void
+QuatTestDual::run(const Options& options)
+{
+    const vec3 ta(1.0f, -2.0f, 3.0f);
+    const vec3 tb(-0.5f, 4.0f, 2.0f);
+    const vec3 axisA(0.0f, 1.0f, 1.0f);
+    const vec3 axisB(1.0f, 0.5f, -1.0f);
+    const dualquat a(quat(40.0f, axisA), ta);
+    const dualquat b(quat(-110.0f, axisB), tb);
+
+    float matrixError(maxDifference(a.toMat4(), rigid(ta, 40.0f, axisA)));
+    float translationError(maxDifference(a.translation(), ta));
+    float productError(maxDifference((a * b).toMat4(),
+                                     rigid(ta, 40.0f, axisA) * rigid(tb, -110.0f, axisB)));
+
+    const vec3 p(2.0f, 0.5f, -1.0f);
+    LibMatrix::vec4 expectedPoint(a.toMat4() * LibMatrix::vec4(p.x(), p.y(), p.z(), 1.0f));
+    float pointError(maxDifference(a * p, vec3(expectedPoint.x(), expectedPoint.y(),
+                                               expectedPoint.z())));
+    float inverseError(maxDifference((a * a.conjugate()).toMat4(), mat4()));
+
+    // Normalizing scales the rotation back to unit length and removes the
+    // part of the dual that is not orthogonal to it.
+    dualquat skewed(a.real() * 2.0f, a.dual() * 2.0f + a.real() * 0.25f);
+    skewed.normalize();
+    float normalizeError(maxDifference(skewed.toMat4(), a.toMat4()));
+
+    dualquat lhs[2] = { a, b };
+    dualquat rhs[2] = { b, a };
+    dualquat products[2];
+    mat4 matrices[2];
+    LibMatrix::Batch::multiply(products, lhs, rhs, 2);
+    LibMatrix::Batch::toMat4(matrices, products, 2);
+    float batchError(fmax(maxDifference(matrices[0], (a * b).toMat4()),
+                          maxDifference(matrices[1], (b * a).toMat4())));
+
+    if (options.beVerbose())
+    {
+        cout << "Largest errors: matrix " << matrixError
+             << ", translation " << translationError
+             << ", product " << productError
+             << ", point " << pointError
+             << ", inverse " << inverseError
+             << ", normalize " << normalizeError
+             << ", batch " << batchError << endl;
+    }
+    if (matrixError > 1.0e-5f || translationError > 1.0e-5f || productError > 1.0e-5f ||
+        pointError > 1.0e-5f || inverseError > 1.0e-5f || normalizeError > 1.0e-5f ||
+        batchError > 1.0e-6f)
+    {
+        return;
+    }
+
+    pass_ = true;
+}
+
+void
+QuatTestBlend::run(const Options& options)
+{
+    const vec3 axis(0.0f, 0.0f, 1.0f);
+    const vec3 t(1.0f, 2.0f, 3.0f);
+    dualquat palette[3];
+    palette[0] = dualquat(quat(20.0f, axis), t);
+    palette[1] = dualquat(quat(80.0f, axis), t);
+    // The same transform as palette[1], on the other hemisphere.
+    palette[2] = dualquat(palette[1].real() * -1.0f, palette[1].dual() * -1.0f);
+
+    // Two influences per vertex:
+    //   0: all of bone 0
+    //   1: an even blend of bones 0 and 1
+    //   2: the same, with the flipped copy of bone 1
+    //   3: bone 1 then bone 0, weighted 1:3
+    static const unsigned int bones[] = { 0, 1, 0, 1, 0, 2, 1, 0 };
+    static const float weights[] = { 1.0f, 0.0f, 0.5f, 0.5f, 0.5f, 0.5f, 0.25f, 0.75f };
+    dualquat out[4];
+    LibMatrix::Batch::blend(out, palette, bones, weights, 2, 4);
+
+    // Blending rotations about a common axis and centre interpolates the
+    // angle, and keeps the translation.
+    float blendError(maxDifference(out[0].toMat4(), palette[0].toMat4()));
+    blendError = fmax(blendError, maxDifference(out[1].toMat4(), rigid(t, 50.0f, axis)));
+    blendError = fmax(blendError, maxDifference(out[2].toMat4(), out[1].toMat4()));
+    quat expected3(LibMatrix::nlerp(palette[0].real(), palette[1].real(), 0.25f));
+    blendError = fmax(blendError, maxDifference(out[3].rotation(), expected3));
+    float unitError(0.0f);
+    for (unsigned int i = 0; i < 4; i++)
+    {
+        unitError = fmax(unitError, fabs(out[i].real().length() - 1.0f));
+    }
+
+    if (options.beVerbose())
+    {
+        cout << "Largest errors: blend " << blendError << ", unit length " << unitError << endl;
+    }
+    if (blendError > 1.0e-5f || unitError > 1.0e-6f)
+    {
+        return;
+    }
+
+    pass_ = true;
+}
@@ -0,0 +1,53 @@
+//
+// Copyright (c) 2013 Linaro Limited
+//
+// All rights reserved. This program and the accompanying materials
+// are made available under the terms of the MIT License which accompanies
+// this distribution, and is available at
+// http://www.opensource.org/licenses/mit-license.php
+//
+// Contributors:
+//     Jesse Barker - original implementation.
+//
+#ifndef QUAT_TEST_H_
+#define QUAT_TEST_H_
+
+class MatrixTest;
+class Options;
+
+class QuatTestConvert : public MatrixTest
+{
+public:
+    QuatTestConvert() : MatrixTest("tquat conversions") {}
+    virtual void run(const Options& options);
+};
+
+class QuatTestMultiply : public MatrixTest
+{
+public:
+    QuatTestMultiply() : MatrixTest("tquat multiply") {}
+    virtual void run(const Options& options);
+};
+
+class QuatTestInterpolate : public MatrixTest
+{
+public:
+    QuatTestInterpolate() : MatrixTest("tquat slerp/nlerp") {}
+    virtual void run(const Options& options);
+};
+
+class QuatTestDual : public MatrixTest
+{
+public:
+    QuatTestDual() : MatrixTest("tdualquat") {}
+    virtual void run(const Options& options);
+};
+
+class QuatTestBlend : public MatrixTest
+{
+public:
+    QuatTestBlend() : MatrixTest("tdualquat palette blending") {}
+    virtual void run(const Options& options);
+};
+
+#endif // QUAT_TEST_H_
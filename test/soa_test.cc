@@ -0,0 +1,275 @@
+//
+// Copyright (c) 2013 Linaro Limited
+//
+// All rights reserved. This program and the accompanying materials
+// are made available under the terms of the MIT License which accompanies
+// this distribution, and is available at
+// http://www.opensource.org/licenses/mit-license.php
+//
+// Contributors:
+//     Jesse Barker - original implementation.
+//
+#include <iostream>
+#include <vector>
+#include "libmatrix_test.h"
+#include "soa_test.h"
+#include "../soa.h"
+
+using LibMatrix::vec3;
+using LibMatrix::vec4;
+using LibMatrix::mat4;
+using LibMatrix::vec3_soa;
+using LibMatrix::vec4_soa;
+using LibMatrix::mat4_soa;
+using std::cout;
+using std::endl;
+using std::vector;
+
+// Not a multiple of any vector register width, to cover the tails.
+static const unsigned int numElements(23);
+
+static float
+nextValue(unsigned int& seed)
+{
+    seed = seed * 1103515245 + 12345;
+    return static_cast<float>((seed >> 16) & 0x7fff) / 4096.0f - 4.0f;
+}
+
+static bool
+close(float a, float b)
+{
+    float diff(fabs(a - b));
+    float scale(fabs(a) > 1.0f ? fabs(a) : 1.0f);
+    return diff <= 1.0e-5f * scale;
+}
+
+static bool
+close(const vec3& a, const vec3& b)
+{
+    return close(a.x(), b.x()) && close(a.y(), b.y()) && close(a.z(), b.z());
+}
+
+static bool
+close(const vec4& a, const vec4& b)
+{
+    return close(a.x(), b.x()) && close(a.y(), b.y()) &&
+           close(a.z(), b.z()) && close(a.w(), b.w());
+}
+
+static void
+fill(vector<vec3>& v, unsigned int seed)
+{
+    v.resize(numElements);
+    for (unsigned int i = 0; i < numElements; i++)
+    {
+        float x(nextValue(seed));
+        float y(nextValue(seed));
+        float z(nextValue(seed));
+        v[i] = vec3(x, y, z);
+    }
+}
+
+static void
+fill(vector<vec4>& v, unsigned int seed)
+{
+    v.resize(numElements);
+    for (unsigned int i = 0; i < numElements; i++)
+    {
+        float x(nextValue(seed));
+        float y(nextValue(seed));
+        float z(nextValue(seed));
+        float w(nextValue(seed));
+        v[i] = vec4(x, y, z, w);
+    }
+}
+
+static void
+fill(vector<mat4>& v, unsigned int seed)
+{
+    v.resize(numElements);
+    for (unsigned int i = 0; i < numElements; i++)
+    {
+        for (unsigned int r = 0; r < 4; r++)
+        {
+            for (unsigned int c = 0; c < 4; c++)
+            {
+                v[i][r][c] = nextValue(seed);
+            }
+        }
+    }
+}
+
+void
+SoaTestConvert::run(const Options& options)
+{
+    vector<vec3> v3;
+    vector<vec4> v4;
+    vector<mat4> m4;
+    fill(v3, 1);
+    fill(v4, 2);
+    fill(m4, 3);
+
+    vec3_soa s3;
+    vec4_soa s4;
+    mat4_soa sm;
+    s3.load(&v3[0], numElements);
+    s4.load(&v4[0], numElements);
+    sm.load(&m4[0], numElements);
+
+    // Every stream has to be aligned for the vector kernels.
+    for (unsigned int s = 0; s < 16; s++)
+    {
+        if (reinterpret_cast<unsigned long>(sm.stream(s)) % 64)
+        {
+            return;
+        }
+    }
+
+    vector<vec3> r3(numElements);
+    vector<vec4> r4(numElements);
+    vector<mat4> rm(numElements);
+    s3.store(&r3[0]);
+    vec4_soa copy(s4);
+    copy.store(&r4[0]);
+    sm.store(&rm[0]);
+
+    for (unsigned int i = 0; i < numElements; i++)
+    {
+        if (r3[i].x() != v3[i].x() || r3[i].y() != v3[i].y() || r3[i].z() != v3[i].z() ||
+            r4[i].x() != v4[i].x() || r4[i].w() != v4[i].w() ||
+            rm[i] != m4[i])
+        {
+            if (options.beVerbose())
+            {
+                cout << "Element " << i << " did not survive the round trip." << endl;
+            }
+            return;
+        }
+    }
+
+    // Growing keeps the existing elements and zeroes the new ones.
+    s3.resize(numElements + 40);
+    if (s3.get(3).x() != v3[3].x() || s3.get(numElements + 39).y() != 0.0f)
+    {
+        return;
+    }
+
+    pass_ = true;
+}
+
+void
+SoaTestVector::run(const Options& options)
+{
+    vector<vec3> a3;
+    vector<vec3> b3;
+    vector<vec4> a4;
+    vector<vec4> b4;
+    fill(a3, 4);
+    fill(b3, 5);
+    fill(a4, 6);
+    fill(b4, 7);
+    vec3_soa sa3;
+    vec3_soa sb3;
+    vec4_soa sa4;
+    vec4_soa sb4;
+    sa3.load(&a3[0], numElements);
+    sb3.load(&b3[0], numElements);
+    sa4.load(&a4[0], numElements);
+    sb4.load(&b4[0], numElements);
+
+    mat4 m(LibMatrix::Mat4::translate(1.0f, 2.0f, 3.0f));
+    m *= LibMatrix::Mat4::rotate(40.0f, 1.0f, 0.5f, 0.0f);
+
+    vec4_soa t4;
+    LibMatrix::Batch::transform(t4, m, sa4);
+    vec3_soa t3;
+    LibMatrix::Batch::transformPoints(t3, m, sa3);
+    vector<float> d3(numElements);
+    LibMatrix::Batch::dot(&d3[0], sa3, sb3);
+    vector<float> d4(numElements);
+    LibMatrix::Batch::dot(&d4[0], sa4, sb4);
+    vec3_soa c3;
+    LibMatrix::Batch::cross(c3, sa3, sb3);
+    vec3_soa n3(sa3);
+    LibMatrix::Batch::normalize(n3);
+    vec4_soa n4(sa4);
+    LibMatrix::Batch::normalize(n4);
+
+    for (unsigned int i = 0; i < numElements; i++)
+    {
+        vec4 p(a3[i].x(), a3[i].y(), a3[i].z(), 1.0f);
+        vec4 tp(m * p);
+        vec3 n(a3[i]);
+        n.normalize();
+        vec4 nn(a4[i]);
+        nn.normalize();
+        if (!close(t4.get(i), m * a4[i]) ||
+            !close(t3.get(i), vec3(tp.x(), tp.y(), tp.z())) ||
+            !close(d3[i], vec3::dot(a3[i], b3[i])) ||
+            !close(d4[i], vec4::dot(a4[i], b4[i])) ||
+            !close(c3.get(i), vec3::cross(a3[i], b3[i])) ||
+            !close(n3.get(i), n) ||
+            !close(n4.get(i), nn))
+        {
+            if (options.beVerbose())
+            {
+                cout << "Vector kernels disagree at element " << i << endl;
+            }
+            return;
+        }
+    }
+
+    // The output may be one of the inputs.
+    LibMatrix::Batch::cross(sa3, sa3, sb3);
+    for (unsigned int i = 0; i < numElements; i++)
+    {
+        if (!close(sa3.get(i), vec3::cross(a3[i], b3[i])))
+        {
+            return;
+        }
+    }
+
+    pass_ = true;
+}
+
+void
+SoaTestMatrix::run(const Options& options)
+{
+    vector<mat4> a;
+    vector<mat4> b;
+    fill(a, 8);
+    fill(b, 9);
+    mat4_soa sa;
+    mat4_soa sb;
+    sa.load(&a[0], numElements);
+    sb.load(&b[0], numElements);
+
+    mat4_soa product;
+    LibMatrix::Batch::multiply(product, sa, sb);
+
+    for (unsigned int i = 0; i < numElements; i++)
+    {
+        mat4 expected(a[i]);
+        expected *= b[i];
+        mat4 actual(product.get(i));
+        for (unsigned int r = 0; r < 4; r++)
+        {
+            for (unsigned int c = 0; c < 4; c++)
+            {
+                if (!close(actual[r][c], expected[r][c]))
+                {
+                    if (options.beVerbose())
+                    {
+                        cout << "Product " << i << " is wrong:" << endl;
+                        actual.print();
+                        cout << "Expected:" << endl;
+                        expected.print();
+                    }
+                    return;
+                }
+            }
+        }
+    }
+
+    pass_ = true;
+}
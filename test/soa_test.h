@@ -0,0 +1,39 @@
+//
+// Copyright (c) 2013 Linaro Limited
+//
+// All rights reserved. This program and the accompanying materials
+// are made available under the terms of the MIT License which accompanies
+// this distribution, and is available at
+// http://www.opensource.org/licenses/mit-license.php
+//
+// Contributors:
+//     Jesse Barker - original implementation.
+//
+#ifndef SOA_TEST_H_
+#define SOA_TEST_H_
+
+class MatrixTest;
+class Options;
+
+class SoaTestConvert : public MatrixTest
+{
+public:
+    SoaTestConvert() : MatrixTest("soa::load/store") {}
+    virtual void run(const Options& options);
+};
+
+class SoaTestVector : public MatrixTest
+{
+public:
+    SoaTestVector() : MatrixTest("soa::vector kernels") {}
+    virtual void run(const Options& options);
+};
+
+class SoaTestMatrix : public MatrixTest
+{
+public:
+    SoaTestMatrix() : MatrixTest("soa::matrix kernels") {}
+    virtual void run(const Options& options);
+};
+
+#endif // SOA_TEST_H_
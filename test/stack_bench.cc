@@ -0,0 +1,204 @@
+//
+// Copyright (c) 2013 Linaro Limited
+//
+// All rights reserved. This program and the accompanying materials
+// are made available under the terms of the MIT License which accompanies
+// this distribution, and is available at
+// http://www.opensource.org/licenses/mit-license.php
+//
+// Contributors:
+//     Jesse Barker - original implementation.
+//
+#include <string>
+#include "libmatrix_test.h"
+#include "libmatrix_bench.h"
+#include "stack_bench.h"
+#include "../stack.h"
+
+using LibMatrix::mat3;
+using LibMatrix::mat4;
+using LibMatrix::vec3;
+using LibMatrix::Stack4;
+using LibMatrix::FixedStack4;
+using LibMatrix::DStack4;
+
+namespace
+{
+
+const unsigned int numItems(1 << 18);
+
+// The ways of applying a node's translate * rotate * scale to the stack.
+struct FullMultiply
+{
+    template<typename Stack>
+    static void apply(Stack& stack, float t)
+    {
+        stack *= LibMatrix::Mat4::translate(t, 2.0f, 3.0f);
+        stack *= LibMatrix::Mat4::rotate(t, 0.0f, 1.0f, 0.0f);
+        stack *= LibMatrix::Mat4::scale(2.0f, 2.0f, 2.0f);
+    }
+};
+
+struct InPlace
+{
+    template<typename Stack>
+    static void apply(Stack& stack, float t)
+    {
+        stack.translate(t, 2.0f, 3.0f);
+        stack.rotate(t, 0.0f, 1.0f, 0.0f);
+        stack.scale(2.0f, 2.0f, 2.0f);
+    }
+};
+
+struct Compose
+{
+    template<typename Stack>
+    static void apply(Stack& stack, float t)
+    {
+        stack.compose(vec3(t, 2.0f, 3.0f), t, vec3(0.0f, 1.0f, 0.0f), vec3(2.0f, 2.0f, 2.0f));
+    }
+};
+
+// Pushing, transforming and popping numItems nodes under a common parent.
+template<typename Method, typename Stack>
+class Nodes
+{
+public:
+    Nodes(float& sink) :
+        sink_(sink)
+    {
+        stack_ *= LibMatrix::Mat4::perspective(60.0f, 1.5f, 1.0f, 100.0f);
+    }
+    void operator()()
+    {
+        for (unsigned int i = 0; i < numItems; i++)
+        {
+            stack_.push();
+            Method::apply(stack_, static_cast<float>(i & 255));
+            sink_ += stack_.getCurrent()(0, 3);
+            stack_.pop();
+        }
+    }
+private:
+    Stack stack_;
+    float& sink_;
+};
+
+template<typename Method, typename Stack>
+uint64_t
+timeNodes(float& sink)
+{
+    Nodes<Method, Stack> op(sink);
+    return MatrixBench::fastest(op);
+}
+
+} // namespace
+
+void
+StackBenchModel::run(const Options&)
+{
+    float sink(0.0f);
+    report("translate, rotate, scale (operator*=)", timeNodes<FullMultiply, Stack4>(sink), numItems);
+    report("translate, rotate, scale (in place)", timeNodes<InPlace, Stack4>(sink), numItems);
+    report("compose", timeNodes<Compose, Stack4>(sink), numItems);
+    report("in place, FixedStack4<16>", timeNodes<InPlace, FixedStack4<16> >(sink), numItems);
+    report("compose, FixedStack4<16>", timeNodes<Compose, FixedStack4<16> >(sink), numItems);
+    report("operator*=, DStack4 (double)", timeNodes<FullMultiply, DStack4>(sink), numItems);
+    report("in place, DStack4 (double)", timeNodes<InPlace, DStack4>(sink), numItems);
+    if (sink == 0.0f)
+    {
+        report("(unused)", 0, 0);
+    }
+}
+
+namespace
+{
+
+// The number of draws per node, each needing the normal and
+// model-view-projection matrices.
+const unsigned int drawsPerNode(4);
+
+// Each draw is a separate call, as it would be between the GL calls of a
+// real draw, so that the compiler cannot share the work between them.
+
+// Stands in for handing the matrices to GL.  As it is opaque to the
+// compiler, it cannot tell which elements it reads, so it cannot drop any
+// of the work that produced them.
+OUT_OF_LINE void
+consume(const mat3& normal, const mat4& mvp, float& sink)
+{
+    sink += normal(0, 0) + mvp(0, 3);
+}
+
+// Computing the matrices for every draw, as without the caches.
+struct Recompute
+{
+    static OUT_OF_LINE void draw(const Stack4& modelView, const Stack4& projection, float& sink)
+    {
+        const float* m(modelView.getCurrent());
+        mat3 normal(m[0], m[1], m[2], m[4], m[5], m[6], m[8], m[9], m[10]);
+        normal.inverse().transpose();
+        mat4 mvp(projection.getCurrent() * modelView.getCurrent());
+        consume(normal, mvp, sink);
+    }
+};
+
+struct Cached
+{
+    static OUT_OF_LINE void draw(const Stack4& modelView, const Stack4& projection, float& sink)
+    {
+        consume(modelView.getNormalMatrix(), modelView.getProjectionProduct(projection), sink);
+    }
+};
+
+// Drawing drawsPerNode times from each of numItems nodes.
+template<typename Method>
+class Draws
+{
+public:
+    Draws(float& sink) :
+        sink_(sink)
+    {
+        projection_.perspective(60.0f, 1.5f, 1.0f, 100.0f);
+        modelView_.lookAt(1.0f, 2.0f, 3.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f);
+    }
+    void operator()()
+    {
+        for (unsigned int i = 0; i < numItems; i++)
+        {
+            modelView_.push();
+            modelView_.translate(static_cast<float>(i & 255), 2.0f, 3.0f);
+            for (unsigned int d = 0; d < drawsPerNode; d++)
+            {
+                Method::draw(modelView_, projection_, sink_);
+            }
+            modelView_.pop();
+        }
+    }
+private:
+    Stack4 projection_;
+    Stack4 modelView_;
+    float& sink_;
+};
+
+template<typename Method>
+uint64_t
+timeDraws(float& sink)
+{
+    Draws<Method> op(sink);
+    return MatrixBench::fastest(op);
+}
+
+} // namespace
+
+void
+StackBenchDerived::run(const Options&)
+{
+    float sink(0.0f);
+    report("recomputed for each draw (4 per node)", timeDraws<Recompute>(sink), numItems);
+    report("cached (4 draws per node)", timeDraws<Cached>(sink), numItems);
+    if (sink == 0.0f)
+    {
+        report("(unused)", 0, 0);
+    }
+}
@@ -0,0 +1,32 @@
+//
+// Copyright (c) 2013 Linaro Limited
+//
+// All rights reserved. This program and the accompanying materials
+// are made available under the terms of the MIT License which accompanies
+// this distribution, and is available at
+// http://www.opensource.org/licenses/mit-license.php
+//
+// Contributors:
+//     Jesse Barker - original implementation.
+//
+#ifndef STACK_BENCH_H_
+#define STACK_BENCH_H_
+
+class MatrixBench;
+class Options;
+
+class StackBenchModel : public MatrixBench
+{
+public:
+    StackBenchModel() : MatrixBench("Stack4 model transform per node") {}
+    virtual void run(const Options& options);
+};
+
+class StackBenchDerived : public MatrixBench
+{
+public:
+    StackBenchDerived() : MatrixBench("Stack4 normal and MVP matrices per draw") {}
+    virtual void run(const Options& options);
+};
+
+#endif // STACK_BENCH_H_
@@ -0,0 +1,412 @@
+//
+// Copyright (c) 2013 Linaro Limited
+//
+// All rights reserved. This program and the accompanying materials
+// are made available under the terms of the MIT License which accompanies
+// this distribution, and is available at
+// http://www.opensource.org/licenses/mit-license.php
+//
+// Contributors:
+//     Jesse Barker - original implementation.
+//
+#include <iostream>
+#include <stdexcept>
+#include <math.h>
+#include "libmatrix_test.h"
+#include "stack_test.h"
+#include "../stack.h"
+
+using LibMatrix::mat3;
+using LibMatrix::mat4;
+using LibMatrix::vec3;
+using LibMatrix::dvec3;
+using LibMatrix::quat;
+using LibMatrix::dquat;
+using LibMatrix::Stack4;
+using LibMatrix::FixedStack4;
+using LibMatrix::DStack4;
+using std::cout;
+using std::endl;
+
+void
+StackTestCompose::run(const Options& options)
+{
+    const vec3 t(1.0f, -2.0f, 3.0f);
+    const vec3 axis(1.0f, 1.0f, 0.5f);
+    const vec3 s(2.0f, 0.5f, -1.0f);
+    mat4 expected(LibMatrix::Mat4::translate(t.x(), t.y(), t.z()));
+    expected *= LibMatrix::Mat4::rotate(30.0f, axis.x(), axis.y(), axis.z());
+    expected *= LibMatrix::Mat4::scale(s.x(), s.y(), s.z());
+
+    mat4 composed(LibMatrix::Mat4::compose(t, 30.0f, axis, s));
+    if (maxDifference(composed, expected) > 1.0e-6f)
+    {
+        if (options.beVerbose())
+        {
+            cout << "compose() with an angle and axis gives:" << endl;
+            composed.print();
+            cout << "rather than:" << endl;
+            expected.print();
+        }
+        return;
+    }
+
+    mat4 r4(LibMatrix::Mat4::rotate(30.0f, axis.x(), axis.y(), axis.z()));
+    mat3 r3(r4(0, 0), r4(1, 0), r4(2, 0),
+            r4(0, 1), r4(1, 1), r4(2, 1),
+            r4(0, 2), r4(1, 2), r4(2, 2));
+    if (LibMatrix::Mat4::compose(t, r3, s) != composed)
+    {
+        if (options.beVerbose())
+        {
+            cout << "compose() with a rotation matrix differs." << endl;
+        }
+        return;
+    }
+
+    pass_ = true;
+}
+
+void
+StackTestInPlace::run(const Options& options)
+{
+    // Start from something that is not affine, so that every row takes
+    // part.
+    Stack4 stack;
+    stack *= LibMatrix::Mat4::perspective(60.0f, 1.5f, 1.0f, 100.0f);
+    stack *= LibMatrix::Mat4::lookAt(1.0f, 2.0f, 3.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f);
+    mat4 expected(stack.getCurrent());
+
+    stack.translate(1.0f, -2.0f, 3.0f);
+    expected *= LibMatrix::Mat4::translate(1.0f, -2.0f, 3.0f);
+    float translateError(maxDifference(stack.getCurrent(), expected));
+
+    stack.rotate(75.0f, 0.0f, 1.0f, 1.0f);
+    expected *= LibMatrix::Mat4::rotate(75.0f, 0.0f, 1.0f, 1.0f);
+    float rotateError(maxDifference(stack.getCurrent(), expected));
+
+    stack.scale(2.0f, 0.5f, -1.0f);
+    expected *= LibMatrix::Mat4::scale(2.0f, 0.5f, -1.0f);
+    float scaleError(maxDifference(stack.getCurrent(), expected));
+
+    const vec3 t(0.5f, 4.0f, -1.0f);
+    const vec3 axis(1.0f, 0.0f, 0.0f);
+    const vec3 s(3.0f, 3.0f, 3.0f);
+    stack.push();
+    stack.compose(t, 45.0f, axis, s);
+    expected *= LibMatrix::Mat4::compose(t, 45.0f, axis, s);
+    float composeError(maxDifference(stack.getCurrent(), expected));
+
+    if (options.beVerbose())
+    {
+        cout << "Largest errors: translate " << translateError
+             << ", rotate " << rotateError
+             << ", scale " << scaleError
+             << ", compose " << composeError << endl;
+    }
+    if (translateError > 1.0e-5f || rotateError > 1.0e-5f ||
+        scaleError > 1.0e-5f || composeError > 1.0e-5f)
+    {
+        return;
+    }
+
+    // The in-place updates leave the matrix below alone.
+    stack.pop();
+    expected = stack.getCurrent();
+    stack.push();
+    stack.translate(1.0f, 1.0f, 1.0f);
+    stack.pop();
+    if (stack.getCurrent() != expected)
+    {
+        return;
+    }
+
+    pass_ = true;
+}
+
+void
+StackTestFixed::run(const Options& options)
+{
+    // The same traversal on both kinds of stack gives the same matrices.
+    Stack4 stack;
+    FixedStack4<3> fixed;
+    stack.perspective(60.0f, 1.5f, 1.0f, 100.0f);
+    fixed.perspective(60.0f, 1.5f, 1.0f, 100.0f);
+    for (unsigned int i = 0; i < 4; i++)
+    {
+        float t(static_cast<float>(i));
+        stack.push();
+        fixed.push();
+        stack.translate(t, 1.0f, -5.0f);
+        fixed.translate(t, 1.0f, -5.0f);
+        stack.push();
+        fixed.push();
+        stack.rotate(30.0f * t, 0.0f, 1.0f, 0.0f);
+        fixed.rotate(30.0f * t, 0.0f, 1.0f, 0.0f);
+        stack *= LibMatrix::Mat4::scale(2.0f, 2.0f, 2.0f);
+        fixed *= LibMatrix::Mat4::scale(2.0f, 2.0f, 2.0f);
+        if (maxDifference(stack.getCurrent(), fixed.getCurrent()) != 0.0f ||
+            fixed.getDepth() != 3)
+        {
+            if (options.beVerbose())
+            {
+                cout << "FixedStack4 differs from Stack4 at node " << i << "." << endl;
+            }
+            return;
+        }
+        stack.pop();
+        fixed.pop();
+        stack.pop();
+        fixed.pop();
+    }
+    if (maxDifference(stack.getCurrent(), fixed.getCurrent()) != 0.0f)
+    {
+        if (options.beVerbose())
+        {
+            cout << "FixedStack4 differs from Stack4 after popping." << endl;
+        }
+        return;
+    }
+
+    // Pushing past the capacity or popping the bottom matrix throws, and
+    // leaves the stack as it was.
+    fixed.push();
+    fixed.push();
+    bool overflowed(false);
+    try
+    {
+        fixed.push();
+    }
+    catch (const std::overflow_error&)
+    {
+        overflowed = true;
+    }
+    fixed.pop();
+    fixed.pop();
+    bool underflowed(false);
+    try
+    {
+        fixed.pop();
+    }
+    catch (const std::underflow_error&)
+    {
+        underflowed = true;
+    }
+    if (!overflowed || !underflowed || fixed.getDepth() != 1 ||
+        maxDifference(stack.getCurrent(), fixed.getCurrent()) != 0.0f)
+    {
+        if (options.beVerbose())
+        {
+            cout << "Overflow or underflow was not caught." << endl;
+        }
+        return;
+    }
+
+    fixed.loadIdentity();
+    if (maxDifference(fixed.getCurrent(), mat4()) != 0.0f)
+    {
+        return;
+    }
+
+    pass_ = true;
+}
+
+// Check the cached matrices of 'stack' against computing them afresh.
+// They are not compared exactly, as the compiler may contract the two
+// computations into fused multiply-adds differently.  A stale matrix is
+// still caught: each change that checkCache() makes to the stacks moves
+// the expected values by far more than the tolerance.
+template<typename Stack>
+static bool
+checkDerived(const Stack& stack, const Stack4& projection)
+{
+    const float tolerance(1.0e-4f);
+    mat4 inverse(stack.getCurrent());
+    inverse.inverse(LibMatrix::InverseCheckAffine);
+    const float* m(stack.getCurrent());
+    mat3 normal(m[0], m[1], m[2], m[4], m[5], m[6], m[8], m[9], m[10]);
+    normal.inverse().transpose();
+    mat4 product(projection.getCurrent() * stack.getCurrent());
+    const mat3& cached(stack.getNormalMatrix());
+    for (unsigned int r = 0; r < 3; r++)
+    {
+        for (unsigned int c = 0; c < 3; c++)
+        {
+            if (!(fabs(cached(r, c) - normal(r, c)) <= tolerance))
+            {
+                return false;
+            }
+        }
+    }
+    return maxDifference(stack.getInverse(), inverse) <= tolerance &&
+           maxDifference(stack.getProjectionProduct(projection), product) <= tolerance;
+}
+
+template<typename Stack>
+static bool
+checkCache(const Options& options)
+{
+    Stack4 projection;
+    projection.perspective(60.0f, 1.5f, 1.0f, 100.0f);
+    Stack stack;
+    stack.lookAt(1.0f, 2.0f, 3.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f);
+    bool good(checkDerived(stack, projection));
+
+    // Repeated queries return the same cached matrices.
+    const mat4* inverse(&stack.getInverse());
+    uint64_t version(stack.getVersion());
+    good = good && &stack.getInverse() == inverse && stack.getVersion() == version;
+
+    // Pushing leaves the top alone; every kind of change is picked up.
+    stack.push();
+    good = good && stack.getVersion() == version && checkDerived(stack, projection);
+    stack.translate(1.0f, 0.0f, -2.0f);
+    good = good && checkDerived(stack, projection);
+    stack.rotate(30.0f, 0.0f, 1.0f, 0.0f);
+    good = good && checkDerived(stack, projection);
+    stack.scale(2.0f, 1.0f, 0.5f);
+    good = good && checkDerived(stack, projection);
+    stack *= LibMatrix::Mat4::translate(0.0f, 3.0f, 0.0f);
+    good = good && checkDerived(stack, projection);
+    stack.pop();
+    good = good && checkDerived(stack, projection);
+    projection.push();
+    projection.loadIdentity();
+    projection.ortho(-1.0f, 1.0f, -1.0f, 1.0f, 1.0f, 10.0f);
+    good = good && checkDerived(stack, projection);
+    stack.loadIdentity();
+    good = good && checkDerived(stack, projection);
+
+    if (!good && options.beVerbose())
+    {
+        cout << "A cached matrix was out of date." << endl;
+    }
+    return good;
+}
+
+void
+StackTestCache::run(const Options& options)
+{
+    pass_ = checkCache<Stack4>(options) && checkCache<FixedStack4<4> >(options) &&
+            checkCache<DStack4>(options);
+}
+
+void
+StackTestDouble::run(const Options& options)
+{
+    // An ordinary scene gives the same matrices as Stack4, up to rounding.
+    Stack4 stack;
+    DStack4 dstack;
+    stack.perspective(60.0f, 1.5f, 1.0f, 100.0f);
+    dstack.perspective(60.0f, 1.5f, 1.0f, 100.0f);
+    stack.lookAt(1.0f, 2.0f, 3.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f);
+    dstack.lookAt(1.0, 2.0, 3.0, 0.0, 0.0, 0.0, 0.0, 1.0, 0.0);
+    stack.push();
+    dstack.push();
+    stack.translate(1.0f, 0.0f, -2.0f);
+    dstack.translate(1.0, 0.0, -2.0);
+    stack.rotate(30.0f, 1.0f, 1.0f, 0.0f);
+    dstack.rotate(30.0, 1.0, 1.0, 0.0);
+    stack.scale(2.0f, 1.0f, 0.5f);
+    dstack.scale(2.0, 1.0, 0.5);
+    if (maxDifference(stack.getCurrent(), dstack.getCurrent()) > 1.0e-5f)
+    {
+        if (options.beVerbose())
+        {
+            cout << "DStack4 differs from Stack4:" << endl;
+            dstack.getCurrent().print();
+            cout << "rather than:" << endl;
+            stack.getCurrent().print();
+        }
+        return;
+    }
+    stack.pop();
+    dstack.pop();
+    if (maxDifference(stack.getCurrent(), dstack.getCurrent()) > 1.0e-5f)
+    {
+        return;
+    }
+
+    // So do compose() and rotate() with a quaternion.
+    stack.compose(vec3(1.0f, -2.0f, 3.0f), 40.0f, vec3(0.0f, 1.0f, 1.0f), vec3(1.0f, 2.0f, 3.0f));
+    dstack.compose(dvec3(1.0, -2.0, 3.0), 40.0, dvec3(0.0, 1.0, 1.0), dvec3(1.0, 2.0, 3.0));
+    stack.compose(vec3(0.5f, 0.0f, 0.0f), quat(25.0f, vec3(1.0f, 0.0f, 0.0f)), vec3(2.0f, 2.0f, 2.0f));
+    dstack.compose(dvec3(0.5, 0.0, 0.0), dquat(25.0, dvec3(1.0, 0.0, 0.0)), dvec3(2.0, 2.0, 2.0));
+    stack.rotate(quat(-15.0f, vec3(0.0f, 0.0f, 1.0f)));
+    dstack.rotate(dquat(-15.0, dvec3(0.0, 0.0, 1.0)));
+    if (maxDifference(stack.getCurrent(), dstack.getCurrent()) > 1.0e-4f)
+    {
+        if (options.beVerbose())
+        {
+            cout << "DStack4's compose() or rotate(dquat) differs from Stack4's." << endl;
+        }
+        return;
+    }
+
+    // A deep chain far from the origin: 100 steps of rotating 0.9 degrees
+    // about y and moving 1cm along the rotated x axis.  Rebased to the
+    // start, the top should be a 90 degree rotation about y, after moving
+    // 1cm along each of the directions in turn.  In single precision, the
+    // steps are lost against the offset of the start.
+    const double far(1.0e6);
+    Stack4 floatChain;
+    DStack4 chain;
+    chain.setOrigin(far, 0.0, far);
+    floatChain.translate(far, 0.0f, far);
+    chain.translate(far, 0.0, far);
+    double x(0.0);
+    double z(0.0);
+    for (unsigned int i = 1; i <= 100; i++)
+    {
+        floatChain.rotate(0.9f, 0.0f, 1.0f, 0.0f);
+        floatChain.translate(0.01f, 0.0f, 0.0f);
+        chain.rotate(0.9, 0.0, 1.0, 0.0);
+        chain.translate(0.01, 0.0, 0.0);
+        double radians(i * 0.9 * M_PI / 180.0);
+        x += 0.01 * cos(radians);
+        z -= 0.01 * sin(radians);
+    }
+    mat4 expected(LibMatrix::Mat4::translate(x, 0.0f, z));
+    expected *= LibMatrix::Mat4::rotate(90.0f, 0.0f, 1.0f, 0.0f);
+    float error(maxDifference(chain.getCurrent(), expected));
+    if (options.beVerbose())
+    {
+        mat4 floatRebased(LibMatrix::Mat4::translate(-far, 0.0f, -far) * floatChain.getCurrent());
+        cout << "Error after a chain of 200 transforms at 1e6: " << error
+             << " (Stack4: " << maxDifference(floatRebased, expected) << ")" << endl;
+    }
+    if (error > 1.0e-5f)
+    {
+        return;
+    }
+
+    // The conversion is redone when the top or the origin changes.
+    const mat4* current(&chain.getCurrent());
+    mat4 before(chain.getCurrent());
+    chain.translate(1.0, 0.0, 0.0);
+    if (&chain.getCurrent() != current || maxDifference(chain.getCurrent(), before) < 0.5f)
+    {
+        return;
+    }
+    before = chain.getCurrent();
+    Stack4 projection;
+    projection.perspective(60.0f, 1.5f, 1.0f, 100.0f);
+    if (!checkDerived(chain, projection))
+    {
+        return;
+    }
+    chain.setOrigin(far + 1.0, 0.0, far);
+    if (fabs(chain.getCurrent()(0, 3) - (before(0, 3) - 1.0f)) > 1.0e-5f ||
+        !checkDerived(chain, projection))
+    {
+        return;
+    }
+    chain.loadIdentity();
+    if (fabs(chain.getCurrent()(0, 3) + static_cast<float>(far + 1.0)) > 1.0f ||
+        chain.getCurrentDouble()(0, 3) != 0.0)
+    {
+        return;
+    }
+
+    pass_ = true;
+}
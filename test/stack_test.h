@@ -0,0 +1,53 @@
+//
+// Copyright (c) 2013 Linaro Limited
+//
+// All rights reserved. This program and the accompanying materials
+// are made available under the terms of the MIT License which accompanies
+// this distribution, and is available at
+// http://www.opensource.org/licenses/mit-license.php
+//
+// Contributors:
+//     Jesse Barker - original implementation.
+//
+#ifndef STACK_TEST_H_
+#define STACK_TEST_H_
+
+class MatrixTest;
+class Options;
+
+class StackTestCompose : public MatrixTest
+{
+public:
+    StackTestCompose() : MatrixTest("Mat4::compose") {}
+    virtual void run(const Options& options);
+};
+
+class StackTestInPlace : public MatrixTest
+{
+public:
+    StackTestInPlace() : MatrixTest("Stack4 in-place transforms") {}
+    virtual void run(const Options& options);
+};
+
+class StackTestFixed : public MatrixTest
+{
+public:
+    StackTestFixed() : MatrixTest("FixedStack4") {}
+    virtual void run(const Options& options);
+};
+
+class StackTestCache : public MatrixTest
+{
+public:
+    StackTestCache() : MatrixTest("Stack4 cached inverse/normal/projection matrices") {}
+    virtual void run(const Options& options);
+};
+
+class StackTestDouble : public MatrixTest
+{
+public:
+    StackTestDouble() : MatrixTest("DStack4 double precision accumulation") {}
+    virtual void run(const Options& options);
+};
+
+#endif // STACK_TEST_H_
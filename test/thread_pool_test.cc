@@ -0,0 +1,189 @@
+//
+// Copyright (c) 2013 Linaro Limited
+//
+// All rights reserved. This program and the accompanying materials
+// are made available under the terms of the MIT License which accompanies
+// this distribution, and is available at
+// http://www.opensource.org/licenses/mit-license.php
+//
+// Contributors:
+//     Jesse Barker - original implementation.
+//
+#include <iostream>
+#include <vector>
+#include "libmatrix_test.h"
+#include "thread_pool_test.h"
+#include "../thread-pool.h"
+#include "../batch.h"
+
+using LibMatrix::ThreadPool;
+using LibMatrix::RangeTask;
+using LibMatrix::mat4;
+using LibMatrix::vec3;
+using LibMatrix::vec4;
+using std::cout;
+using std::endl;
+using std::vector;
+
+// Count how many times each index is visited, and check that no range is
+// larger than the grain.
+class CountTask : public RangeTask
+{
+public:
+    CountTask(vector<unsigned int>& hits, unsigned int grain) :
+        hits_(hits), grain_(grain), oversized_(false) {}
+    void run(unsigned int begin, unsigned int end)
+    {
+        if (end - begin > grain_)
+        {
+            oversized_ = true;
+        }
+        for (unsigned int i = begin; i < end; i++)
+        {
+            hits_[i]++;
+        }
+    }
+    bool oversized() const { return oversized_; }
+private:
+    vector<unsigned int>& hits_;
+    unsigned int grain_;
+    bool oversized_;
+};
+
+static bool
+checkCoverage(ThreadPool& pool, unsigned int count, unsigned int grain, const Options& options)
+{
+    vector<unsigned int> hits(count, 0);
+    CountTask task(hits, grain ? grain : 1);
+    pool.parallelFor(count, grain, task);
+    for (unsigned int i = 0; i < count; i++)
+    {
+        if (hits[i] != 1)
+        {
+            if (options.beVerbose())
+            {
+                cout << "Index " << i << " of " << count << " (grain " << grain
+                     << ") was run " << hits[i] << " times." << endl;
+            }
+            return false;
+        }
+    }
+    return !task.oversized();
+}
+
+void
+ThreadPoolTestParallelFor::run(const Options& options)
+{
+    ThreadPool serial(1);
+    ThreadPool pool(4);
+    if (serial.numThreads() != 1 || pool.numThreads() < 1 || pool.numThreads() > 4)
+    {
+        return;
+    }
+    if (options.beVerbose())
+    {
+        cout << "Pool has " << pool.numThreads() << " threads." << endl;
+    }
+
+    static const unsigned int counts[] = { 0, 1, 7, 64, 1000, 100003 };
+    static const unsigned int grains[] = { 0, 1, 3, 64, 1000, 200000 };
+    for (unsigned int c = 0; c < sizeof(counts) / sizeof(counts[0]); c++)
+    {
+        for (unsigned int g = 0; g < sizeof(grains) / sizeof(grains[0]); g++)
+        {
+            if (!checkCoverage(pool, counts[c], grains[g], options) ||
+                !checkCoverage(serial, counts[c], grains[g], options))
+            {
+                return;
+            }
+        }
+    }
+
+    // Many small jobs back to back, to shake out hand-off problems.
+    for (unsigned int i = 0; i < 500; i++)
+    {
+        if (!checkCoverage(pool, 97, 5, options))
+        {
+            return;
+        }
+    }
+
+    pass_ = true;
+}
+
+void
+ThreadPoolTestBatch::run(const Options& options)
+{
+    static const unsigned int count(1001);
+    static const unsigned int grain(16);
+    vector<mat4> lhs(count);
+    vector<mat4> rhs(count);
+    vector<vec4> v4(count);
+    vector<vec3> v3(count);
+    unsigned int seed(1);
+    for (unsigned int i = 0; i < count; i++)
+    {
+        for (unsigned int r = 0; r < 4; r++)
+        {
+            for (unsigned int c = 0; c < 4; c++)
+            {
+                seed = seed * 1103515245 + 12345;
+                lhs[i][r][c] = static_cast<float>((seed >> 16) & 0xff) / 64.0f;
+                rhs[count - 1 - i][c][r] = lhs[i][r][c] - 1.0f;
+            }
+        }
+        // A positive z keeps the perspective w away from zero.
+        v4[i] = vec4(lhs[i][0][0], lhs[i][1][1], 1.0f + lhs[i][2][2], lhs[i][3][3]);
+        v3[i] = vec3(lhs[i][0][1], lhs[i][1][2], lhs[i][2][3]);
+    }
+    mat4 m(LibMatrix::Mat4::perspective(60.0, 1.5, 1.0, 100.0));
+
+    ThreadPool pool(4);
+    vector<mat4> serialMat(count);
+    vector<mat4> parallelMat(count);
+    vector<vec4> serial4(count);
+    vector<vec4> parallel4(count);
+    vector<vec3> serial3(count);
+    vector<vec3> parallel3(count);
+    bool same(true);
+
+    LibMatrix::Batch::multiply(&serialMat[0], &lhs[0], &rhs[0], count);
+    LibMatrix::Batch::multiply(pool, &parallelMat[0], &lhs[0], &rhs[0], count, grain);
+    same = same && serialMat == parallelMat;
+    LibMatrix::Batch::multiply(&serialMat[0], lhs[3], &rhs[0], count);
+    LibMatrix::Batch::multiply(pool, &parallelMat[0], lhs[3], &rhs[0], count, grain);
+    same = same && serialMat == parallelMat;
+    LibMatrix::Batch::multiply(&serialMat[0], &lhs[0], rhs[3], count);
+    LibMatrix::Batch::multiply(pool, &parallelMat[0], &lhs[0], rhs[3], count, grain);
+    same = same && serialMat == parallelMat;
+
+    LibMatrix::Batch::transform(&serial4[0], m, &v4[0], count, LibMatrix::Batch::DivideByW);
+    LibMatrix::Batch::transform(pool, &parallel4[0], m, &v4[0], count, LibMatrix::Batch::DivideByW, grain);
+    LibMatrix::Batch::transformPoints(&serial3[0], m, &v3[0], count);
+    LibMatrix::Batch::transformPoints(pool, &parallel3[0], m, &v3[0], count, LibMatrix::Batch::DivideNone, grain);
+    for (unsigned int i = 0; i < count && same; i++)
+    {
+        same = serial4[i].x() == parallel4[i].x() && serial4[i].y() == parallel4[i].y() &&
+               serial4[i].z() == parallel4[i].z() && serial4[i].w() == parallel4[i].w() &&
+               serial3[i].x() == parallel3[i].x() && serial3[i].y() == parallel3[i].y() &&
+               serial3[i].z() == parallel3[i].z();
+    }
+    LibMatrix::Batch::transformVectors(&serial3[0], m, &v3[0], count);
+    LibMatrix::Batch::transformVectors(pool, &parallel3[0], m, &v3[0], count, grain);
+    for (unsigned int i = 0; i < count && same; i++)
+    {
+        same = serial3[i].x() == parallel3[i].x() && serial3[i].y() == parallel3[i].y() &&
+               serial3[i].z() == parallel3[i].z();
+    }
+
+    if (!same)
+    {
+        if (options.beVerbose())
+        {
+            cout << "Parallel results differ from the serial ones." << endl;
+        }
+        return;
+    }
+
+    pass_ = true;
+}
@@ -0,0 +1,32 @@
+//
+// Copyright (c) 2013 Linaro Limited
+//
+// All rights reserved. This program and the accompanying materials
+// are made available under the terms of the MIT License which accompanies
+// this distribution, and is available at
+// http://www.opensource.org/licenses/mit-license.php
+//
+// Contributors:
+//     Jesse Barker - original implementation.
+//
+#ifndef THREAD_POOL_TEST_H_
+#define THREAD_POOL_TEST_H_
+
+class MatrixTest;
+class Options;
+
+class ThreadPoolTestParallelFor : public MatrixTest
+{
+public:
+    ThreadPoolTestParallelFor() : MatrixTest("ThreadPool::parallelFor") {}
+    virtual void run(const Options& options);
+};
+
+class ThreadPoolTestBatch : public MatrixTest
+{
+public:
+    ThreadPoolTestBatch() : MatrixTest("Batch (parallel)") {}
+    virtual void run(const Options& options);
+};
+
+#endif // THREAD_POOL_TEST_H_
@@ -0,0 +1,245 @@
+//
+// Copyright (c) 2013 Linaro Limited
+//
+// All rights reserved. This program and the accompanying materials
+// are made available under the terms of the MIT License which accompanies
+// this distribution, and is available at
+// http://www.opensource.org/licenses/mit-license.php
+//
+// Contributors:
+//     Jesse Barker - original implementation.
+//
+#include <string>
+#include <vector>
+#include "libmatrix_test.h"
+#include "libmatrix_bench.h"
+#include "vector_bench.h"
+#include "../batch.h"
+
+using LibMatrix::vec3;
+using LibMatrix::vec4;
+using LibMatrix::dvec3;
+using std::vector;
+
+namespace
+{
+
+// Enough normals for a deformed mesh, but still within the caches.
+const unsigned int count(16384);
+const unsigned int numPasses(128);
+
+// Inputs and outputs for the operations being timed.
+struct VectorWork
+{
+    VectorWork() :
+        a3(count), b3(count), out3(count), a4(count), out4(count),
+        d3(count), dout3(count), scalars(count)
+    {
+        for (unsigned int i = 0; i < count; i++)
+        {
+            float f(static_cast<float>(i));
+            a3[i] = vec3(1.0f + f, 2.0f, -static_cast<float>(i % 17));
+            b3[i] = vec3(0.5f, -f, 3.0f);
+            a4[i] = vec4(1.0f + f, 2.0f, -static_cast<float>(i % 17), 0.25f);
+            d3[i] = dvec3(1.0 + i, 2.0, -static_cast<double>(i % 17));
+        }
+    }
+    vector<vec3> a3;
+    vector<vec3> b3;
+    vector<vec3> out3;
+    vector<vec4> a4;
+    vector<vec4> out4;
+    vector<dvec3> d3;
+    vector<dvec3> dout3;
+    vector<float> scalars;
+};
+
+struct LoopNormalize3
+{
+    static OUT_OF_LINE void run(VectorWork& w)
+    {
+        for (unsigned int i = 0; i < count; i++)
+        {
+            vec3 v(w.a3[i]);
+            v.normalize();
+            w.out3[i] = v;
+        }
+    }
+};
+
+struct LoopNormalize3Fast
+{
+    static OUT_OF_LINE void run(VectorWork& w)
+    {
+        for (unsigned int i = 0; i < count; i++)
+        {
+            vec3 v(w.a3[i]);
+            v.normalize(LibMatrix::fast);
+            w.out3[i] = v;
+        }
+    }
+};
+
+struct BatchNormalize3
+{
+    static OUT_OF_LINE void run(VectorWork& w)
+    {
+        LibMatrix::Batch::normalize(&w.out3[0], &w.a3[0], count);
+    }
+};
+
+struct BatchNormalize3Fast
+{
+    static OUT_OF_LINE void run(VectorWork& w)
+    {
+        LibMatrix::Batch::normalize(&w.out3[0], &w.a3[0], count, LibMatrix::fast);
+    }
+};
+
+struct LoopNormalize4
+{
+    static OUT_OF_LINE void run(VectorWork& w)
+    {
+        for (unsigned int i = 0; i < count; i++)
+        {
+            vec4 v(w.a4[i]);
+            v.normalize();
+            w.out4[i] = v;
+        }
+    }
+};
+
+struct BatchNormalize4
+{
+    static OUT_OF_LINE void run(VectorWork& w)
+    {
+        LibMatrix::Batch::normalize(&w.out4[0], &w.a4[0], count);
+    }
+};
+
+struct LoopNormalize3Double
+{
+    static OUT_OF_LINE void run(VectorWork& w)
+    {
+        for (unsigned int i = 0; i < count; i++)
+        {
+            dvec3 v(w.d3[i]);
+            v.normalize();
+            w.dout3[i] = v;
+        }
+    }
+};
+
+struct BatchNormalize3Double
+{
+    static OUT_OF_LINE void run(VectorWork& w)
+    {
+        LibMatrix::Batch::normalize(&w.dout3[0], &w.d3[0], count);
+    }
+};
+
+struct LoopLength3
+{
+    static OUT_OF_LINE void run(VectorWork& w)
+    {
+        for (unsigned int i = 0; i < count; i++)
+        {
+            w.scalars[i] = w.a3[i].length();
+        }
+    }
+};
+
+struct BatchLength3
+{
+    static OUT_OF_LINE void run(VectorWork& w)
+    {
+        LibMatrix::Batch::length(&w.scalars[0], &w.a3[0], count);
+    }
+};
+
+struct LoopDot3
+{
+    static OUT_OF_LINE void run(VectorWork& w)
+    {
+        for (unsigned int i = 0; i < count; i++)
+        {
+            w.scalars[i] = vec3::dot(w.a3[i], w.b3[i]);
+        }
+    }
+};
+
+struct BatchDot3
+{
+    static OUT_OF_LINE void run(VectorWork& w)
+    {
+        LibMatrix::Batch::dot(&w.scalars[0], &w.a3[0], &w.b3[0], count);
+    }
+};
+
+struct LoopCross3
+{
+    static OUT_OF_LINE void run(VectorWork& w)
+    {
+        for (unsigned int i = 0; i < count; i++)
+        {
+            w.out3[i] = vec3::cross(w.a3[i], w.b3[i]);
+        }
+    }
+};
+
+struct BatchCross3
+{
+    static OUT_OF_LINE void run(VectorWork& w)
+    {
+        LibMatrix::Batch::cross(&w.out3[0], &w.a3[0], &w.b3[0], count);
+    }
+};
+
+// Runs Op numPasses times.
+template<typename Op>
+class Passes
+{
+public:
+    Passes(VectorWork& w) :
+        w_(w) {}
+    void operator()()
+    {
+        for (unsigned int pass = 0; pass < numPasses; pass++)
+        {
+            Op::run(w_);
+        }
+    }
+private:
+    VectorWork& w_;
+};
+
+template<typename Op>
+uint64_t
+timeOp(VectorWork& w)
+{
+    Passes<Op> op(w);
+    return MatrixBench::fastest(op);
+}
+
+} // namespace
+
+void
+VectorBench::run(const Options&)
+{
+    VectorWork w;
+    unsigned int items(count * numPasses);
+    report("vec3::normalize loop", timeOp<LoopNormalize3>(w), items);
+    report("Batch::normalize (vec3)", timeOp<BatchNormalize3>(w), items);
+    report("vec3::normalize(fast) loop", timeOp<LoopNormalize3Fast>(w), items);
+    report("Batch::normalize (vec3, fast)", timeOp<BatchNormalize3Fast>(w), items);
+    report("vec4::normalize loop", timeOp<LoopNormalize4>(w), items);
+    report("Batch::normalize (vec4)", timeOp<BatchNormalize4>(w), items);
+    report("dvec3::normalize loop", timeOp<LoopNormalize3Double>(w), items);
+    report("Batch::normalize (dvec3)", timeOp<BatchNormalize3Double>(w), items);
+    report("vec3::length loop", timeOp<LoopLength3>(w), items);
+    report("Batch::length (vec3)", timeOp<BatchLength3>(w), items);
+    report("vec3::dot loop", timeOp<LoopDot3>(w), items);
+    report("Batch::dot (vec3)", timeOp<BatchDot3>(w), items);
+    report("vec3::cross loop", timeOp<LoopCross3>(w), items);
+    report("Batch::cross (vec3)", timeOp<BatchCross3>(w), items);
+}
@@ -0,0 +1,25 @@
+//
+// Copyright (c) 2013 Linaro Limited
+//
+// All rights reserved. This program and the accompanying materials
+// are made available under the terms of the MIT License which accompanies
+// this distribution, and is available at
+// http://www.opensource.org/licenses/mit-license.php
+//
+// Contributors:
+//     Jesse Barker - original implementation.
+//
+#ifndef VECTOR_BENCH_H_
+#define VECTOR_BENCH_H_
+
+class MatrixBench;
+class Options;
+
+class VectorBench : public MatrixBench
+{
+public:
+    VectorBench() : MatrixBench("Per-vector vs batch vector operations") {}
+    virtual void run(const Options& options);
+};
+
+#endif // VECTOR_BENCH_H_
@@ -0,0 +1,341 @@
+//
+// Copyright (c) 2013 Linaro Limited
+//
+// All rights reserved. This program and the accompanying materials
+// are made available under the terms of the MIT License which accompanies
+// this distribution, and is available at
+// http://www.opensource.org/licenses/mit-license.php
+//
+// Contributors:
+//     Jesse Barker - original implementation.
+//
+#include <vector>
+#include "thread-pool.h"
+
+#if !defined(LIBMATRIX_NO_THREADS) && (defined(__unix__) || defined(__APPLE__))
+#include <unistd.h>
+#if defined(_POSIX_THREADS) && (_POSIX_THREADS > 0)
+#define LIBMATRIX_HAVE_PTHREADS
+#include <pthread.h>
+#endif
+#endif
+
+using std::vector;
+
+namespace LibMatrix
+{
+
+// Run the chunks of a job one after the other, in order, on this thread.
+static void
+runSerial(unsigned int count, unsigned int grain, RangeTask& task)
+{
+    for (unsigned int begin = 0; begin < count; begin += grain)
+    {
+        task.run(begin, count - begin > grain ? begin + grain : count);
+        if (count - begin <= grain)
+        {
+            break;
+        }
+    }
+}
+
+#if defined(LIBMATRIX_HAVE_PTHREADS)
+
+// The chunks [next, end) that are still waiting to be run from one thread's
+// share of the job.  The owner takes chunks from the front and thieves take
+// them from the back.
+struct ChunkQueue
+{
+    pthread_mutex_t lock;
+    unsigned int next;
+    unsigned int end;
+};
+
+struct ThreadPool::Impl
+{
+    struct Worker
+    {
+        Impl* pool;
+        unsigned int index;
+        pthread_t thread;
+    };
+
+    Impl(unsigned int numThreads);
+    ~Impl();
+    void work(unsigned int self);
+    bool takeChunk(unsigned int self, unsigned int& chunk);
+    bool stealChunk(unsigned int self, unsigned int& chunk);
+    static void* workerMain(void* arg);
+
+    // Queue i belongs to worker i; the last one belongs to the caller of
+    // parallelFor().
+    vector<Worker> workers;
+    vector<ChunkQueue> queues;
+
+    // Serializes parallelFor() callers.
+    pthread_mutex_t jobLock;
+
+    // Protects everything below, which describes the current job.
+    pthread_mutex_t lock;
+    pthread_cond_t start;
+    pthread_cond_t done;
+    unsigned int generation;
+    unsigned int finished;
+    bool quit;
+    RangeTask* task;
+    unsigned int count;
+    unsigned int grain;
+};
+
+ThreadPool::Impl::Impl(unsigned int numThreads) :
+    generation(0),
+    finished(0),
+    quit(false),
+    task(0),
+    count(0),
+    grain(1)
+{
+    pthread_mutex_init(&jobLock, 0);
+    pthread_mutex_init(&lock, 0);
+    pthread_cond_init(&start, 0);
+    pthread_cond_init(&done, 0);
+
+    // The Worker records must not move once the threads have their
+    // addresses.
+    workers.resize(numThreads - 1);
+    unsigned int created(0);
+    for (; created < workers.size(); created++)
+    {
+        Worker& w(workers[created]);
+        w.pool = this;
+        w.index = created;
+        if (pthread_create(&w.thread, 0, workerMain, &w) != 0)
+        {
+            break;
+        }
+    }
+    workers.resize(created);
+
+    queues.resize(workers.size() + 1);
+    for (vector<ChunkQueue>::iterator q = queues.begin(); q != queues.end(); q++)
+    {
+        pthread_mutex_init(&q->lock, 0);
+        q->next = 0;
+        q->end = 0;
+    }
+}
+
+ThreadPool::Impl::~Impl()
+{
+    pthread_mutex_lock(&lock);
+    quit = true;
+    pthread_cond_broadcast(&start);
+    pthread_mutex_unlock(&lock);
+    for (vector<Worker>::iterator w = workers.begin(); w != workers.end(); w++)
+    {
+        pthread_join(w->thread, 0);
+    }
+
+    for (vector<ChunkQueue>::iterator q = queues.begin(); q != queues.end(); q++)
+    {
+        pthread_mutex_destroy(&q->lock);
+    }
+    pthread_cond_destroy(&done);
+    pthread_cond_destroy(&start);
+    pthread_mutex_destroy(&lock);
+    pthread_mutex_destroy(&jobLock);
+}
+
+bool
+ThreadPool::Impl::takeChunk(unsigned int self, unsigned int& chunk)
+{
+    ChunkQueue& q(queues[self]);
+    pthread_mutex_lock(&q.lock);
+    bool found(q.next < q.end);
+    if (found)
+    {
+        chunk = q.next++;
+    }
+    pthread_mutex_unlock(&q.lock);
+    return found;
+}
+
+bool
+ThreadPool::Impl::stealChunk(unsigned int self, unsigned int& chunk)
+{
+    unsigned int numQueues(queues.size());
+    for (unsigned int i = 1; i < numQueues; i++)
+    {
+        ChunkQueue& q(queues[(self + i) % numQueues]);
+        pthread_mutex_lock(&q.lock);
+        bool found(q.next < q.end);
+        if (found)
+        {
+            chunk = --q.end;
+        }
+        pthread_mutex_unlock(&q.lock);
+        if (found)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Run chunks of the current job until there are none left anywhere.
+void
+ThreadPool::Impl::work(unsigned int self)
+{
+    unsigned int chunk(0);
+    while (takeChunk(self, chunk) || stealChunk(self, chunk))
+    {
+        unsigned int begin(chunk * grain);
+        unsigned int end(count - begin > grain ? begin + grain : count);
+        task->run(begin, end);
+    }
+}
+
+void*
+ThreadPool::Impl::workerMain(void* arg)
+{
+    Worker* self(static_cast<Worker*>(arg));
+    Impl* pool(self->pool);
+    unsigned int seen(0);
+    pthread_mutex_lock(&pool->lock);
+    while (true)
+    {
+        while (pool->generation == seen && !pool->quit)
+        {
+            pthread_cond_wait(&pool->start, &pool->lock);
+        }
+        if (pool->quit)
+        {
+            break;
+        }
+        seen = pool->generation;
+        pthread_mutex_unlock(&pool->lock);
+
+        pool->work(self->index);
+
+        pthread_mutex_lock(&pool->lock);
+        if (++pool->finished == pool->workers.size())
+        {
+            pthread_cond_signal(&pool->done);
+        }
+    }
+    pthread_mutex_unlock(&pool->lock);
+    return 0;
+}
+
+ThreadPool::ThreadPool(unsigned int numThreads)
+{
+    if (numThreads == 0)
+    {
+        long online(sysconf(_SC_NPROCESSORS_ONLN));
+        numThreads = online > 0 ? static_cast<unsigned int>(online) : 1;
+    }
+    impl_ = new Impl(numThreads);
+}
+
+ThreadPool::~ThreadPool()
+{
+    delete impl_;
+}
+
+unsigned int
+ThreadPool::numThreads() const
+{
+    return impl_->queues.size();
+}
+
+void
+ThreadPool::parallelFor(unsigned int count, unsigned int grain, RangeTask& task)
+{
+    if (count == 0)
+    {
+        return;
+    }
+    if (grain == 0)
+    {
+        grain = 1;
+    }
+    unsigned int numChunks((count - 1) / grain + 1);
+    if (impl_->workers.empty() || numChunks == 1)
+    {
+        runSerial(count, grain, task);
+        return;
+    }
+
+    pthread_mutex_lock(&impl_->jobLock);
+
+    // Every worker has finished with the previous job, so the queues can be
+    // refilled without locking them.  Each thread gets a contiguous share of
+    // the chunks.
+    unsigned int numQueues(impl_->queues.size());
+    unsigned int share(numChunks / numQueues);
+    unsigned int extra(numChunks % numQueues);
+    unsigned int next(0);
+    for (unsigned int i = 0; i < numQueues; i++)
+    {
+        ChunkQueue& q(impl_->queues[i]);
+        q.next = next;
+        next += share + (i < extra ? 1 : 0);
+        q.end = next;
+    }
+
+    pthread_mutex_lock(&impl_->lock);
+    impl_->task = &task;
+    impl_->count = count;
+    impl_->grain = grain;
+    impl_->finished = 0;
+    impl_->generation++;
+    pthread_cond_broadcast(&impl_->start);
+    pthread_mutex_unlock(&impl_->lock);
+
+    impl_->work(numQueues - 1);
+
+    pthread_mutex_lock(&impl_->lock);
+    while (impl_->finished < impl_->workers.size())
+    {
+        pthread_cond_wait(&impl_->done, &impl_->lock);
+    }
+    impl_->task = 0;
+    pthread_mutex_unlock(&impl_->lock);
+
+    pthread_mutex_unlock(&impl_->jobLock);
+}
+
+#else // !LIBMATRIX_HAVE_PTHREADS
+
+struct ThreadPool::Impl
+{
+};
+
+ThreadPool::ThreadPool(unsigned int) :
+    impl_(0)
+{
+}
+
+ThreadPool::~ThreadPool()
+{
+}
+
+unsigned int
+ThreadPool::numThreads() const
+{
+    return 1;
+}
+
+void
+ThreadPool::parallelFor(unsigned int count, unsigned int grain, RangeTask& task)
+{
+    if (grain == 0)
+    {
+        grain = 1;
+    }
+    runSerial(count, grain, task);
+}
+
+#endif // LIBMATRIX_HAVE_PTHREADS
+
+} // namespace LibMatrix
@@ -0,0 +1,71 @@
+//
+// Copyright (c) 2013 Linaro Limited
+//
+// All rights reserved. This program and the accompanying materials
+// are made available under the terms of the MIT License which accompanies
+// this distribution, and is available at
+// http://www.opensource.org/licenses/mit-license.php
+//
+// Contributors:
+//     Jesse Barker - original implementation.
+//
+#ifndef THREAD_POOL_H_
+#define THREAD_POOL_H_
+
+namespace LibMatrix
+{
+
+// A unit of work for ThreadPool::parallelFor().  run() is handed disjoint
+// half-open ranges [begin, end) of the overall index space, possibly on
+// several threads at once, and must not throw.
+class RangeTask
+{
+public:
+    virtual ~RangeTask() {}
+    virtual void run(unsigned int begin, unsigned int end) = 0;
+};
+
+//
+// A fixed set of worker threads for splitting large batch operations across
+// cores.  The index space of a parallelFor() is cut into chunks of 'grain'
+// elements, each thread starts on its own contiguous share of the chunks,
+// and threads that run dry steal chunks from the far end of the others'
+// shares.  Which thread runs a chunk varies from run to run, but as long as
+// each chunk only writes the outputs for its own range, the results are the
+// same as running the task serially over the whole range.
+//
+// Built with LIBMATRIX_NO_THREADS, or on a platform without POSIX threads,
+// the pool has no workers and parallelFor() runs the task inline.
+//
+class ThreadPool
+{
+public:
+    // Create a pool of 'numThreads' threads in total, counting the thread
+    // that calls parallelFor().  Zero means one per online processor.  If
+    // threads cannot be created, the pool makes do with those it has.
+    ThreadPool(unsigned int numThreads = 0);
+    ~ThreadPool();
+
+    // The number of threads that take part in a parallelFor(), including the
+    // calling thread.
+    unsigned int numThreads() const;
+
+    // Run 'task' over [0, count) in chunks of at most 'grain' elements, and
+    // return once all of them are done.  The chunk boundaries depend only
+    // on 'count' and 'grain'.  Small jobs (a single chunk) run inline on the
+    // calling thread.  Calls from several threads are serialized; calling
+    // parallelFor() from within a task is not supported.
+    void parallelFor(unsigned int count, unsigned int grain, RangeTask& task);
+
+private:
+    struct Impl;
+    Impl* impl_;
+
+    // Not copyable.
+    ThreadPool(const ThreadPool&);
+    ThreadPool& operator=(const ThreadPool&);
+};
+
+} // namespace LibMatrix
+
+#endif // THREAD_POOL_H_
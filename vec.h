@@ -14,9 +14,48 @@
 
 #include <iostream> // only needed for print() functions...
 #include <math.h>
+#include "fastmath.h"
+#if __cplusplus >= 201103L
+#include <type_traits>
+#endif
+
+// With C++14 or later, the vector and matrix types are literal types and
+// their constructors, accessors and arithmetic can be used in constant
+// expressions (e.g. to build constant tables at compile time).  With older
+// standards this expands to nothing.
+#if __cplusplus >= 201402L
+#define LIBMATRIX_CONSTEXPR constexpr
+#else
+#define LIBMATRIX_CONSTEXPR
+#endif
 
 namespace LibMatrix
 {
+// The type of the length of a vector with elements of type T: the element
+// type itself for double precision, and float otherwise (which keeps the
+// lengths of vectors of integers in floating point).
+template<typename T>
+struct LengthType
+{
+    typedef float Type;
+};
+
+template<>
+struct LengthType<double>
+{
+    typedef double Type;
+};
+
+template<>
+struct LengthType<long double>
+{
+    typedef long double Type;
+};
+
+// The vector and matrix types leave copying, assignment and destruction to
+// the compiler, so they are trivially copyable: containers of them grow
+// with memmove() and they can be copied in bulk with memcpy().
+//
 // A template class for creating, managing and operating on a 2-element vector
 // of any type you like (intended for built-in types, but as long as it 
 // supports the basic arithmetic and assignment operators, any type should
@@ -25,19 +64,15 @@ template<typename T>
 class tvec2
 {
 public:
-    tvec2() :
+    LIBMATRIX_CONSTEXPR tvec2() :
         x_(0),
         y_(0) {}
-    tvec2(const T t) :
+    LIBMATRIX_CONSTEXPR tvec2(const T t) :
         x_(t),
         y_(t) {}
-    tvec2(const T x, const T y) :
+    LIBMATRIX_CONSTEXPR tvec2(const T x, const T y) :
         x_(x),
         y_(y) {}
-    tvec2(const tvec2& v) :
-        x_(v.x_),
-        y_(v.y_) {}
-    ~tvec2() {}
 
     // Print the elements of the vector to standard out.
     // Really only useful for debug and test.
@@ -49,28 +84,21 @@ public:
     // Allow raw data access for API calls and the like.
     // For example, it is valid to pass a tvec2<float> into a call to
     // the OpenGL command "glUniform2fv()".
-    operator const T*() const { return &x_;}
+    LIBMATRIX_CONSTEXPR operator const T*() const { return &x_;}
 
-    // Get and set access members for the individual elements.
-    const T x() const { return x_; }
-    const T y() const { return y_; }
+    // Allow writable raw access to the elements, for the batch kernels
+    // and the like.
+    T* data() { return &x_; }
 
-    void x(const T& val) { x_ = val; }
-    void y(const T& val) { y_ = val; }
+    // Get and set access members for the individual elements.
+    LIBMATRIX_CONSTEXPR const T x() const { return x_; }
+    LIBMATRIX_CONSTEXPR const T y() const { return y_; }
 
-    // A direct assignment of 'rhs' to this.  Return a reference to this.
-    tvec2& operator=(const tvec2& rhs)
-    {
-        if (this != &rhs)
-        {
-            x_ = rhs.x_;
-            y_ = rhs.y_;
-        }
-        return *this;
-    }
+    LIBMATRIX_CONSTEXPR void x(const T& val) { x_ = val; }
+    LIBMATRIX_CONSTEXPR void y(const T& val) { y_ = val; }
 
     // Divide this by a scalar.  Return a reference to this.
-    tvec2& operator/=(const T& rhs)
+    LIBMATRIX_CONSTEXPR tvec2& operator/=(const T& rhs)
     {
         x_ /= rhs;
         y_ /= rhs;
@@ -78,14 +106,14 @@ public:
     }
 
     // Divide a copy of this by a scalar.  Return the copy.
-    const tvec2 operator/(const T& rhs) const
+    LIBMATRIX_CONSTEXPR const tvec2 operator/(const T& rhs) const
     {
         return tvec2(*this) /= rhs;
     }
 
     // Component-wise divide of this by another vector.
     // Return a reference to this.
-    tvec2& operator/=(const tvec2& rhs)
+    LIBMATRIX_CONSTEXPR tvec2& operator/=(const tvec2& rhs)
     {
         x_ /= rhs.x_;
         y_ /= rhs.y_;
@@ -94,13 +122,13 @@ public:
 
     // Component-wise divide of a copy of this by another vector.
     // Return the copy.
-    const tvec2 operator/(const tvec2& rhs) const
+    LIBMATRIX_CONSTEXPR const tvec2 operator/(const tvec2& rhs) const
     {
         return tvec2(*this) /= rhs;
     }
 
     // Multiply this by a scalar.  Return a reference to this.
-    tvec2& operator*=(const T& rhs)
+    LIBMATRIX_CONSTEXPR tvec2& operator*=(const T& rhs)
     {
         x_ *= rhs;
         y_ *= rhs;
@@ -108,14 +136,14 @@ public:
     }
 
     // Multiply a copy of this by a scalar.  Return the copy.
-    const tvec2 operator*(const T& rhs) const
+    LIBMATRIX_CONSTEXPR const tvec2 operator*(const T& rhs) const
     {
         return tvec2(*this) *= rhs;
     }
 
     // Component-wise multiply of this by another vector.
     // Return a reference to this.
-    tvec2& operator*=(const tvec2& rhs)
+    LIBMATRIX_CONSTEXPR tvec2& operator*=(const tvec2& rhs)
     {
         x_ *= rhs.x_;
         y_ *= rhs.y_;
@@ -124,13 +152,13 @@ public:
 
     // Component-wise multiply of a copy of this by another vector.
     // Return the copy.
-    const tvec2 operator*(const tvec2& rhs) const
+    LIBMATRIX_CONSTEXPR const tvec2 operator*(const tvec2& rhs) const
     {
         return tvec2(*this) *= rhs;
     }
 
     // Add a scalar to this.  Return a reference to this.
-    tvec2& operator+=(const T& rhs)
+    LIBMATRIX_CONSTEXPR tvec2& operator+=(const T& rhs)
     {
         x_ += rhs;
         y_ += rhs;
@@ -138,14 +166,14 @@ public:
     }
     
     // Add a scalar to a copy of this.  Return the copy.
-    const tvec2 operator+(const T& rhs) const
+    LIBMATRIX_CONSTEXPR const tvec2 operator+(const T& rhs) const
     {
         return tvec2(*this) += rhs;
     }
 
     // Component-wise addition of another vector to this.
     // Return a reference to this.
-    tvec2& operator+=(const tvec2& rhs)
+    LIBMATRIX_CONSTEXPR tvec2& operator+=(const tvec2& rhs)
     {
         x_ += rhs.x_;
         y_ += rhs.y_;
@@ -154,13 +182,13 @@ public:
 
     // Component-wise addition of another vector to a copy of this.
     // Return the copy.
-    const tvec2 operator+(const tvec2& rhs) const
+    LIBMATRIX_CONSTEXPR const tvec2 operator+(const tvec2& rhs) const
     {
         return tvec2(*this) += rhs;
     }
 
     // Subtract a scalar from this.  Return a reference to this.
-    tvec2& operator-=(const T& rhs)
+    LIBMATRIX_CONSTEXPR tvec2& operator-=(const T& rhs)
     {
         x_ -= rhs;
         y_ -= rhs;
@@ -168,14 +196,14 @@ public:
     }
     
     // Subtract a scalar from a copy of this.  Return the copy.
-    const tvec2 operator-(const T& rhs) const
+    LIBMATRIX_CONSTEXPR const tvec2 operator-(const T& rhs) const
     {
         return tvec2(*this) -= rhs;
     }
 
     // Component-wise subtraction of another vector from this.
     // Return a reference to this.
-    tvec2& operator-=(const tvec2& rhs)
+    LIBMATRIX_CONSTEXPR tvec2& operator-=(const tvec2& rhs)
     {
         x_ -= rhs.x_;
         y_ -= rhs.y_;
@@ -184,27 +212,41 @@ public:
 
     // Component-wise subtraction of another vector from a copy of this.
     // Return the copy.
-    const tvec2 operator-(const tvec2& rhs) const
+    LIBMATRIX_CONSTEXPR const tvec2 operator-(const tvec2& rhs) const
     {
         return tvec2(*this) -= rhs;
     }
 
     // Compute the length of this and return it.
-    float length() const
+    typename LengthType<T>::Type length() const
     {
-        return sqrt(dot(*this, *this));
+        return sqrt(static_cast<typename LengthType<T>::Type>(dot(*this, *this)));
     }
 
-    // Make this a unit vector.
+    // Make this a unit vector (the same as normalize(fast) when built
+    // with LIBMATRIX_FAST_MATH).
     void normalize()
     {
-        float l = length();
+#if defined(LIBMATRIX_FAST_MATH)
+        normalize(fast);
+#else
+        typename LengthType<T>::Type l = length();
         x_ /= l;
         y_ /= l;
+#endif
+    }
+
+    // Make this a unit vector, scaling it by FastMath::rsqrt() of its
+    // squared length rather than dividing it by its length.
+    void normalize(Fast)
+    {
+        T r(FastMath::rsqrt(dot(*this, *this)));
+        x_ *= r;
+        y_ *= r;
     }
 
     // Compute the dot product of two vectors.
-    static T dot(const tvec2& v1, const tvec2& v2)
+    LIBMATRIX_CONSTEXPR static T dot(const tvec2& v1, const tvec2& v2)
     {
         return (v1.x_ * v2.x_) + (v1.y_ * v2.y_); 
     }
@@ -222,23 +264,18 @@ template<typename T>
 class tvec3
 {
 public:
-    tvec3() :
+    LIBMATRIX_CONSTEXPR tvec3() :
         x_(0),
         y_(0),
         z_(0) {}
-    tvec3(const T t) :
+    LIBMATRIX_CONSTEXPR tvec3(const T t) :
         x_(t),
         y_(t),
         z_(t) {}
-    tvec3(const T x, const T y, const T z) :
+    LIBMATRIX_CONSTEXPR tvec3(const T x, const T y, const T z) :
         x_(x),
         y_(y),
         z_(z) {}
-    tvec3(const tvec3& v) :
-        x_(v.x_),
-        y_(v.y_),
-        z_(v.z_) {}
-    ~tvec3() {}
 
     // Print the elements of the vector to standard out.
     // Really only useful for debug and test.
@@ -250,31 +287,23 @@ public:
     // Allow raw data access for API calls and the like.
     // For example, it is valid to pass a tvec3<float> into a call to
     // the OpenGL command "glUniform3fv()".
-    operator const T*() const { return &x_;}
+    LIBMATRIX_CONSTEXPR operator const T*() const { return &x_;}
+
+    // Allow writable raw access to the elements, for the batch kernels
+    // and the like.
+    T* data() { return &x_; }
 
     // Get and set access members for the individual elements.
-    const T x() const { return x_; }
-    const T y() const { return y_; }
-    const T z() const { return z_; }
-
-    void x(const T& val) { x_ = val; }
-    void y(const T& val) { y_ = val; }
-    void z(const T& val) { z_ = val; }
-
-    // A direct assignment of 'rhs' to this.  Return a reference to this.
-    tvec3& operator=(const tvec3& rhs)
-    {
-        if (this != &rhs)
-        {
-            x_ = rhs.x_;
-            y_ = rhs.y_;
-            z_ = rhs.z_;
-        }
-        return *this;
-    }
+    LIBMATRIX_CONSTEXPR const T x() const { return x_; }
+    LIBMATRIX_CONSTEXPR const T y() const { return y_; }
+    LIBMATRIX_CONSTEXPR const T z() const { return z_; }
+
+    LIBMATRIX_CONSTEXPR void x(const T& val) { x_ = val; }
+    LIBMATRIX_CONSTEXPR void y(const T& val) { y_ = val; }
+    LIBMATRIX_CONSTEXPR void z(const T& val) { z_ = val; }
 
     // Divide this by a scalar.  Return a reference to this.
-    tvec3& operator/=(const T& rhs)
+    LIBMATRIX_CONSTEXPR tvec3& operator/=(const T& rhs)
     {
         x_ /= rhs;
         y_ /= rhs;
@@ -283,14 +312,14 @@ public:
     }
 
     // Divide a copy of this by a scalar.  Return the copy.
-    const tvec3 operator/(const T& rhs) const
+    LIBMATRIX_CONSTEXPR const tvec3 operator/(const T& rhs) const
     {
         return tvec3(*this) /= rhs;
     }
 
     // Component-wise divide of this by another vector.
     // Return a reference to this.
-    tvec3& operator/=(const tvec3& rhs)
+    LIBMATRIX_CONSTEXPR tvec3& operator/=(const tvec3& rhs)
     {
         x_ /= rhs.x_;
         y_ /= rhs.y_;
@@ -300,13 +329,13 @@ public:
 
     // Component-wise divide of a copy of this by another vector.
     // Return the copy.
-    const tvec3 operator/(const tvec3& rhs) const
+    LIBMATRIX_CONSTEXPR const tvec3 operator/(const tvec3& rhs) const
     {
         return tvec3(*this) /= rhs;
     }
 
     // Multiply this by a scalar.  Return a reference to this.
-    tvec3& operator*=(const T& rhs)
+    LIBMATRIX_CONSTEXPR tvec3& operator*=(const T& rhs)
     {
         x_ *= rhs;
         y_ *= rhs;
@@ -315,14 +344,14 @@ public:
     }
 
     // Multiply a copy of this by a scalar.  Return the copy.
-    const tvec3 operator*(const T& rhs) const
+    LIBMATRIX_CONSTEXPR const tvec3 operator*(const T& rhs) const
     {
         return tvec3(*this) *= rhs;
     }
 
     // Component-wise multiply of this by another vector.
     // Return a reference to this.
-    tvec3& operator*=(const tvec3& rhs)
+    LIBMATRIX_CONSTEXPR tvec3& operator*=(const tvec3& rhs)
     {
         x_ *= rhs.x_;
         y_ *= rhs.y_;
@@ -332,13 +361,13 @@ public:
 
     // Component-wise multiply of a copy of this by another vector.
     // Return the copy.
-    const tvec3 operator*(const tvec3& rhs) const
+    LIBMATRIX_CONSTEXPR const tvec3 operator*(const tvec3& rhs) const
     {
         return tvec3(*this) *= rhs;
     }
 
     // Add a scalar to this.  Return a reference to this.
-    tvec3& operator+=(const T& rhs)
+    LIBMATRIX_CONSTEXPR tvec3& operator+=(const T& rhs)
     {
         x_ += rhs;
         y_ += rhs;
@@ -347,14 +376,14 @@ public:
     }
 
     // Add a scalar to a copy of this.  Return the copy.
-    const tvec3 operator+(const T& rhs) const
+    LIBMATRIX_CONSTEXPR const tvec3 operator+(const T& rhs) const
     {
         return tvec3(*this) += rhs;
     }
 
     // Component-wise addition of another vector to this.
     // Return a reference to this.
-    tvec3& operator+=(const tvec3& rhs)
+    LIBMATRIX_CONSTEXPR tvec3& operator+=(const tvec3& rhs)
     {
         x_ += rhs.x_;
         y_ += rhs.y_;
@@ -364,13 +393,13 @@ public:
 
     // Component-wise addition of another vector to a copy of this.
     // Return the copy.
-    const tvec3 operator+(const tvec3& rhs) const
+    LIBMATRIX_CONSTEXPR const tvec3 operator+(const tvec3& rhs) const
     {
         return tvec3(*this) += rhs;
     }
 
     // Subtract a scalar from this.  Return a reference to this.
-    tvec3& operator-=(const T& rhs)
+    LIBMATRIX_CONSTEXPR tvec3& operator-=(const T& rhs)
     {
         x_ -= rhs;
         y_ -= rhs;
@@ -379,14 +408,14 @@ public:
     }
 
     // Subtract a scalar from a copy of this.  Return the copy.
-    const tvec3 operator-(const T& rhs) const
+    LIBMATRIX_CONSTEXPR const tvec3 operator-(const T& rhs) const
     {
         return tvec3(*this) -= rhs;
     }
 
     // Component-wise subtraction of another vector from this.
     // Return a reference to this.
-    tvec3& operator-=(const tvec3& rhs)
+    LIBMATRIX_CONSTEXPR tvec3& operator-=(const tvec3& rhs)
     {
         x_ -= rhs.x_;
         y_ -= rhs.y_;
@@ -396,34 +425,49 @@ public:
 
     // Component-wise subtraction of another vector from a copy of this.
     // Return the copy.
-    const tvec3 operator-(const tvec3& rhs) const
+    LIBMATRIX_CONSTEXPR const tvec3 operator-(const tvec3& rhs) const
     {
         return tvec3(*this) -= rhs;
     }
 
     // Compute the length of this and return it.
-    float length() const
+    typename LengthType<T>::Type length() const
     {
-        return sqrt(dot(*this, *this));
+        return sqrt(static_cast<typename LengthType<T>::Type>(dot(*this, *this)));
     }
 
-    // Make this a unit vector.
+    // Make this a unit vector (the same as normalize(fast) when built
+    // with LIBMATRIX_FAST_MATH).
     void normalize()
     {
-        float l = length();
+#if defined(LIBMATRIX_FAST_MATH)
+        normalize(fast);
+#else
+        typename LengthType<T>::Type l = length();
         x_ /= l;
         y_ /= l;
         z_ /= l;
+#endif
+    }
+
+    // Make this a unit vector, scaling it by FastMath::rsqrt() of its
+    // squared length rather than dividing it by its length.
+    void normalize(Fast)
+    {
+        T r(FastMath::rsqrt(dot(*this, *this)));
+        x_ *= r;
+        y_ *= r;
+        z_ *= r;
     }
 
     // Compute the dot product of two vectors.
-    static T dot(const tvec3& v1, const tvec3& v2)
+    LIBMATRIX_CONSTEXPR static T dot(const tvec3& v1, const tvec3& v2)
     {
         return (v1.x_ * v2.x_) + (v1.y_ * v2.y_) + (v1.z_ * v2.z_); 
     }
 
     // Compute the cross product of two vectors.
-    static tvec3 cross(const tvec3& u, const tvec3& v)
+    LIBMATRIX_CONSTEXPR static tvec3 cross(const tvec3& u, const tvec3& v)
     {
         return tvec3((u.y_ * v.z_) - (u.z_ * v.y_),
                     (u.z_ * v.x_) - (u.x_ * v.z_),
@@ -444,27 +488,21 @@ template<typename T>
 class tvec4
 {
 public:
-    tvec4() :
+    LIBMATRIX_CONSTEXPR tvec4() :
         x_(0),
         y_(0),
         z_(0),
         w_(0) {}
-    tvec4(const T t) :
+    LIBMATRIX_CONSTEXPR tvec4(const T t) :
         x_(t),
         y_(t),
         z_(t),
         w_(t) {}
-    tvec4(const T x, const T y, const T z, const T w) :
+    LIBMATRIX_CONSTEXPR tvec4(const T x, const T y, const T z, const T w) :
         x_(x),
         y_(y),
         z_(z),
         w_(w) {}
-    tvec4(const tvec4& v) :
-        x_(v.x_),
-        y_(v.y_),
-        z_(v.z_),
-        w_(v.w_) {}
-    ~tvec4() {}
 
     // Print the elements of the vector to standard out.
     // Really only useful for debug and test.
@@ -476,34 +514,25 @@ public:
     // Allow raw data access for API calls and the like.
     // For example, it is valid to pass a tvec4<float> into a call to
     // the OpenGL command "glUniform4fv()".
-    operator const T*() const { return &x_;}
+    LIBMATRIX_CONSTEXPR operator const T*() const { return &x_;}
+
+    // Allow writable raw access to the elements, for the batch kernels
+    // and the like.
+    T* data() { return &x_; }
 
     // Get and set access members for the individual elements.
-    const T x() const { return x_; }
-    const T y() const { return y_; }
-    const T z() const { return z_; }
-    const T w() const { return w_; }
-
-    void x(const T& val) { x_ = val; }
-    void y(const T& val) { y_ = val; }
-    void z(const T& val) { z_ = val; }
-    void w(const T& val) { w_ = val; }
-
-    // A direct assignment of 'rhs' to this.  Return a reference to this.
-    tvec4& operator=(const tvec4& rhs)
-    {
-        if (this != &rhs)
-        {
-            x_ = rhs.x_;
-            y_ = rhs.y_;
-            z_ = rhs.z_;
-            w_ = rhs.w_;
-        }
-        return *this;
-    }
+    LIBMATRIX_CONSTEXPR const T x() const { return x_; }
+    LIBMATRIX_CONSTEXPR const T y() const { return y_; }
+    LIBMATRIX_CONSTEXPR const T z() const { return z_; }
+    LIBMATRIX_CONSTEXPR const T w() const { return w_; }
+
+    LIBMATRIX_CONSTEXPR void x(const T& val) { x_ = val; }
+    LIBMATRIX_CONSTEXPR void y(const T& val) { y_ = val; }
+    LIBMATRIX_CONSTEXPR void z(const T& val) { z_ = val; }
+    LIBMATRIX_CONSTEXPR void w(const T& val) { w_ = val; }
 
     // Divide this by a scalar.  Return a reference to this.
-    tvec4& operator/=(const T& rhs)
+    LIBMATRIX_CONSTEXPR tvec4& operator/=(const T& rhs)
     {
         x_ /= rhs;
         y_ /= rhs;
@@ -513,14 +542,14 @@ public:
     }
 
     // Divide a copy of this by a scalar.  Return the copy.
-    const tvec4 operator/(const T& rhs) const
+    LIBMATRIX_CONSTEXPR const tvec4 operator/(const T& rhs) const
     {
         return tvec4(*this) /= rhs;
     }
 
     // Component-wise divide of this by another vector.
     // Return a reference to this.
-    tvec4& operator/=(const tvec4& rhs)
+    LIBMATRIX_CONSTEXPR tvec4& operator/=(const tvec4& rhs)
     {
         x_ /= rhs.x_;
         y_ /= rhs.y_;
@@ -531,13 +560,13 @@ public:
 
     // Component-wise divide of a copy of this by another vector.
     // Return the copy.
-    const tvec4 operator/(const tvec4& rhs) const
+    LIBMATRIX_CONSTEXPR const tvec4 operator/(const tvec4& rhs) const
     {
         return tvec4(*this) /= rhs;
     }
 
     // Multiply this by a scalar.  Return a reference to this.
-    tvec4& operator*=(const T& rhs)
+    LIBMATRIX_CONSTEXPR tvec4& operator*=(const T& rhs)
     {
         x_ *= rhs;
         y_ *= rhs;
@@ -547,14 +576,14 @@ public:
     }
 
     // Multiply a copy of this by a scalar.  Return the copy.
-    const tvec4 operator*(const T& rhs) const
+    LIBMATRIX_CONSTEXPR const tvec4 operator*(const T& rhs) const
     {
         return tvec4(*this) *= rhs;
     }
 
     // Component-wise multiply of this by another vector.
     // Return a reference to this.
-    tvec4& operator*=(const tvec4& rhs)
+    LIBMATRIX_CONSTEXPR tvec4& operator*=(const tvec4& rhs)
     {
         x_ *= rhs.x_;
         y_ *= rhs.y_;
@@ -565,13 +594,13 @@ public:
 
     // Component-wise multiply of a copy of this by another vector.
     // Return the copy.
-    const tvec4 operator*(const tvec4& rhs) const
+    LIBMATRIX_CONSTEXPR const tvec4 operator*(const tvec4& rhs) const
     {
         return tvec4(*this) *= rhs;
     }
 
     // Add a scalar to this.  Return a reference to this.
-    tvec4& operator+=(const T& rhs)
+    LIBMATRIX_CONSTEXPR tvec4& operator+=(const T& rhs)
     {
         x_ += rhs;
         y_ += rhs;
@@ -581,14 +610,14 @@ public:
     }
 
     // Add a scalar to a copy of this.  Return the copy.
-    const tvec4 operator+(const T& rhs) const
+    LIBMATRIX_CONSTEXPR const tvec4 operator+(const T& rhs) const
     {
         return tvec4(*this) += rhs;
     }
 
     // Component-wise addition of another vector to this.
     // Return a reference to this.
-    tvec4& operator+=(const tvec4& rhs)
+    LIBMATRIX_CONSTEXPR tvec4& operator+=(const tvec4& rhs)
     {
         x_ += rhs.x_;
         y_ += rhs.y_;
@@ -599,13 +628,13 @@ public:
 
     // Component-wise addition of another vector to a copy of this.
     // Return the copy.
-    const tvec4 operator+(const tvec4& rhs) const
+    LIBMATRIX_CONSTEXPR const tvec4 operator+(const tvec4& rhs) const
     {
         return tvec4(*this) += rhs;
     }
 
     // Subtract a scalar from this.  Return a reference to this.
-    tvec4& operator-=(const T& rhs)
+    LIBMATRIX_CONSTEXPR tvec4& operator-=(const T& rhs)
     {
         x_ -= rhs;
         y_ -= rhs;
@@ -615,14 +644,14 @@ public:
     }
 
     // Subtract a scalar from a copy of this.  Return the copy.
-    const tvec4 operator-(const T& rhs) const
+    LIBMATRIX_CONSTEXPR const tvec4 operator-(const T& rhs) const
     {
         return tvec4(*this) -= rhs;
     }
 
     // Component-wise subtraction of another vector from this.
     // Return a reference to this.
-    tvec4& operator-=(const tvec4& rhs)
+    LIBMATRIX_CONSTEXPR tvec4& operator-=(const tvec4& rhs)
     {
         x_ -= rhs.x_;
         y_ -= rhs.y_;
@@ -633,29 +662,45 @@ public:
 
     // Component-wise subtraction of another vector from a copy of this.
     // Return the copy.
-    const tvec4 operator-(const tvec4& rhs) const
+    LIBMATRIX_CONSTEXPR const tvec4 operator-(const tvec4& rhs) const
     {
         return tvec4(*this) -= rhs;
     }
 
     // Compute the length of this and return it.
-    float length() const
+    typename LengthType<T>::Type length() const
     {
-        return sqrt(dot(*this, *this));
+        return sqrt(static_cast<typename LengthType<T>::Type>(dot(*this, *this)));
     }
 
-    // Make this a unit vector.
+    // Make this a unit vector (the same as normalize(fast) when built
+    // with LIBMATRIX_FAST_MATH).
     void normalize()
     {
-        float l = length();
+#if defined(LIBMATRIX_FAST_MATH)
+        normalize(fast);
+#else
+        typename LengthType<T>::Type l = length();
         x_ /= l;
         y_ /= l;
         z_ /= l;
         w_ /= l;
+#endif
+    }
+
+    // Make this a unit vector, scaling it by FastMath::rsqrt() of its
+    // squared length rather than dividing it by its length.
+    void normalize(Fast)
+    {
+        T r(FastMath::rsqrt(dot(*this, *this)));
+        x_ *= r;
+        y_ *= r;
+        z_ *= r;
+        w_ *= r;
     }
 
     // Compute the dot product of two vectors.
-    static T dot(const tvec4& v1, const tvec4& v2)
+    LIBMATRIX_CONSTEXPR static T dot(const tvec4& v1, const tvec4& v2)
     {
         return (v1.x_ * v2.x_) + (v1.y_ * v2.y_) + (v1.z_ * v2.z_) + (v1.w_ * v2.w_); 
     }
@@ -696,21 +741,31 @@ typedef tvec4<bool> bvec4;
 // Global operators to allow for things like defining a new vector in terms of
 // a product of a scalar and a vector
 template<typename T>
-const LibMatrix::tvec2<T> operator*(const T t, const LibMatrix::tvec2<T>& v)
+LIBMATRIX_CONSTEXPR const LibMatrix::tvec2<T> operator*(const T t, const LibMatrix::tvec2<T>& v)
 {
     return v * t;
 }
 
 template<typename T>
-const LibMatrix::tvec3<T> operator*(const T t, const LibMatrix::tvec3<T>& v)
+LIBMATRIX_CONSTEXPR const LibMatrix::tvec3<T> operator*(const T t, const LibMatrix::tvec3<T>& v)
 {
     return v * t;
 }
 
 template<typename T>
-const LibMatrix::tvec4<T> operator*(const T t, const LibMatrix::tvec4<T>& v)
+LIBMATRIX_CONSTEXPR const LibMatrix::tvec4<T> operator*(const T t, const LibMatrix::tvec4<T>& v)
 {
     return v * t;
 }
 
+#if __cplusplus >= 201103L
+static_assert(std::is_trivially_copyable<LibMatrix::vec2>::value &&
+              std::is_trivially_copyable<LibMatrix::vec3>::value &&
+              std::is_trivially_copyable<LibMatrix::vec4>::value &&
+              std::is_trivially_copyable<LibMatrix::dvec4>::value,
+              "vectors must be trivially copyable");
+static_assert(std::is_trivially_destructible<LibMatrix::vec4>::value,
+              "vectors must be trivially destructible");
+#endif
+
 #endif // VEC_H_